@@ -13,7 +13,7 @@ void KeyritaControlsFactory::Init()
 
 void KeyritaMenu::Init()
 {
-   XmlToUiUtil::ConstructLayoutFromXmlFile("./res/gui/KeyritaMenu.guix", mOwnedControls, mControls);
+   XmlToUiUtil::ConstructLayoutFromXmlFile("./res/gui/KeyritaMenu.guix", mOwnedControls, mControls, CreateArena());
 }
 
 void KeyritaMenu::ChildRender(WindowBase* const window, nk_context* context)
@@ -26,7 +26,7 @@ void KeyritaMenu::ChildRender(WindowBase* const window, nk_context* context)
 
 void ExampleUi::Init()
 {
-   XmlToUiUtil::ConstructLayoutFromXmlFile("./res/gui/ExampleUI.guix", mOwnedControls, mControls);
+   XmlToUiUtil::ConstructLayoutFromXmlFile("./res/gui/ExampleUI.guix", mOwnedControls, mControls, CreateArena());
 }
 
 void ExampleUi::ChildRender(WindowBase* const window, nk_context* context)
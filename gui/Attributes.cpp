@@ -131,6 +131,78 @@ namespace
 
 namespace wgui
 {
+   namespace
+   {
+      inline char FoldCase(char c)
+      {
+         return c >= 'A' && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c;
+      }
+   }
+
+   size_t AttributeNames::FoldedHash::operator()(std::string_view name) const
+   {
+      uint64_t hash = 14695981039346656037ull;
+      for (char c : name)
+      {
+         hash = (hash ^ static_cast<uint8_t>(FoldCase(c))) * 1099511628211ull;
+      }
+
+      return static_cast<size_t>(hash);
+   }
+
+   bool AttributeNames::FoldedEqual::operator()(std::string_view a, std::string_view b) const
+   {
+      return std::equal(a.begin(), a.end(), b.begin(), b.end(),
+         [](char x, char y) { return FoldCase(x) == FoldCase(y); });
+   }
+
+   AttributeNames& AttributeNames::Instance()
+   {
+      static AttributeNames names;
+      return names;
+   }
+
+   attr_name_id_t AttributeNames::Intern(std::string_view name)
+   {
+      // Names are nearly always interned already, those only take the shared lock.
+      attr_name_id_t existing = Find(name);
+      if (existing != NotAName)
+      {
+         return existing;
+      }
+
+      AttributeNames& names = Instance();
+      std::unique_lock<std::shared_mutex> lock(names.mMutex);
+
+      auto found = names.mIds.find(name);
+      if (found != names.mIds.end())
+      {
+         return found->second;
+      }
+
+      attr_name_id_t id = static_cast<attr_name_id_t>(names.mNames.size());
+      auto added = names.mIds.emplace(std::string(name), id).first;
+      names.mNames.push_back(&added->first);
+      return id;
+   }
+
+   attr_name_id_t AttributeNames::Find(std::string_view name)
+   {
+      AttributeNames& names = Instance();
+      std::shared_lock<std::shared_mutex> lock(names.mMutex);
+
+      auto found = names.mIds.find(name);
+      return found != names.mIds.end() ? found->second : NotAName;
+   }
+
+   std::string_view AttributeNames::GetName(attr_name_id_t id)
+   {
+      AttributeNames& names = Instance();
+      std::shared_lock<std::shared_mutex> lock(names.mMutex);
+
+      return id < names.mNames.size() ? std::string_view(*names.mNames[id]) : std::string_view();
+   }
+
    attr_type_id_t AttrTypes::IntId = AttributeTypeManager::NotAType;
    attr_type_id_t AttrTypes::RealId = AttributeTypeManager::NotAType;
    attr_type_id_t AttrTypes::BoolId = AttributeTypeManager::NotAType;
@@ -0,0 +1,82 @@
+#include "ControlArena.h"
+
+#include <cstdint>
+#include <new>
+
+namespace wgui
+{
+   namespace
+   {
+      thread_local ControlArena* CurrentArena = nullptr;
+
+      // Keeps the object behind it aligned like operator new would.
+      constexpr size_t HeaderSize = alignof(std::max_align_t);
+
+      enum class eAllocationSource : uint8_t
+      {
+         Heap,
+         Arena
+      };
+   }
+
+   ControlArena::ControlArena(size_t initialBlockSize)
+      : mResource(initialBlockSize)
+   {
+   }
+
+   void* ControlArena::Allocate(size_t size, size_t alignment)
+   {
+      mBytesAllocated += size;
+      return mResource.allocate(size, alignment);
+   }
+
+   ControlArena* ControlArena::GetCurrent()
+   {
+      return CurrentArena;
+   }
+
+   std::pmr::memory_resource* ControlArena::GetCurrentResource()
+   {
+      return CurrentArena ? CurrentArena->GetResource() : std::pmr::new_delete_resource();
+   }
+
+   ControlArena::Scope::Scope(ControlArena* arena)
+      : mPrevious(CurrentArena)
+   {
+      if (arena != nullptr)
+      {
+         CurrentArena = arena;
+      }
+   }
+
+   ControlArena::Scope::~Scope()
+   {
+      CurrentArena = mPrevious;
+   }
+
+   void* ArenaAllocated::operator new(size_t size)
+   {
+      ControlArena* arena = ControlArena::GetCurrent();
+      uint8_t* memory = static_cast<uint8_t*>(arena != nullptr ?
+         arena->Allocate(size + HeaderSize, HeaderSize) : ::operator new(size + HeaderSize));
+
+      *reinterpret_cast<eAllocationSource*>(memory) = arena != nullptr ?
+         eAllocationSource::Arena : eAllocationSource::Heap;
+      return memory + HeaderSize;
+   }
+
+   void ArenaAllocated::operator delete(void* memory)
+   {
+      if (memory == nullptr)
+      {
+         return;
+      }
+
+      // Arena memory is released with the whole arena.
+      uint8_t* base = static_cast<uint8_t*>(memory) - HeaderSize;
+      if (*reinterpret_cast<eAllocationSource*>(base) == eAllocationSource::Heap)
+      {
+         ::operator delete(base);
+      }
+   }
+}
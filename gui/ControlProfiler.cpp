@@ -0,0 +1,262 @@
+#include "ControlProfiler.h"
+#include "StandardControls.h"
+
+#include <algorithm>
+#include <iomanip>
+
+namespace
+{
+   using namespace wgui;
+
+   std::unique_ptr<ControlProfileNode> CopySorted(const ControlProfileNode& node)
+   {
+      auto copy = std::make_unique<ControlProfileNode>();
+      copy->Label = node.Label;
+      copy->Tag = node.Tag;
+      copy->Cost = node.Cost;
+
+      for (const auto& child : node.Children)
+      {
+         copy->Children.push_back(CopySorted(*child));
+      }
+
+      std::sort(copy->Children.begin(), copy->Children.end(),
+         [](const auto& a, const auto& b) { return a->Cost.InclusiveMs > b->Cost.InclusiveMs; });
+      return copy;
+   }
+
+   void WriteNode(std::ostream& stream, const ControlProfileNode& node, double frames, int depth)
+   {
+      const ControlCost& cost = node.Cost;
+      stream << std::string(depth * 2, ' ') << node.Label;
+      if (!node.Tag.empty() && node.Tag != "Untagged")
+      {
+         stream << " [" << node.Tag << "]";
+      }
+
+      stream << "  x" << cost.Calls / frames
+         << "  incl " << cost.InclusiveMs / frames << " ms"
+         << "  excl " << cost.ExclusiveMs / frames << " ms"
+         << "  cmds " << cost.InclusiveCommands / frames << "/" << cost.ExclusiveCommands / frames
+         << "  verts " << cost.InclusiveVertices / frames << "/" << cost.ExclusiveVertices / frames << "\n";
+
+      for (const auto& child : node.Children)
+      {
+         WriteNode(stream, *child, frames, depth + 1);
+      }
+   }
+}
+
+namespace wgui
+{
+   ControlProfiler::ControlProfiler()
+   {
+      mRoot.Label = "Frame";
+      nk_buffer_init_default(&mCommands);
+      nk_buffer_init_default(&mVertices);
+      nk_buffer_init_default(&mElements);
+   }
+
+   ControlProfiler::~ControlProfiler()
+   {
+      nk_buffer_free(&mCommands);
+      nk_buffer_free(&mVertices);
+      nk_buffer_free(&mElements);
+   }
+
+   void ControlProfiler::BeginFrame()
+   {
+      if (mResetRequested.exchange(false))
+      {
+         std::lock_guard<std::mutex> lock(mMutex);
+         mRoot.Children.clear();
+         mRoot.Cost = ControlCost();
+         mNodes.clear();
+         mFrames = 0;
+      }
+
+      mEntries.clear();
+      mStack.clear();
+   }
+
+   ControlProfileNode* ControlProfiler::GetNode(GuiControlBase* control, ControlProfileNode* parent)
+   {
+      auto cached = mNodes.find(control->GetControlId());
+      if (cached != mNodes.end())
+      {
+         return cached->second;
+      }
+
+      std::string label = control->GetLabel();
+      std::string tag = control->GetTag();
+      ControlProfileNode* node = nullptr;
+
+      std::lock_guard<std::mutex> lock(mMutex);
+      for (auto& child : parent->Children)
+      {
+         if (child->Label == label && child->Tag == tag)
+         {
+            node = child.get();
+            break;
+         }
+      }
+
+      if (!node)
+      {
+         parent->Children.push_back(std::make_unique<ControlProfileNode>());
+         node = parent->Children.back().get();
+         node->Label = std::move(label);
+         node->Tag = std::move(tag);
+      }
+
+      mNodes[control->GetControlId()] = node;
+      return node;
+   }
+
+   void ControlProfiler::Enter(GuiControlBase* control, nk_context* context)
+   {
+      int parent = mStack.empty() ? -1 : mStack.back();
+      ControlProfileNode* node = GetNode(control, parent < 0 ? &mRoot : mEntries[parent].Node);
+
+      int index = static_cast<int>(mEntries.size());
+      mStack.push_back(index);
+      mEntries.push_back(Entry{ node, parent, Clock::time_point(), context->memory.allocated });
+
+      // Every command pushed from here on carries the entry, EndFrame maps draw commands back with it.
+      nk_set_user_data(context, nk_handle_id(index + 1));
+      mEntries.back().Start = Clock::now();
+   }
+
+   void ControlProfiler::Exit(nk_context* context)
+   {
+      Clock::time_point now = Clock::now();
+      if (mStack.empty())
+      {
+         return;
+      }
+
+      Entry& entry = mEntries[mStack.back()];
+      mStack.pop_back();
+
+      entry.InclusiveMs = std::chrono::duration<double, std::milli>(now - entry.Start).count();
+      entry.InclusiveCommands = CountCommands(context, entry.CommandStart);
+
+      if (entry.Parent >= 0)
+      {
+         mEntries[entry.Parent].ChildMs += entry.InclusiveMs;
+         mEntries[entry.Parent].ChildCommands += entry.InclusiveCommands;
+      }
+
+      nk_set_user_data(context, nk_handle_id(entry.Parent + 1));
+   }
+
+   uint64_t ControlProfiler::CountCommands(const nk_context* context, nk_size begin)
+   {
+      // With the pool allocator the front of the context memory holds nothing but commands, each
+      // one storing the offset of the next, so the commands of a control are a walk from its start.
+      const nk_size align = NK_ALIGNOF(struct nk_command);
+      const nk_byte* memory = static_cast<const nk_byte*>(context->memory.memory.ptr);
+      nk_size end = context->memory.allocated;
+      nk_size offset = (begin + align - 1) / align * align;
+      uint64_t count = 0;
+
+      while (offset < end)
+      {
+         const nk_command* cmd = reinterpret_cast<const nk_command*>(memory + offset);
+         count++;
+         offset = cmd->next;
+      }
+
+      return count;
+   }
+
+   void ControlProfiler::EndFrame(nk_context* context, const nk_convert_config& config, float tessellationTolerance)
+   {
+      nk_set_user_data(context, nk_handle_id(0));
+      mStack.clear();
+
+      nk_buffer_clear(&mCommands);
+      nk_buffer_clear(&mVertices);
+      nk_buffer_clear(&mElements);
+
+      // Vertices only exist after converting. The draw list starts a new draw command whenever the
+      // userdata changes, and a command's vertices are the range its indices span.
+      if (nk_glfw3_convert(context, &mCommands, &mVertices, &mElements, &config, tessellationTolerance) == NK_CONVERT_SUCCESS)
+      {
+         const nk_draw_index* elements = static_cast<const nk_draw_index*>(nk_buffer_memory_const(&mElements));
+         const nk_draw_command* cmd;
+
+         nk_draw_foreach(cmd, context, &mCommands)
+         {
+            int index = cmd->userdata.id - 1;
+            if (cmd->elem_count && index >= 0 && index < static_cast<int>(mEntries.size()))
+            {
+               auto range = std::minmax_element(elements, elements + cmd->elem_count);
+               mEntries[index].ExclusiveVertices += *range.second - *range.first + 1;
+            }
+
+            elements += cmd->elem_count;
+         }
+      }
+
+      // Children come after their parents, walking backwards finishes them first.
+      for (int i = static_cast<int>(mEntries.size()) - 1; i >= 0; i--)
+      {
+         Entry& entry = mEntries[i];
+         entry.InclusiveVertices += entry.ExclusiveVertices;
+         if (entry.Parent >= 0)
+         {
+            mEntries[entry.Parent].InclusiveVertices += entry.InclusiveVertices;
+         }
+      }
+
+      std::lock_guard<std::mutex> lock(mMutex);
+      for (const Entry& entry : mEntries)
+      {
+         ControlCost& cost = entry.Node->Cost;
+         cost.Calls++;
+         cost.InclusiveMs += entry.InclusiveMs;
+         cost.ExclusiveMs += entry.InclusiveMs - entry.ChildMs;
+         cost.InclusiveCommands += entry.InclusiveCommands;
+         cost.ExclusiveCommands += entry.InclusiveCommands - entry.ChildCommands;
+         cost.InclusiveVertices += entry.InclusiveVertices;
+         cost.ExclusiveVertices += entry.ExclusiveVertices;
+
+         if (entry.Parent < 0)
+         {
+            mRoot.Cost.InclusiveMs += entry.InclusiveMs;
+            mRoot.Cost.InclusiveCommands += entry.InclusiveCommands;
+            mRoot.Cost.InclusiveVertices += entry.InclusiveVertices;
+         }
+      }
+
+      mRoot.Cost.Calls++;
+      mFrames++;
+   }
+
+   uint64_t ControlProfiler::GetFrameCount() const
+   {
+      std::lock_guard<std::mutex> lock(mMutex);
+      return mFrames;
+   }
+
+   std::unique_ptr<ControlProfileNode> ControlProfiler::GetReport() const
+   {
+      std::lock_guard<std::mutex> lock(mMutex);
+      return CopySorted(mRoot);
+   }
+
+   void ControlProfiler::WriteReport(std::ostream& stream) const
+   {
+      std::unique_ptr<ControlProfileNode> report = GetReport();
+      double frames = static_cast<double>(std::max<uint64_t>(report->Cost.Calls, 1));
+
+      std::ios_base::fmtflags flags = stream.flags();
+      std::streamsize precision = stream.precision();
+      stream << std::fixed << std::setprecision(3);
+      stream << "Averages over " << report->Cost.Calls << " frames, calls, ms and commands/vertices inclusive/exclusive\n";
+      WriteNode(stream, *report, frames, 0);
+      stream.flags(flags);
+      stream.precision(precision);
+   }
+}
@@ -0,0 +1,89 @@
+#include "ControlProfilerDialog.h"
+#include "Window.h"
+
+#include <algorithm>
+#include <cstdio>
+
+namespace wgui
+{
+   void ControlProfilerDialog::Init()
+   {
+      mTarget->SetControlProfiling(true);
+      mLastRefresh = ControlProfiler::Clock::now();
+   }
+
+   void ControlProfilerDialog::Render(WindowBase* const window, nk_context* context)
+   {
+      ControlProfiler* profiler = mTarget->GetControlProfiler();
+      ControlProfiler::Clock::time_point now = ControlProfiler::Clock::now();
+      if (profiler && (!mReport || now - mLastRefresh >= std::chrono::duration<double>(RefreshSeconds)))
+      {
+         mLastRefresh = now;
+         mReport = profiler->GetReport();
+         mFrames = static_cast<double>(std::max<uint64_t>(mReport->Cost.Calls, 1));
+      }
+
+      int width, height;
+      window->GetWindowSize(width, height);
+      if (nk_begin(context, "Control costs", nk_rect(0, 0, (float)width, (float)height), 0))
+      {
+         nk_layout_row_dynamic(context, context->style.font->height + 6, 2);
+         if (nk_button_label(context, profiler ? "Stop" : "Start"))
+         {
+            mTarget->SetControlProfiling(!profiler);
+         }
+
+         if (nk_button_label(context, "Reset") && profiler)
+         {
+            profiler->Reset();
+            mReport.reset();
+         }
+
+         nk_layout_row_dynamic(context, context->style.font->height, 1);
+         nk_label(context, "per frame: calls, incl/excl ms, incl/excl commands, incl/excl vertices", NK_TEXT_LEFT);
+
+         if (mReport)
+         {
+            RenderNode(context, *mReport, "", 0);
+         }
+      }
+
+      nk_end(context);
+   }
+
+   void ControlProfilerDialog::RenderNode(nk_context* context, const ControlProfileNode& node, const std::string& path, int depth)
+   {
+      const ControlCost& cost = node.Cost;
+      std::string name = node.Label;
+      if (!node.Tag.empty() && node.Tag != "Untagged")
+      {
+         name += " [" + node.Tag + "]";
+      }
+
+      char text[256];
+      std::snprintf(text, sizeof(text), "%s  x%.1f  %.3f/%.3f ms  %.0f/%.0f cmds  %.0f/%.0f verts",
+         name.c_str(), cost.Calls / mFrames, cost.InclusiveMs / mFrames, cost.ExclusiveMs / mFrames,
+         cost.InclusiveCommands / mFrames, cost.ExclusiveCommands / mFrames,
+         cost.InclusiveVertices / mFrames, cost.ExclusiveVertices / mFrames);
+
+      if (node.Children.empty())
+      {
+         nk_layout_row_dynamic(context, context->style.font->height, 1);
+         nk_label(context, text, NK_TEXT_LEFT);
+         return;
+      }
+
+      // Hashing the label path keeps a node's open state when the sort order changes.
+      std::string nodePath = path + "/" + node.Label + ":" + node.Tag;
+      if (nk_tree_push_hashed(context, NK_TREE_NODE, text, depth == 0 ? NK_MAXIMIZED : NK_MINIMIZED,
+         nodePath.c_str(), static_cast<int>(nodePath.size()), depth))
+      {
+         for (const auto& child : node.Children)
+         {
+            RenderNode(context, *child, nodePath, depth + 1);
+         }
+
+         nk_tree_pop(context);
+      }
+   }
+}
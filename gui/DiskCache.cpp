@@ -0,0 +1,211 @@
+#include "DiskCache.h"
+
+#include <cstdio>
+#include <filesystem>
+#include <functional>
+#include <system_error>
+#include <thread>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+std::string wgui::DiskCache::mDirectory = "./cache";
+
+namespace
+{
+   struct CacheFileHeader
+   {
+      uint32_t Magic;
+      uint32_t Version;
+      uint64_t Key;
+      uint64_t PayloadSize;
+   };
+
+   constexpr uint32_t CacheMagic = 0x41434757; // "WGCA"
+   constexpr uint32_t CacheVersion = 1;
+}
+
+namespace wgui
+{
+   bool MappedFile::Open(const std::string& path)
+   {
+      Close();
+
+#if defined(_WIN32)
+      HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+         OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+      if (file == INVALID_HANDLE_VALUE)
+      {
+         return false;
+      }
+
+      LARGE_INTEGER size;
+      if (!GetFileSizeEx(file, &size) || size.QuadPart == 0)
+      {
+         CloseHandle(file);
+         return false;
+      }
+
+      // The view keeps the mapping alive, neither handle is needed once it exists.
+      HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+      CloseHandle(file);
+      if (mapping == nullptr)
+      {
+         return false;
+      }
+
+      void* data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+      CloseHandle(mapping);
+      if (data == nullptr)
+      {
+         return false;
+      }
+
+      mData = static_cast<const uint8_t*>(data);
+      mSize = static_cast<size_t>(size.QuadPart);
+#else
+      int fd = open(path.c_str(), O_RDONLY);
+      if (fd < 0)
+      {
+         return false;
+      }
+
+      struct stat info;
+      if (fstat(fd, &info) != 0 || info.st_size == 0)
+      {
+         close(fd);
+         return false;
+      }
+
+      void* data = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+      close(fd);
+      if (data == MAP_FAILED)
+      {
+         return false;
+      }
+
+      mData = static_cast<const uint8_t*>(data);
+      mSize = static_cast<size_t>(info.st_size);
+#endif
+
+      return true;
+   }
+
+   void MappedFile::Close()
+   {
+      if (mData == nullptr)
+      {
+         return;
+      }
+
+#if defined(_WIN32)
+      UnmapViewOfFile(mData);
+#else
+      munmap(const_cast<uint8_t*>(mData), mSize);
+#endif
+
+      mData = nullptr;
+      mSize = 0;
+   }
+
+   std::string DiskCache::GetPath(const std::string& name)
+   {
+      if (!IsEnabled())
+      {
+         return std::string();
+      }
+
+      return (std::filesystem::path(mDirectory) / name).string();
+   }
+
+   const uint8_t* DiskCache::Load(const std::string& path, uint64_t key, MappedFile& file, size_t& payloadSize)
+   {
+      payloadSize = 0;
+      if (path.empty() || !file.Open(path))
+      {
+         return nullptr;
+      }
+
+      CacheFileHeader header;
+      if (file.GetSize() < sizeof(header))
+      {
+         file.Close();
+         return nullptr;
+      }
+
+      memcpy(&header, file.GetData(), sizeof(header));
+      if (header.Magic != CacheMagic || header.Version != CacheVersion || header.Key != key ||
+          header.PayloadSize != file.GetSize() - sizeof(header))
+      {
+         file.Close();
+         return nullptr;
+      }
+
+      payloadSize = static_cast<size_t>(header.PayloadSize);
+      return file.GetData() + sizeof(header);
+   }
+
+   bool DiskCache::Store(const std::string& path, uint64_t key, std::initializer_list<DiskCacheChunk> payload)
+   {
+      if (path.empty())
+      {
+         return false;
+      }
+
+      std::error_code error;
+      std::filesystem::path target(path);
+      if (target.has_parent_path())
+      {
+         std::filesystem::create_directories(target.parent_path(), error);
+         if (error)
+         {
+            return false;
+         }
+      }
+
+      CacheFileHeader header = { CacheMagic, CacheVersion, key, 0 };
+      for (const DiskCacheChunk& chunk : payload)
+      {
+         header.PayloadSize += chunk.Size;
+      }
+
+      // Render threads may store the same file at once, each writes its own temporary.
+      std::string tempPath = path + ".tmp" + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id()));
+      FILE* file = fopen(tempPath.c_str(), "wb");
+      if (file == nullptr)
+      {
+         return false;
+      }
+
+      bool written = fwrite(&header, sizeof(header), 1, file) == 1;
+      for (const DiskCacheChunk& chunk : payload)
+      {
+         if (written && chunk.Size > 0)
+         {
+            written = fwrite(chunk.Data, chunk.Size, 1, file) == 1;
+         }
+      }
+
+      written = fclose(file) == 0 && written;
+      if (written)
+      {
+         std::filesystem::rename(tempPath, target, error);
+         written = !error;
+      }
+
+      if (!written)
+      {
+         std::filesystem::remove(tempPath, error);
+      }
+
+      return written;
+   }
+}
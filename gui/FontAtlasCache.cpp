@@ -0,0 +1,154 @@
+#include "FontAtlasCache.h"
+#include "DiskCache.h"
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+
+namespace
+{
+   // Oversampling of the 1x bake. Higher scales already have the texels, so it drops as the scale grows.
+   static constexpr int BaseOversample = 8;
+
+   // Pixel height of the distance field bake. Fields minify well, so this covers 16px text up to 2x scale.
+   static constexpr float SdfBakeSize = 32.0f;
+
+   void UploadAtlas(void* userdata, const void* image, int width, int height)
+   {
+      GLuint* texture = static_cast<GLuint*>(userdata);
+      *texture = nk_glfw3_create_atlas_texture(image, width, height, NK_FONT_ATLAS_ALPHA8);
+   }
+}
+
+namespace wgui
+{
+   FontAtlasCache::FontAtlasCache(int fontSize, eFontRenderMode mode)
+      : mFontSize(fontSize), mRenderMode(mode)
+   {
+   }
+
+   FontAtlasCache::~FontAtlasCache()
+   {
+      // Textures go with the share group, only the cpu side is left if Release wasn't called.
+      for (auto& entry : mEntries)
+      {
+         nk_font_atlas_clear(&entry->Atlas);
+      }
+   }
+
+   int FontAtlasCache::GetScaleKey(float scale)
+   {
+      return std::max(25, static_cast<int>(std::lround(scale * 100.0f)));
+   }
+
+   nk_font* FontAtlasCache::AddDefaultFont(nk_font_atlas* fontAtlas, float height)
+   {
+      struct nk_font_config cfg = nk_font_config(height);
+
+      nk_font* font = nk_font_atlas_add_from_file(fontAtlas,
+         "res/fonts/RockoFLF.ttf", height, &cfg);
+
+      if (font != nullptr)
+      {
+         font->config->oversample_h = 8;
+         font->config->oversample_v = 8;
+         font->config->pixel_snap = true;
+      }
+
+      return font;
+   }
+
+   const FontAtlasCache::Entry* FontAtlasCache::Get(float scale)
+   {
+      bool sdf = mRenderMode == eFontRenderMode::Sdf;
+      int scaleKey = sdf ? 0 : GetScaleKey(scale);
+
+      // Windows rendered on their own threads can move to a new scale at the same time.
+      std::lock_guard<std::mutex> lock(mMutex);
+      for (auto& entry : mEntries)
+      {
+         if (entry->ScaleKey == scaleKey)
+         {
+            return entry.get();
+         }
+      }
+
+      auto entry = std::make_unique<Entry>();
+      entry->ScaleKey = scaleKey;
+      entry->Texture = 0;
+      entry->Sdf = sdf;
+
+      nk_font_atlas_init_default(&entry->Atlas);
+      nk_font_atlas_begin(&entry->Atlas);
+      entry->Font = AddDefaultFont(&entry->Atlas, sdf ? SdfBakeSize : mFontSize * scaleKey / 100.0f);
+      if (entry->Font == nullptr)
+      {
+         nk_font_atlas_clear(&entry->Atlas);
+         return nullptr;
+      }
+
+      nk_glfw_atlas_source source;
+      if (sdf)
+      {
+         // Distance fields are sampled bilinearly at any size, oversampling only adds texels.
+         entry->Font->config->oversample_h = 1;
+         entry->Font->config->oversample_v = 1;
+         source = nk_glfw3_font_atlas_bake_sdf(&entry->Atlas, DiskCache::GetPath("font_atlas_sdf.bin").c_str(),
+            UploadAtlas, &entry->Texture);
+      }
+      else
+      {
+         unsigned char oversample = static_cast<unsigned char>(std::max(2, BaseOversample * 100 / scaleKey));
+         entry->Font->config->oversample_h = oversample;
+         entry->Font->config->oversample_v = oversample;
+
+         std::string cacheFile = DiskCache::GetPath("font_atlas_" + std::to_string(scaleKey) + ".bin");
+         source = nk_glfw3_font_atlas_bake_cached(&entry->Atlas, NK_FONT_ATLAS_ALPHA8, cacheFile.c_str(),
+            UploadAtlas, &entry->Texture);
+      }
+
+      if (source == NK_GLFW_ATLAS_FAILED)
+      {
+         nk_font_atlas_clear(&entry->Atlas);
+         return nullptr;
+      }
+
+      nk_font_atlas_end(&entry->Atlas, nk_handle_id(static_cast<int>(entry->Texture)), &entry->TexNull);
+
+      // Glyph lookups only need the baked data, drop the copy of the ttf file.
+      nk_font_atlas_cleanup(&entry->Atlas);
+
+      mEntries.push_back(std::move(entry));
+      return mEntries.back().get();
+   }
+
+   void FontAtlasCache::Prewarm()
+   {
+      if (mRenderMode == eFontRenderMode::Sdf)
+      {
+         Get(1.0f);
+         return;
+      }
+
+      int count = 0;
+      GLFWmonitor** monitors = glfwGetMonitors(&count);
+      for (int i = 0; i < count; i++)
+      {
+         float scaleX, scaleY;
+         glfwGetMonitorContentScale(monitors[i], &scaleX, &scaleY);
+         Get(scaleY);
+      }
+   }
+
+   void FontAtlasCache::Release()
+   {
+      std::lock_guard<std::mutex> lock(mMutex);
+      for (auto& entry : mEntries)
+      {
+         glDeleteTextures(1, &entry->Texture);
+         nk_font_atlas_clear(&entry->Atlas);
+      }
+
+      mEntries.clear();
+   }
+}
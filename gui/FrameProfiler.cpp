@@ -0,0 +1,167 @@
+#include "FrameProfiler.h"
+
+#include <algorithm>
+
+namespace
+{
+   constexpr size_t PhaseCount = static_cast<size_t>(wgui::eFramePhase::Count);
+
+   const char* const PhaseNames[PhaseCount] =
+   {
+      "Input",
+      "Layout",
+      "Convert",
+      "Upload",
+      "Draw",
+      "Swap",
+      "Gpu",
+      "Interval"
+   };
+}
+
+namespace wgui
+{
+   void FrameProfiler::Commit()
+   {
+      Clock::time_point now = Now();
+      mCurrent[eFramePhase::Interval] = mHasLastCommit ? ElapsedMs(mLastCommit, now) : 0.0f;
+      mLastCommit = now;
+      mHasLastCommit = true;
+
+      uint64_t index = mWriteIndex.load(std::memory_order_relaxed);
+      Slot& slot = mSlots[index % Capacity];
+
+      // Odd while the slot is being written, readers that see it skip the slot.
+      slot.Sequence.store(index * 2 + 1, std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_release);
+
+      for (size_t i = 0; i < PhaseCount; i++)
+      {
+         slot.Phases[i].store(mCurrent.Phases[i], std::memory_order_relaxed);
+      }
+
+      slot.Sequence.store(index * 2 + 2, std::memory_order_release);
+      mWriteIndex.store(index + 1, std::memory_order_release);
+
+      mCurrent = FrameSample();
+   }
+
+   uint64_t FrameProfiler::GetSamples(std::vector<FrameSample>& samples, uint64_t firstFrame) const
+   {
+      samples.clear();
+
+      uint64_t end = mWriteIndex.load(std::memory_order_acquire);
+      uint64_t begin = std::max(firstFrame, end > Capacity ? end - Capacity : 0);
+
+      for (uint64_t index = begin; index < end; index++)
+      {
+         const Slot& slot = mSlots[index % Capacity];
+         uint64_t expected = index * 2 + 2;
+         if (slot.Sequence.load(std::memory_order_acquire) != expected)
+         {
+            continue;
+         }
+
+         FrameSample sample;
+         sample.Frame = index;
+         for (size_t i = 0; i < PhaseCount; i++)
+         {
+            sample.Phases[i] = slot.Phases[i].load(std::memory_order_relaxed);
+         }
+
+         // The writer lapped us while copying, the sample is a mix of two frames.
+         std::atomic_thread_fence(std::memory_order_acquire);
+         if (slot.Sequence.load(std::memory_order_relaxed) != expected)
+         {
+            continue;
+         }
+
+         samples.push_back(sample);
+      }
+
+      return end;
+   }
+
+   FramePhaseSummary FrameProfiler::Summarize(eFramePhase phase) const
+   {
+      std::vector<FrameSample> samples;
+      GetSamples(samples);
+      return Summarize(samples, phase);
+   }
+
+   FramePhaseSummary FrameProfiler::Summarize(const std::vector<FrameSample>& samples, eFramePhase phase)
+   {
+      FramePhaseSummary summary;
+      std::vector<float> values;
+      values.reserve(samples.size());
+      double total = 0;
+      for (const FrameSample& sample : samples)
+      {
+         if (sample[phase] >= 0)
+         {
+            values.push_back(sample[phase]);
+            total += sample[phase];
+         }
+      }
+
+      if (values.empty())
+      {
+         return summary;
+      }
+
+      summary.Mean = static_cast<float>(total / values.size());
+
+      // Nearest rank, so small sample counts report values that actually occurred.
+      auto percentile = [&values](double p)
+      {
+         size_t rank = static_cast<size_t>(p * (values.size() - 1) + 0.5);
+         std::nth_element(values.begin(), values.begin() + rank, values.end());
+         return values[rank];
+      };
+
+      summary.P50 = percentile(0.50);
+      summary.P95 = percentile(0.95);
+      summary.P99 = percentile(0.99);
+      return summary;
+   }
+
+   const char* FrameProfiler::GetPhaseName(eFramePhase phase)
+   {
+      return PhaseNames[static_cast<size_t>(phase)];
+   }
+
+   void FrameProfiler::WriteCsvHeader(std::ostream& stream)
+   {
+      stream << "frame";
+      for (size_t i = 0; i < PhaseCount; i++)
+      {
+         stream << "," << PhaseNames[i] << "_ms";
+      }
+      stream << "\n";
+   }
+
+   uint64_t FrameProfiler::WriteCsv(std::ostream& stream, uint64_t& cursor) const
+   {
+      std::vector<FrameSample> samples;
+      uint64_t end = GetSamples(samples, cursor);
+      uint64_t oldest = end > Capacity ? end - Capacity : 0;
+      uint64_t lost = oldest > cursor ? oldest - cursor : 0;
+
+      for (const FrameSample& sample : samples)
+      {
+         stream << sample.Frame;
+         for (size_t i = 0; i < PhaseCount; i++)
+         {
+            stream << ",";
+            if (sample.Phases[i] >= 0)
+            {
+               stream << sample.Phases[i];
+            }
+         }
+         stream << "\n";
+      }
+
+      cursor = std::max(cursor, end);
+      return lost;
+   }
+}
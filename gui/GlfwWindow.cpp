@@ -2,51 +2,200 @@
 #include "Window.h"
 #include "OperatingSystem.h"
 #include "App.h"
+#include "DiskCache.h"
 
-#define NK_IMPLEMENTATION
-#include "nuklear.h"
+#include <algorithm>
+
+#include "include_nuk.h"
 #include "nuklear_glfw_gl3.h"
 
 std::map<GLFWwindow*, wgui::WindowBase*> wgui::Application::mWindows;
 wgui::MainWindow* wgui::Application::mMainWindow;
+wgui::eRenderMode wgui::Application::mRenderMode = wgui::eRenderMode::Idle;
+bool wgui::Application::mThreadedRendering = false;
+double wgui::Application::mIdleTimeout = 1.0;
+int wgui::Application::mFramesUntilIdle = 0;
+std::atomic<bool> wgui::Application::mWakeRequested = false;
+std::atomic<int> wgui::Application::mAnimationFrames = 0;
 
 namespace
 {
-   static constexpr int MaxVertexBuffer = 512 * 1024;
-   static constexpr int MaxElementBuffer = 128 * 1024;
+   // Starting sizes of the per-frame vertex/element buffers, the backend grows them when a frame doesn't fit.
+   static constexpr int InitialVertexBuffer = 512 * 1024;
+   static constexpr int InitialElementBuffer = 128 * 1024;
+
+   // Frames rendered after the last input before the loop starts blocking.
+   // Nuklear needs a couple of frames to settle hover and click states.
+   static constexpr int IdleGraceFrames = 3;
+
+   // Baked atlas of the headless window's font, keyed on the font file and bake settings so edits invalidate it.
+   static constexpr const char* FontAtlasCacheFile = "font_atlas.bin";
 
    void GlfwErrorCallback(int errCode, const char* msg)
    {
       wgui::Application::Logger.error("{int}: {str}", errCode, msg);
    }
 
-   void DrawFrame(wgui::WindowBase* window, GLFWwindow* gWin, nk_glfw* nkGlfw, wgui::WindowRenderer* layoutRenderer)
+   /// <summary>
+   /// Lays out and draws one frame. Returns false if the frame was identical to the last one
+   /// and skipping is enabled, in which case nothing was drawn and there is nothing to present.
+   /// Input is read from glfw unless a capture posted by the main thread is given.
+   /// </summary>
+   bool DrawFrame(wgui::WindowBase* window, GLFWwindow* gWin, nk_glfw* nkGlfw, wgui::WindowRenderer* layoutRenderer,
+      const nk_glfw_input* input = nullptr)
    {
+      wgui::FrameProfiler* profiler = window->GetFrameProfiler();
+      wgui::ControlProfiler* controlProfiler = window->GetControlProfiler();
+      wgui::FrameProfiler::Clock::time_point start;
+
+      // Queries belong to the context, so they follow the profiling state on the drawing thread.
+      if ((profiler != nullptr) != (nkGlfw->ogl.gpu_timing != 0))
+      {
+         nk_glfw3_set_gpu_timing(nkGlfw, profiler != nullptr);
+      }
+
       // Render  
-      nk_glfw3_new_frame(nkGlfw);
+      if (profiler) start = wgui::FrameProfiler::Now();
+      if (input != nullptr)
+      {
+         nk_glfw3_apply_input(nkGlfw, input);
+      }
+      else
+      {
+         nk_glfw3_new_frame(nkGlfw);
+      }
+
+      if (profiler)
+      {
+         wgui::FrameProfiler::Clock::time_point now = wgui::FrameProfiler::Now();
+         profiler->GetCurrentSample()[wgui::eFramePhase::Input] = wgui::FrameProfiler::ElapsedMs(start, now);
+         start = now;
+      }
+
+      // Images decoded since the last frame, before the layout so their menus draw them right away.
+      if (wgui::ImageAtlas* images = window->GetImageAtlas())
+      {
+         images->Upload();
+      }
+
+      if (controlProfiler) controlProfiler->BeginFrame();
       layoutRenderer->RenderStart(window, &nkGlfw->ctx);
       layoutRenderer->Render(window, &nkGlfw->ctx);
 
+      if (profiler)
+      {
+         profiler->GetCurrentSample()[wgui::eFramePhase::Layout] = wgui::FrameProfiler::ElapsedMs(start, wgui::FrameProfiler::Now());
+      }
+
+      if (controlProfiler)
+      {
+         struct nk_convert_config config;
+         nk_glfw3_fill_convert_config(nkGlfw, NK_ANTI_ALIASING_ON, &config);
+         controlProfiler->EndFrame(&nkGlfw->ctx, config, nk_glfw3_tessellation_tolerance(nkGlfw));
+      }
+
+      if (window->GetSkipUnchangedFrames() && !nk_glfw3_frame_changed(nkGlfw))
+      {
+         nk_clear(&nkGlfw->ctx);
+         layoutRenderer->RenderFinish(window, &nkGlfw->ctx);
+         return false;
+      }
+
       // Draw
       glClear(GL_COLOR_BUFFER_BIT);
-      nk_glfw3_render(nkGlfw, NK_ANTI_ALIASING_ON, MaxVertexBuffer, MaxElementBuffer);
+      nk_glfw3_render(nkGlfw, NK_ANTI_ALIASING_ON, InitialVertexBuffer, InitialElementBuffer);
       layoutRenderer->RenderFinish(window, &nkGlfw->ctx);
+
+      if (profiler)
+      {
+         wgui::FrameSample& sample = profiler->GetCurrentSample();
+         sample[wgui::eFramePhase::Convert] = nkGlfw->stats.convert_ms;
+         sample[wgui::eFramePhase::Upload] = nkGlfw->stats.upload_ms;
+         sample[wgui::eFramePhase::Draw] = nkGlfw->stats.draw_ms;
+         sample[wgui::eFramePhase::Gpu] = nkGlfw->stats.gpu_ms >= 0 ? nkGlfw->stats.gpu_ms : wgui::FrameProfiler::NotMeasured;
+      }
+
+      return true;
+   }
+
+   /// <summary>
+   /// Time between two refreshes of the primary monitor, used to pace the loop
+   /// when no window presented a frame and vsync didn't block.
+   /// </summary>
+   double GetRefreshPeriod()
+   {
+      int refreshRate = 60;
+      GLFWmonitor* monitor = glfwGetPrimaryMonitor();
+      const GLFWvidmode* mode = monitor ? glfwGetVideoMode(monitor) : nullptr;
+
+      if (mode && mode->refreshRate > 0)
+      {
+         refreshRate = mode->refreshRate;
+      }
+
+      return 1.0 / refreshRate;
+   }
+
+   /// <summary>
+   /// Refresh period of the monitor the center of the window is on.
+   /// </summary>
+   double GetWindowRefreshPeriod(GLFWwindow* window)
+   {
+      int x, y, width, height;
+      glfwGetWindowPos(window, &x, &y);
+      glfwGetWindowSize(window, &width, &height);
+      int centerX = x + width / 2;
+      int centerY = y + height / 2;
+
+      int count = 0;
+      GLFWmonitor** monitors = glfwGetMonitors(&count);
+      for (int i = 0; i < count; i++)
+      {
+         int monitorX, monitorY;
+         glfwGetMonitorPos(monitors[i], &monitorX, &monitorY);
+         const GLFWvidmode* mode = glfwGetVideoMode(monitors[i]);
+
+         if (mode && mode->refreshRate > 0 &&
+             centerX >= monitorX && centerX < monitorX + mode->width &&
+             centerY >= monitorY && centerY < monitorY + mode->height)
+         {
+            return 1.0 / mode->refreshRate;
+         }
+      }
+
+      return GetRefreshPeriod();
    }
 
    void WindowResizeCallback(GLFWwindow* window, int width, int height)
    {
       wgui::WindowBase* win = wgui::Application::GetWindow(window);
-      if (win->GetRenderer())
+      if (win->GetRenderThread())
+      {
+         // The render thread picks the new size up from the capture.
+         win->GetRenderThread()->PostInput();
+      }
+      else if (win->GetRenderer())
       {
          auto win = wgui::Application::GetWindow(window);
          win->Render();
-         glfwSwapBuffers(window);
+
+         if (win->FramePresented())
+         {
+            win->Present();
+         }
       }
    }
 
    void WindowMoveCallback(GLFWwindow* window, int width, int height)
    {
       wgui::WindowBase* win = wgui::Application::GetWindow(window);
+      if (win->GetRenderThread())
+      {
+         // Content scale changes travel with the capture, the render thread applies them.
+         win->GetRenderThread()->SetRefreshPeriod(GetWindowRefreshPeriod(window));
+         win->GetRenderThread()->PostInput();
+         return;
+      }
 
       win->SetContentScale();
       if (win->GetRenderer())
@@ -235,6 +384,19 @@ namespace
          nk_style_default(ctx);
       }
    }
+
+   /// <summary>
+   /// Theme and spacing every top level window starts out with.
+   /// </summary>
+   void SetDefaultStyle(nk_context* ctx)
+   {
+      SetStyle(ctx, eTheme::Black);
+
+      ctx->style.window.scrollbar_size = nk_vec2(2, 2);
+      ctx->style.window.group_padding = nk_vec2(2, 4);
+      ctx->style.window.group_border = 2;
+      ctx->style.window.spacing = nk_vec2(4, 4);
+   }
 }
 
 /// <summary>
@@ -395,9 +557,21 @@ namespace wgui
       ScaleVec2(result.tooltip_padding, base.tooltip_padding, scaleX, scaleY);
    }
 
-   void WindowStyle::Scale(nk_style* style, nk_font* font, float scaleX, float scaleY)
+   void WindowStyle::Scale(nk_style* style, nk_user_font* font, float scaleX, float scaleY)
    {
-      font->handle.height = mFontSize * scaleY;
+      font->height = mFontSize * scaleY;
+
+      for (const ScaledStyle& scaled : mScaledStyles)
+      {
+         if (scaled.ScaleX == scaleX && scaled.ScaleY == scaleY)
+         {
+            // The cached copy may come from another window, keep this window's font.
+            const nk_user_font* windowFont = style->font;
+            std::memcpy(style, &scaled.Style, sizeof(nk_style));
+            style->font = windowFont;
+            return;
+         }
+      }
 
       // Text
       style->text.padding = nk_vec2(scaleX * mStyle.text.padding.x, scaleY * mStyle.text.padding.y);
@@ -424,6 +598,12 @@ namespace wgui
 
       // Window
       ScaleWindow(style->window, mStyle.window, scaleX, scaleY);
+
+      ScaledStyle scaled;
+      scaled.ScaleX = scaleX;
+      scaled.ScaleY = scaleY;
+      std::memcpy(&scaled.Style, style, sizeof(nk_style));
+      mScaledStyles.push_back(scaled);
    }
 
 #pragma endregion
@@ -450,9 +630,16 @@ namespace wgui
       return mGlewContext.InitContext();
    }
 
-   bool NuklearGlfwContextManager::InitNkContext(GLFWwindow* window)
+   bool NuklearGlfwContextManager::InitNkContext(GLFWwindow* window, const NuklearGlfwContextManager* share)
+   {
+      mNkContext = nk_glfw3_init_shared(mNkGlfw.get(), window, NK_GLFW3_INSTALL_CALLBACKS,
+         share ? share->GetGlfw() : nullptr);
+      return mNkContext != nullptr;
+   }
+
+   bool NuklearGlfwContextManager::InitHeadlessNkContext()
    {
-      mNkContext = nk_glfw3_init(mNkGlfw.get(), window, NK_GLFW3_INSTALL_CALLBACKS);
+      mNkContext = nk_glfw3_init_headless(mNkGlfw.get());
       return mNkContext != nullptr;
    }
 
@@ -496,24 +683,132 @@ namespace wgui
 
    void Application::RenderWindows()
    {
-      glfwSwapInterval(1);
       assert("You must have a main window" && mMainWindow != nullptr);
+      if (mThreadedRendering)
+      {
+         PostWindowInput();
+         return;
+      }
+
+      glfwSwapInterval(1);
+      bool presented = false;
+      bool inputActive = false;
 
       for (auto& window : mWindows)
       {
          assert("Each window must have a renderer" && window.second->mLastRenderer);
          window.second->Render();
          window.second->Update();
+         inputActive |= window.second->mInputActive;
 
-         glfwSwapBuffers(window.second->mWindow);
-         glfwSwapInterval(0);
+         if (window.second->mFramePresented)
+         {
+            window.second->Present();
+            glfwSwapInterval(0);
+            presented = true;
+         }
       }
 
-      glfwPollEvents();
+      WaitForNextFrame(presented, inputActive);
+   }
+
+   void Application::PostWindowInput()
+   {
+      bool inputActive = false;
+
+      for (auto& window : mWindows)
+      {
+         assert("Each window must have a renderer" && window.second->mLastRenderer);
+         if (!window.second->mRenderThread)
+         {
+            window.second->StartRenderThread();
+         }
+
+         window.second->mRenderThread->PostInput();
+         window.second->Update();
+         inputActive |= window.second->mRenderThread->InputActive();
+      }
+
+      if (mRenderMode == eRenderMode::Continuous)
+      {
+         // The render threads draw back to back on their own, polling here would only spin.
+         glfwWaitEventsTimeout(GetRefreshPeriod());
+         return;
+      }
+
+      // Presenting is up to the render threads, the main thread only waits for the next events.
+      WaitForNextFrame(false, inputActive);
+   }
+
+   void Application::WaitForNextFrame(bool presented, bool inputActive)
+   {
+      if (mRenderMode == eRenderMode::Continuous)
+      {
+         glfwPollEvents();
+         return;
+      }
+
+      if (inputActive || mWakeRequested.exchange(false))
+      {
+         mFramesUntilIdle = IdleGraceFrames;
+      }
+
+      // If a job requested more frames in the meantime the exchange fails and their count wins.
+      int animationFrames = mAnimationFrames.load();
+      bool animating = animationFrames > 0;
+      if (animating)
+      {
+         mAnimationFrames.compare_exchange_strong(animationFrames, animationFrames - 1);
+      }
+
+      if (animating || mFramesUntilIdle > 0)
+      {
+         if (mFramesUntilIdle > 0)
+         {
+            mFramesUntilIdle--;
+         }
+
+         if (presented)
+         {
+            glfwPollEvents();
+         }
+         else
+         {
+            // Nothing swapped so vsync didn't throttle us, wait out a refresh (or the next event) instead.
+            glfwWaitEventsTimeout(GetRefreshPeriod());
+         }
+      }
+      else
+      {
+         // Nothing going on, sleep until the user does something, a job wakes us, or the timeout passes.
+         glfwWaitEventsTimeout(mIdleTimeout);
+      }
+   }
+
+   void Application::WakeUp()
+   {
+      mWakeRequested = true;
+      glfwPostEmptyEvent();
+   }
+
+   void Application::RequestAnimationFrames(int frameCount)
+   {
+      int current = mAnimationFrames.load();
+      while (current < frameCount && !mAnimationFrames.compare_exchange_weak(current, frameCount))
+      {
+      }
+
+      WakeUp();
    }
 
    void Application::Shutdown()
    {
+      // Dialogs draw with the main window's font textures, stop every render thread before any window goes away.
+      for (auto& window : mWindows)
+      {
+         window.second->StopRenderThread();
+      }
+
       // Close all windows.
       for (auto& window : mWindows)
       {
@@ -585,31 +880,17 @@ namespace wgui
       // Setup fonts
       GlLogger.trace("Mapping default font");
 
-      // DPI settings
-      float scaleX, scaleY;
-      glfwGetWindowContentScale(mWindow, &scaleX, &scaleY);
-
-      int fontHeight = 16;
-      struct nk_font_config cfg = nk_font_config(fontHeight);
-      struct nk_font_atlas* fontAtlas;
-
-      nk_glfw3_font_stash_begin(nkGlfw, &fontAtlas);
-      mFont = nk_font_atlas_add_from_file(fontAtlas, 
-         "res/fonts/RockoFLF.ttf", fontHeight, &cfg);
-
-      mFont->config->oversample_h = 8;
-      mFont->config->oversample_v = 8;
-      mFont->config->pixel_snap = true;
-
-      nk_glfw3_font_stash_end(nkGlfw);
-      nk_style_set_font(ctx, &mFont->handle);
+      // The font is baked at every monitor's content scale up front, SetContentScale picks the
+      // bake for the monitor the window is on.
+      mFontAtlases = std::make_shared<FontAtlasCache>(16, mFontRenderMode);
+      mFontAtlases->Prewarm();
+      GlLogger.trace("Baked font for {int} content scales", static_cast<int>(mFontAtlases->GetCount()));
 
-      SetStyle(ctx, eTheme::Black);
+      // Images decode in the background, the loop wakes up to draw them once they are in.
+      mImageAtlas = std::make_shared<ImageAtlas>();
+      mImageAtlas->SetDecodedCallback(Application::WakeUp);
 
-      ctx->style.window.scrollbar_size = nk_vec2(2, 2);
-      ctx->style.window.group_padding = nk_vec2(2, 4);
-      ctx->style.window.group_border = 2;
-      ctx->style.window.spacing = nk_vec2(4, 4);
+      SetDefaultStyle(ctx);
 
       // Add the window to the application static data.
       Application::AddMainWindow(this);
@@ -621,6 +902,15 @@ namespace wgui
       // Create window style from the previously set style.
       mWindowStyle = std::make_unique<WindowStyle>(&ctx->style);
       SetContentScale();
+
+      // The font handle is filled in by the bake for the window's scale.
+      if (mFont == nullptr)
+      {
+         GlLogger.critical("Failed to bake the default font");
+         return false;
+      }
+
+      nk_style_set_font(ctx, &mFontHandle);
       return true;
    }
 
@@ -629,12 +919,15 @@ namespace wgui
       bool resizable,
       bool visible, bool decorated, bool fullScreen)
    {
-      mWindow = glfwCreateWindow(width, height, title.c_str(), fullScreen ? glfwGetPrimaryMonitor() : nullptr, nullptr);
+      WindowBase* mainWindow = reinterpret_cast<WindowBase*>(mMainWindow);
+
+      // Share the main window's gl objects so the program and font texture don't have to be rebuilt.
+      mWindow = glfwCreateWindow(width, height, title.c_str(), fullScreen ? glfwGetPrimaryMonitor() : nullptr,
+         mainWindow->mWindow);
       glfwMakeContextCurrent(mWindow);
 
-      mNkContext.InitNkContext(mWindow);
+      mNkContext.InitNkContext(mWindow, &mainWindow->mNkContext);
       nk_context* ctx = mNkContext.GetContext();
-      nk_glfw* nkGlfw = mNkContext.GetGlfw();
 
       if (ctx == nullptr)
       {
@@ -642,29 +935,14 @@ namespace wgui
          return false;
       }
 
-      // Setup fonts
-      Application::Logger.trace("Mapping default font");
-
-      // DPI settings
-      float scaleX, scaleY;
-      glfwGetWindowContentScale(mWindow, &scaleX, &scaleY);
-
-      int fontHeight = 16;
-      struct nk_font_config cfg = nk_font_config(fontHeight);
-      struct nk_font_atlas* fontAtlas;
+      // Reference the main window's baked fonts, the handle is copied since its height follows this window's scale.
+      mFontAtlases = mainWindow->mFontAtlases;
+      mImageAtlas = mainWindow->mImageAtlas;
+      mFont = mainWindow->mFont;
+      mFontHandle = mFont->handle;
+      nk_style_set_font(ctx, &mFontHandle);
 
-      nk_glfw3_font_stash_begin(nkGlfw, &fontAtlas);
-      mFont = nk_font_atlas_add_from_file(fontAtlas,
-         "res/fonts/RockoFLF.ttf", fontHeight, &cfg);
-
-      mFont->config->oversample_h = 8;
-      mFont->config->oversample_v = 8;
-      mFont->config->pixel_snap = true;
-
-      nk_glfw3_font_stash_end(nkGlfw);
-      nk_style_set_font(ctx, &mFont->handle);
-
-      mWindowStyle = std::make_unique<WindowStyle>(*(reinterpret_cast<WindowBase*>(mMainWindow)->mWindowStyle.get()));
+      mWindowStyle = std::make_unique<WindowStyle>(*mainWindow->mWindowStyle.get());
 
       // Add the window to the application static data.
       Application::AddDialog(this);
@@ -682,13 +960,37 @@ namespace wgui
       float scaleX, scaleY;
       glfwGetWindowContentScale(mWindow, &scaleX, &scaleY);
 
+      // A scale without a prewarmed atlas is baked into this window's share group.
+      glfwMakeContextCurrent(mWindow);
+      ApplyContentScale(scaleX, scaleY);
+   }
+
+   void WindowBase::ApplyContentScale(float scaleX, float scaleY)
+   {
       if (scaleX != mContentScaleX || scaleY != mContentScaleY)
       {
          mContentScaleX = scaleX;
          mContentScaleY = scaleY;
 
+         // Glyphs baked at this scale instead of stretching another bake.
+         const FontAtlasCache::Entry* atlas = mFontAtlases ? mFontAtlases->Get(scaleY) : nullptr;
+         if (atlas != nullptr)
+         {
+            mFont = atlas->Font;
+            mFontHandle = mFont->handle;
+            if (atlas->Sdf)
+            {
+               nk_glfw3_use_sdf_atlas(mNkContext.GetGlfw(), atlas->Texture, &atlas->TexNull);
+            }
+            else
+            {
+               nk_glfw3_use_atlas(mNkContext.GetGlfw(), atlas->Texture, &atlas->TexNull);
+            }
+         }
+
          // Scale padding, spacing, font size etc.
-         mWindowStyle->Scale(&mNkContext.GetContext()->style, mFont, mContentScaleX, mContentScaleY);
+         mWindowStyle->Scale(&mNkContext.GetContext()->style, &mFontHandle, mContentScaleX, mContentScaleY);
+         NotifyStyleChanged();
       }
    }
 
@@ -696,7 +998,59 @@ namespace wgui
    {
       glfwMakeContextCurrent(mWindow);
       nk_glfw* nkGlfw = mNkContext.GetGlfw();
-      DrawFrame(this, mWindow, nkGlfw, mLastRenderer);
+      mFramePresented = DrawFrame(this, mWindow, nkGlfw, mLastRenderer);
+      mInputActive = nk_glfw3_input_active(nkGlfw);
+
+      if (!mFramePresented)
+      {
+         mSkippedFrames++;
+      }
+   }
+
+   void WindowBase::Present()
+   {
+      FrameProfiler* profiler = GetFrameProfiler();
+      if (!profiler)
+      {
+         glfwSwapBuffers(mWindow);
+         return;
+      }
+
+      FrameProfiler::Clock::time_point start = FrameProfiler::Now();
+      glfwSwapBuffers(mWindow);
+      profiler->GetCurrentSample()[eFramePhase::Swap] = FrameProfiler::ElapsedMs(start, FrameProfiler::Now());
+      profiler->Commit();
+   }
+
+   void WindowBase::SetFrameProfiling(bool enable)
+   {
+      if (enable && !mFrameProfiler)
+      {
+         mFrameProfiler = std::make_unique<FrameProfiler>();
+      }
+
+      mFrameProfiling = enable;
+   }
+
+   void WindowBase::SetControlProfiling(bool enable)
+   {
+      if (enable && !mControlProfiler)
+      {
+         mControlProfiler = std::make_unique<ControlProfiler>();
+      }
+
+      mControlProfiling = enable;
+   }
+
+   void WindowBase::SetSkipUnchangedFrames(bool skip)
+   {
+      if (skip && !mSkipUnchangedFrames)
+      {
+         // The last hash may be from a frame that is no longer on screen.
+         nk_glfw3_invalidate_frame(mNkContext.GetGlfw());
+      }
+
+      mSkipUnchangedFrames = skip;
    }
 
    void WindowBase::Update()
@@ -704,6 +1058,199 @@ namespace wgui
       mClosing = glfwWindowShouldClose(mWindow);
    }
 
+   WindowRenderThread::WindowRenderThread(WindowBase* window)
+      : mWindow(window), mPendingInput()
+   {
+   }
+
+   WindowRenderThread::~WindowRenderThread()
+   {
+      Stop();
+   }
+
+   void WindowRenderThread::Start()
+   {
+      // glfw reads the clipboard on the main thread only, nuklear's callbacks go through this thread instead.
+      nk_context* ctx = mWindow->mNkContext.GetContext();
+      ctx->clip.paste = ClipboardPaste;
+      ctx->clip.copy = ClipboardCopy;
+      ctx->clip.userdata = nk_handle_ptr(this);
+
+      // A context can only be current on one thread.
+      if (glfwGetCurrentContext() == mWindow->mWindow)
+      {
+         glfwMakeContextCurrent(nullptr);
+      }
+
+      mStopRequested = false;
+      mThread = std::thread(&WindowRenderThread::Run, this);
+   }
+
+   void WindowRenderThread::Stop()
+   {
+      if (!mThread.joinable())
+      {
+         return;
+      }
+
+      {
+         std::lock_guard<std::mutex> lock(mMutex);
+         mStopRequested = true;
+      }
+
+      mInputPosted.notify_one();
+      mThread.join();
+   }
+
+   void WindowRenderThread::PostInput()
+   {
+      const nk_glfw_input* input = nk_glfw3_capture_input(mWindow->mNkContext.GetGlfw());
+
+      // Read the clipboard up front, the render thread only needs it when paste is pressed.
+      const char* clipboard = nullptr;
+      if (input->keys[NK_KEY_PASTE])
+      {
+         clipboard = glfwGetClipboardString(mWindow->mWindow);
+      }
+
+      std::string copiedText;
+      bool copyPending;
+      {
+         std::lock_guard<std::mutex> lock(mMutex);
+         if (mInputPending)
+         {
+            nk_glfw3_merge_input(&mPendingInput, input);
+         }
+         else
+         {
+            mPendingInput = *input;
+            mInputPending = true;
+         }
+
+         if (clipboard != nullptr)
+         {
+            mPendingPaste = clipboard;
+         }
+
+         copyPending = mCopyPending;
+         mCopyPending = false;
+         copiedText.swap(mCopiedText);
+      }
+
+      mInputPosted.notify_one();
+
+      if (copyPending)
+      {
+         glfwSetClipboardString(mWindow->mWindow, copiedText.c_str());
+      }
+   }
+
+   void WindowRenderThread::Run()
+   {
+      GLFWwindow* gWin = mWindow->mWindow;
+      nk_glfw* nkGlfw = mWindow->mNkContext.GetGlfw();
+
+      // Each window waits for its own vblank, swaps no longer stack up behind each other.
+      glfwMakeContextCurrent(gWin);
+      glfwSwapInterval(1);
+
+      nk_glfw_input input = {};
+      bool hasInput = false;
+      bool presented = true;
+      int framesUntilIdle = 0;
+
+      for (;;)
+      {
+         {
+            std::unique_lock<std::mutex> lock(mMutex);
+            bool active = hasInput && (Application::GetRenderMode() == eRenderMode::Continuous ||
+               framesUntilIdle > 0 || Application::Animating());
+            auto posted = [this]() { return mStopRequested || mInputPending; };
+
+            if (!active)
+            {
+               // Idle until the main thread sees an event, a wake up or its idle timeout.
+               mInputPosted.wait(lock, posted);
+            }
+            else if (!presented)
+            {
+               // Nothing swapped so vsync didn't throttle us, wait out a refresh of this window's monitor instead.
+               mInputPosted.wait_for(lock, std::chrono::duration<double>(mRefreshPeriod.load()), posted);
+            }
+
+            if (mStopRequested)
+            {
+               break;
+            }
+
+            if (mInputPending)
+            {
+               input = mPendingInput;
+               mInputPending = false;
+               mPasteText.swap(mPendingPaste);
+               mPendingPaste.clear();
+               hasInput = true;
+            }
+            else
+            {
+               // Redraw with the last capture, its text and scrolling were already delivered.
+               input.text_len = 0;
+               input.scroll = nk_vec2(0, 0);
+            }
+         }
+
+         mWindow->ApplyContentScale(input.content_scale_x, input.content_scale_y);
+         presented = DrawFrame(mWindow, gWin, nkGlfw, mWindow->mLastRenderer, &input);
+
+         bool inputActive = nk_glfw3_input_active(nkGlfw);
+         mInputActive = inputActive;
+
+         if (presented)
+         {
+            mWindow->Present();
+         }
+         else
+         {
+            mWindow->mSkippedFrames++;
+         }
+
+         if (inputActive)
+         {
+            framesUntilIdle = IdleGraceFrames;
+         }
+         else if (framesUntilIdle > 0)
+         {
+            framesUntilIdle--;
+         }
+      }
+
+      // The programs were created by this thread for this context, they go before the context is released.
+      nk_glfw3_release_thread_programs();
+      glfwMakeContextCurrent(nullptr);
+   }
+
+   void WindowRenderThread::ClipboardPaste(nk_handle userdata, struct nk_text_edit* edit)
+   {
+      WindowRenderThread* thread = static_cast<WindowRenderThread*>(userdata.ptr);
+      if (!thread->mPasteText.empty())
+      {
+         nk_textedit_paste(edit, thread->mPasteText.c_str(), nk_strlen(thread->mPasteText.c_str()));
+      }
+   }
+
+   void WindowRenderThread::ClipboardCopy(nk_handle userdata, const char* text, int length)
+   {
+      WindowRenderThread* thread = static_cast<WindowRenderThread*>(userdata.ptr);
+      {
+         std::lock_guard<std::mutex> lock(thread->mMutex);
+         thread->mCopiedText.assign(text, static_cast<size_t>(length));
+         thread->mCopyPending = true;
+      }
+
+      // Have the main thread put it on the clipboard now rather than on its next event.
+      glfwPostEmptyEvent();
+   }
+
    bool WindowInput::IsKeyDown(nk_keys key) const
    {
       return mWindow->mNkContext.GetContext()->input.keyboard.keys[key].down;
@@ -757,11 +1304,33 @@ namespace wgui
    }
 
    WindowBase::WindowBase()
-      : mWindow(nullptr), mWindowTitle(), mNkContext(), mFont(nullptr)
+      : mWindow(nullptr), mWindowTitle(), mNkContext(), mFont(nullptr), mFontHandle()
+   {
+   }
+
+   WindowBase::~WindowBase()
    {
+      StopRenderThread();
    }
 
-   WindowBase::~WindowBase() { }
+   void WindowBase::StartRenderThread()
+   {
+      if (!mRenderThread)
+      {
+         mRenderThread = std::make_unique<WindowRenderThread>(this);
+         mRenderThread->SetRefreshPeriod(GetWindowRefreshPeriod(mWindow));
+         mRenderThread->Start();
+      }
+   }
+
+   void WindowBase::StopRenderThread()
+   {
+      if (mRenderThread)
+      {
+         mRenderThread->Stop();
+         mRenderThread.reset();
+      }
+   }
 
    void WindowBase::SetWindowSize(int width, int height)
    {
@@ -816,6 +1385,28 @@ namespace wgui
 
    void WindowBase::CloseWindow()
    {
+      StopRenderThread();
+
+      // Release gl objects while this window's context still exists. Object names are shared
+      // with the other windows, deleting them later from another context would hit the wrong ones.
+      glfwMakeContextCurrent(mWindow);
+      nk_glfw3_device_destroy(mNkContext.GetGlfw());
+
+      // Other windows of the share group may still draw with the baked fonts and image pages,
+      // the last one releases them.
+      if (mFontAtlases && mFontAtlases.use_count() == 1)
+      {
+         mFontAtlases->Release();
+      }
+
+      if (mImageAtlas && mImageAtlas.use_count() == 1)
+      {
+         mImageAtlas->Release();
+      }
+
+      mFontAtlases.reset();
+      mImageAtlas.reset();
+
       glfwSetWindowShouldClose(mWindow, GLFW_TRUE);
       glfwDestroyWindow(mWindow);
       mClosing = true;
@@ -826,5 +1417,183 @@ namespace wgui
       glfwSetWindowShouldClose(mWindow, GLFW_FALSE);
       mClosing = false;
    }
-}
 
+   static_assert(sizeof(RasterVertex) == sizeof(nk_glfw_vertex) &&
+      offsetof(RasterVertex, Uv) == offsetof(nk_glfw_vertex, uv) &&
+      offsetof(RasterVertex, Color) == offsetof(nk_glfw_vertex, col),
+      "The software rasterizer reads nk_convert output directly");
+
+   HeadlessWindow::HeadlessWindow()
+      : WindowBase()
+   {
+      nk_buffer_init_default(&mVertices);
+      nk_buffer_init_default(&mElements);
+   }
+
+   HeadlessWindow::~HeadlessWindow()
+   {
+      nk_buffer_free(&mVertices);
+      nk_buffer_free(&mElements);
+   }
+
+   bool HeadlessWindow::CreateWindow(const std::string& title,
+      int width, int height,
+      bool resizable,
+      bool visible, bool decorated, bool fullScreen)
+   {
+      mWindowTitle = title;
+
+      if (!mNkContext.InitHeadlessNkContext())
+      {
+         Application::Logger.critical("Failed to initialize nk");
+         return false;
+      }
+
+      nk_context* ctx = mNkContext.GetContext();
+      nk_glfw* nkGlfw = mNkContext.GetGlfw();
+
+      // Same font and theme as the main window, baked into a texture the rasterizer owns.
+      struct nk_font_atlas* fontAtlas;
+
+      nk_glfw3_font_stash_begin(nkGlfw, &fontAtlas);
+      mFont = FontAtlasCache::AddDefaultFont(fontAtlas, 16);
+      nk_glfw3_font_atlas_bake_cached(fontAtlas, NK_FONT_ATLAS_RGBA32, DiskCache::GetPath(FontAtlasCacheFile).c_str(),
+         [](void* userdata, const void* image, int width, int height)
+         {
+            HeadlessWindow* window = static_cast<HeadlessWindow*>(userdata);
+            window->mFontTexture = window->mRasterizer.AddTexture(image, width, height);
+         }, this);
+      nk_font_atlas_end(fontAtlas, nk_handle_id(mFontTexture), &nkGlfw->ogl.tex_null);
+      mFontHandle = mFont->handle;
+      nk_style_set_font(ctx, &mFontHandle);
+
+      SetDefaultStyle(ctx);
+      mWindowStyle = std::make_unique<WindowStyle>(&ctx->style);
+
+      SetWindowSize(width, height);
+      SetContentScale();
+      return true;
+   }
+
+   void HeadlessWindow::SetWindowSize(int width, int height)
+   {
+      mWidth = width;
+      mHeight = height;
+      mRasterizer.Resize(width, height);
+   }
+
+   void HeadlessWindow::GetWindowSize(int& width, int& height) const
+   {
+      width = mWidth;
+      height = mHeight;
+   }
+
+   void HeadlessWindow::SetContentScale()
+   {
+      ApplyContentScale(mScaleX, mScaleY);
+   }
+
+   void HeadlessWindow::SetContentScale(float scaleX, float scaleY)
+   {
+      mScaleX = scaleX;
+      mScaleY = scaleY;
+      ApplyContentScale(mScaleX, mScaleY);
+   }
+
+   void HeadlessWindow::SetMouseState(int x, int y, bool leftDown)
+   {
+      mMouseX = x;
+      mMouseY = y;
+      mMouseDown = leftDown;
+   }
+
+   void HeadlessWindow::Render()
+   {
+      assert("Headless windows need a renderer" && mLastRenderer);
+      nk_glfw* nkGlfw = mNkContext.GetGlfw();
+      nk_context* ctx = &nkGlfw->ctx;
+
+      nkGlfw->width = nkGlfw->display_width = mWidth;
+      nkGlfw->height = nkGlfw->display_height = mHeight;
+      nkGlfw->fb_scale = nk_vec2(1, 1);
+
+      FrameProfiler* profiler = GetFrameProfiler();
+      ControlProfiler* controlProfiler = GetControlProfiler();
+      FrameProfiler::Clock::time_point start = FrameProfiler::Now();
+
+      nk_input_begin(ctx);
+      nk_input_motion(ctx, mMouseX, mMouseY);
+      nk_input_button(ctx, NK_BUTTON_LEFT, mMouseX, mMouseY, mMouseDown);
+      nk_input_end(ctx);
+      mInputActive = nk_glfw3_input_active(nkGlfw);
+
+      FrameProfiler::Clock::time_point layoutStart = FrameProfiler::Now();
+      if (controlProfiler) controlProfiler->BeginFrame();
+      mLastRenderer->RenderStart(this, ctx);
+      mLastRenderer->Render(this, ctx);
+
+      if (profiler)
+      {
+         profiler->GetCurrentSample()[eFramePhase::Input] = FrameProfiler::ElapsedMs(start, layoutStart);
+         profiler->GetCurrentSample()[eFramePhase::Layout] = FrameProfiler::ElapsedMs(layoutStart, FrameProfiler::Now());
+      }
+
+      struct nk_convert_config config;
+      nk_glfw3_fill_convert_config(nkGlfw, NK_ANTI_ALIASING_ON, &config);
+      if (controlProfiler)
+      {
+         controlProfiler->EndFrame(ctx, config, nk_glfw3_tessellation_tolerance(nkGlfw));
+      }
+
+      mFramePresented = !mSkipUnchangedFrames || nk_glfw3_frame_changed(nkGlfw);
+      if (!mFramePresented)
+      {
+         mSkippedFrames++;
+         nk_clear(ctx);
+         mLastRenderer->RenderFinish(this, ctx);
+         return;
+      }
+
+      // Convert exactly like the gl backend, then rasterize each draw command.
+      FrameProfiler::Clock::time_point convertStart = FrameProfiler::Now();
+      nk_buffer_clear(&mVertices);
+      nk_buffer_clear(&mElements);
+      nk_glfw3_convert(ctx, &nkGlfw->ogl.cmds, &mVertices, &mElements, &config, nk_glfw3_tessellation_tolerance(nkGlfw));
+      FrameProfiler::Clock::time_point drawStart = FrameProfiler::Now();
+
+      const RasterVertex* vertices = reinterpret_cast<const RasterVertex*>(nk_buffer_memory_const(&mVertices));
+      const nk_draw_index* elements = reinterpret_cast<const nk_draw_index*>(nk_buffer_memory_const(&mElements));
+      const nk_draw_command* cmd;
+      nk_size offset = 0;
+
+      nkGlfw->stats.vertex_count = ctx->draw_list.vertex_count;
+      nkGlfw->stats.element_count = ctx->draw_list.element_count;
+      nkGlfw->stats.command_count = 0;
+
+      mRasterizer.Clear();
+      nk_draw_foreach(cmd, ctx, &nkGlfw->ogl.cmds)
+      {
+         if (!cmd->elem_count) continue;
+
+         mRasterizer.SetScissor((int)cmd->clip_rect.x, (int)cmd->clip_rect.y,
+            (int)cmd->clip_rect.w, (int)cmd->clip_rect.h);
+         mRasterizer.DrawIndexed(vertices, elements + offset, cmd->elem_count, cmd->texture.id);
+         offset += cmd->elem_count;
+         nkGlfw->stats.command_count++;
+      }
+      nkGlfw->stats.draw_count = nkGlfw->stats.command_count;
+
+      nk_clear(ctx);
+      nk_buffer_clear(&nkGlfw->ogl.cmds);
+      mLastRenderer->RenderFinish(this, ctx);
+
+      // Nothing is uploaded, swapped or timed on a gpu, rasterizing counts as the draw.
+      if (profiler)
+      {
+         profiler->GetCurrentSample()[eFramePhase::Convert] = FrameProfiler::ElapsedMs(convertStart, drawStart);
+         profiler->GetCurrentSample()[eFramePhase::Draw] = FrameProfiler::ElapsedMs(drawStart, FrameProfiler::Now());
+         profiler->GetCurrentSample()[eFramePhase::Gpu] = FrameProfiler::NotMeasured;
+         profiler->Commit();
+      }
+   }
+}
@@ -0,0 +1,250 @@
+#include "ImageAtlas.h"
+#include "Registry.h"
+
+#define STB_IMAGE_IMPLEMENTATION
+#define STBI_ONLY_PNG
+#define STBI_ONLY_JPEG
+#define STBI_ONLY_BMP
+#define STBI_ONLY_TGA
+#include "stb_image.h"
+
+namespace wgui
+{
+   ShelfPacker::ShelfPacker(int width, int height, int padding)
+      : mWidth(width), mHeight(height), mPadding(padding)
+   {
+   }
+
+   bool ShelfPacker::Pack(int width, int height, int& x, int& y)
+   {
+      int paddedWidth = width + mPadding * 2;
+      int paddedHeight = height + mPadding * 2;
+      Shelf* best = nullptr;
+
+      for (Shelf& shelf : mShelves)
+      {
+         if (shelf.Height >= paddedHeight && shelf.Used + paddedWidth <= mWidth &&
+            (!best || shelf.Height < best->Height))
+         {
+            best = &shelf;
+         }
+      }
+
+      if (!best)
+      {
+         if (paddedWidth > mWidth || mNextShelfY + paddedHeight > mHeight)
+         {
+            return false;
+         }
+
+         mShelves.push_back(Shelf{ mNextShelfY, paddedHeight, 0 });
+         mNextShelfY += paddedHeight;
+         best = &mShelves.back();
+      }
+
+      x = best->Used + mPadding;
+      y = best->Y + mPadding;
+      best->Used += paddedWidth;
+      return true;
+   }
+
+   ImageAtlas::ImageAtlas(Decoder decoder)
+      : mDecoder(std::move(decoder)),
+      mImages(std::make_unique<ResourceManager<AtlasImage>>("Image"))
+   {
+      StartWorker();
+   }
+
+   ImageAtlas::~ImageAtlas()
+   {
+      // Textures go with the share group, only the decode thread is left if Release wasn't called.
+      StopWorker();
+   }
+
+   bool ImageAtlas::DecodeFile(const std::string& path, DecodedImage& image)
+   {
+      int channels;
+      stbi_uc* pixels = stbi_load(path.c_str(), &image.Width, &image.Height, &channels, 4);
+      if (pixels == nullptr)
+      {
+         return false;
+      }
+
+      image.Pixels.assign(pixels, pixels + static_cast<size_t>(image.Width) * image.Height * 4);
+      stbi_image_free(pixels);
+      return true;
+   }
+
+   AtlasImage* ImageAtlas::Request(const std::string& path)
+   {
+      std::lock_guard<std::mutex> lock(mMutex);
+      if (mImages->HasRegistry(path))
+      {
+         return mImages->GetRegistry(path);
+      }
+
+      auto image = std::make_unique<AtlasImage>(path);
+      AtlasImage* result = image.get();
+      mImages->AddRegistry(path, std::move(image));
+
+      mDecodeQueue.push_back(result);
+      mWake.notify_one();
+      return result;
+   }
+
+   void ImageAtlas::SetDecodedCallback(std::function<void()> callback)
+   {
+      std::lock_guard<std::mutex> lock(mMutex);
+      mDecodedCallback = std::move(callback);
+   }
+
+   void ImageAtlas::StartWorker()
+   {
+      mStopping = false;
+      mWorker = std::thread(&ImageAtlas::DecodeLoop, this);
+   }
+
+   void ImageAtlas::StopWorker()
+   {
+      {
+         std::lock_guard<std::mutex> lock(mMutex);
+         mStopping = true;
+      }
+
+      mWake.notify_one();
+      if (mWorker.joinable())
+      {
+         mWorker.join();
+      }
+   }
+
+   void ImageAtlas::DecodeLoop()
+   {
+      std::unique_lock<std::mutex> lock(mMutex);
+      while (true)
+      {
+         mWake.wait(lock, [this] { return mStopping || !mDecodeQueue.empty(); });
+         if (mStopping)
+         {
+            return;
+         }
+
+         AtlasImage* image = mDecodeQueue.front();
+         mDecodeQueue.pop_front();
+
+         // Decoding takes milliseconds per file, requests keep coming in meanwhile.
+         lock.unlock();
+         DecodedImage decoded;
+         bool success = mDecoder(image->mPath, decoded) && decoded.Width > 0 && decoded.Height > 0 &&
+            decoded.Pixels.size() == static_cast<size_t>(decoded.Width) * decoded.Height * 4;
+         lock.lock();
+
+         if (success)
+         {
+            image->mDecoded = std::move(decoded);
+            mDecoded.push_back(image);
+            image->mState.store(eImageState::Decoded, std::memory_order_release);
+         }
+         else
+         {
+            image->mState.store(eImageState::Failed, std::memory_order_release);
+         }
+
+         std::function<void()> callback = mDecodedCallback;
+         if (callback)
+         {
+            lock.unlock();
+            callback();
+            lock.lock();
+         }
+      }
+   }
+
+   ImageAtlas::Page* ImageAtlas::Place(int width, int height, int& x, int& y)
+   {
+      for (auto& page : mPages)
+      {
+         if (page->Packer.Pack(width, height, x, y))
+         {
+            return page.get();
+         }
+      }
+
+      auto page = std::make_unique<Page>(Page{ 0, ShelfPacker(PageSize, PageSize) });
+      if (!page->Packer.Pack(width, height, x, y))
+      {
+         return nullptr;
+      }
+
+      // Cleared so the padding around every image samples as transparent.
+      std::vector<uint8_t> clear(static_cast<size_t>(PageSize) * PageSize * 4, 0);
+      page->Texture = nk_glfw3_create_atlas_texture(clear.data(), PageSize, PageSize, NK_FONT_ATLAS_RGBA32);
+
+      mPages.push_back(std::move(page));
+      return mPages.back().get();
+   }
+
+   int ImageAtlas::Upload()
+   {
+      std::lock_guard<std::mutex> uploadLock(mUploadMutex);
+      std::vector<AtlasImage*> decoded;
+      {
+         std::lock_guard<std::mutex> lock(mMutex);
+         decoded.swap(mDecoded);
+      }
+
+      int uploaded = 0;
+      for (AtlasImage* image : decoded)
+      {
+         DecodedImage& pixels = image->mDecoded;
+         int x, y;
+         Page* page = Place(pixels.Width, pixels.Height, x, y);
+         if (page == nullptr)
+         {
+            image->mDecoded = DecodedImage();
+            image->mState.store(eImageState::Failed, std::memory_order_release);
+            continue;
+         }
+
+         glBindTexture(GL_TEXTURE_2D, page->Texture);
+         glTexSubImage2D(GL_TEXTURE_2D, 0, x, y, pixels.Width, pixels.Height, GL_RGBA, GL_UNSIGNED_BYTE,
+            pixels.Pixels.data());
+
+         image->mWidth = pixels.Width;
+         image->mHeight = pixels.Height;
+         image->mImage = nk_subimage_id(static_cast<int>(page->Texture), PageSize, PageSize,
+            nk_rect(static_cast<float>(x), static_cast<float>(y),
+               static_cast<float>(pixels.Width), static_cast<float>(pixels.Height)));
+         image->mDecoded = DecodedImage();
+         image->mState.store(eImageState::Resident, std::memory_order_release);
+         uploaded++;
+      }
+
+      if (uploaded > 0)
+      {
+         // Dialogs draw from other contexts of the share group, they only see finished commands.
+         glFlush();
+      }
+
+      return uploaded;
+   }
+
+   void ImageAtlas::Release()
+   {
+      StopWorker();
+
+      std::lock_guard<std::mutex> uploadLock(mUploadMutex);
+      for (auto& page : mPages)
+      {
+         glDeleteTextures(1, &page->Texture);
+      }
+
+      mPages.clear();
+   }
+
+   size_t ImageAtlas::GetPageCount() const
+   {
+      std::lock_guard<std::mutex> uploadLock(mUploadMutex);
+      return mPages.size();
+   }
+}
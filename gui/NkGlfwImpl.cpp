@@ -1,12 +1,17 @@
+#include <cmath>
 #include <cstdlib>
 #include <cassert>
 #include <iostream>
+#include <mutex>
 
 #include "GL/glew.h"
+// The backend needs nuklear's internal font helpers to restore cached atlases.
+#define NK_IMPLEMENTATION
 #include "include_nuk.h"
 #include "nuklear_glfw_gl3.h"
 
 #include "Shaders/GuiShader.h"
+#include "DiskCache.h"
 
 #ifndef NK_GLFW_DOUBLE_CLICK_LO
 #define NK_GLFW_DOUBLE_CLICK_LO 0.02
@@ -15,83 +20,1468 @@
 #define NK_GLFW_DOUBLE_CLICK_HI 0.2
 #endif
 
+/* bump when the cached atlas layout or nuklear's baker changes */
+#ifndef NK_GLFW_ATLAS_CACHE_VERSION
+#define NK_GLFW_ATLAS_CACHE_VERSION 1
+#endif
+
+/* distance field bake: texels of falloff around each glyph and the width of the packed image */
+#ifndef NK_GLFW_SDF_PADDING
+#define NK_GLFW_SDF_PADDING 4
+#endif
+#ifndef NK_GLFW_SDF_ATLAS_WIDTH
+#define NK_GLFW_SDF_ATLAS_WIDTH 512
+#endif
+
+#ifndef NK_GLFW_MAX_STREAM_BUFFER
+#define NK_GLFW_MAX_STREAM_BUFFER (256 * 1024 * 1024)
+#endif
+
 namespace 
 {
-   wgui::DefaultGuiShader ShaderProg;
+   // Uniforms are program state and programs are shared between contexts, so every thread that
+   // draws windows has its own. Otherwise two render threads would overwrite each other's projection.
+   thread_local wgui::DefaultGuiShader ShaderProg;
+   // Used for draws sampling a distance field atlas, loaded the first time one is used.
+   thread_local wgui::SdfGuiShader SdfShaderProg;
+   // Programs of the instanced quad path, loaded the first time a window draws with it.
+   thread_local wgui::InstancedGuiShader QuadShaderProg;
+   thread_local wgui::InstancedSdfGuiShader QuadSdfShaderProg;
+
+   // Guards the reference counts of shared font textures, windows switch atlases on their render threads.
+   std::mutex FontTextureMutex;
+
+   // Guards the render target lists of the devices, controls release their targets from any thread.
+   std::mutex RenderTargetMutex;
+
+   // Index width is picked at compile time by NK_UINT_DRAW_INDEX.
+   const GLenum DrawIndexType = sizeof(nk_draw_index) == 4 ? GL_UNSIGNED_INT : GL_UNSIGNED_SHORT;
+
+   static_assert(sizeof(nk_glfw_packed_vertex) == 12, "Packed vertices must stay tightly packed");
+   static_assert(sizeof(nk_glfw_quad_instance) == 28, "Quad instances must stay tightly packed");
 }
 
-struct nk_glfw_vertex
+NK_INTERN GLsizeiptr
+nk_glfw3_vertex_stride(const struct nk_glfw_device* dev)
 {
-   float position[2];
-   float uv[2];
-   nk_byte col[4];
-};
+   return dev->vertex_format == NK_GLFW_VERTEX_PACKED ?
+      (GLsizeiptr)sizeof(struct nk_glfw_packed_vertex) : (GLsizeiptr)sizeof(struct nk_glfw_vertex);
+}
+
+NK_INTERN void
+nk_glfw3_device_setup_attribs(struct nk_glfw_device* dev)
+{
+   glBindVertexArray(dev->vao);
+   glBindBuffer(GL_ARRAY_BUFFER, dev->vbo);
+   glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, dev->ebo);
+
+   glEnableVertexAttribArray((GLuint)dev->attrib_pos);
+   glEnableVertexAttribArray((GLuint)dev->attrib_uv);
+   glEnableVertexAttribArray((GLuint)dev->attrib_col);
+
+   if (dev->vertex_format == NK_GLFW_VERTEX_PACKED)
+   {
+      /* positions stay fixed point, the projection divides out the subpixel steps */
+      GLsizei vs = sizeof(struct nk_glfw_packed_vertex);
+      glVertexAttribPointer((GLuint)dev->attrib_pos, 2, GL_SHORT, GL_FALSE, vs,
+         (void*)offsetof(struct nk_glfw_packed_vertex, position));
+      glVertexAttribPointer((GLuint)dev->attrib_uv, 2, GL_UNSIGNED_SHORT, GL_TRUE, vs,
+         (void*)offsetof(struct nk_glfw_packed_vertex, uv));
+      glVertexAttribPointer((GLuint)dev->attrib_col, 4, GL_UNSIGNED_BYTE, GL_TRUE, vs,
+         (void*)offsetof(struct nk_glfw_packed_vertex, col));
+   }
+   else
+   {
+      GLsizei vs = sizeof(struct nk_glfw_vertex);
+      glVertexAttribPointer((GLuint)dev->attrib_pos, 2, GL_FLOAT, GL_FALSE, vs,
+         (void*)offsetof(struct nk_glfw_vertex, position));
+      glVertexAttribPointer((GLuint)dev->attrib_uv, 2, GL_FLOAT, GL_FALSE, vs,
+         (void*)offsetof(struct nk_glfw_vertex, uv));
+      glVertexAttribPointer((GLuint)dev->attrib_col, 4, GL_UNSIGNED_BYTE, GL_TRUE, vs,
+         (void*)offsetof(struct nk_glfw_vertex, col));
+   }
+}
+
+/// <summary>
+/// Makes the device the first owner of a texture it baked.
+/// </summary>
+NK_INTERN void
+nk_glfw3_font_texture_own(struct nk_glfw_device* dev, GLuint tex)
+{
+   struct nk_glfw_font_texture* owner = (struct nk_glfw_font_texture*)malloc(sizeof(struct nk_glfw_font_texture));
+   owner->tex = tex;
+   owner->refs = 1;
+   dev->font_tex = tex;
+   dev->font_owner = owner;
+}
+
+/// <summary>
+/// Drops the device's reference on its font texture. The texture is deleted with the last
+/// reference, which needs a context of the share group it was created in to be current.
+/// </summary>
+NK_INTERN void
+nk_glfw3_font_texture_release(struct nk_glfw_device* dev)
+{
+   struct nk_glfw_font_texture* owner = dev->font_owner;
+   if (!owner) return;
+   dev->font_owner = NULL;
+
+   int refs;
+   {
+      std::lock_guard<std::mutex> lock(FontTextureMutex);
+      refs = --owner->refs;
+   }
+
+   if (refs == 0)
+   {
+      glDeleteTextures(1, &owner->tex);
+      free(owner);
+   }
+}
+
+/// <summary>
+/// Takes the target out of its device's list, the caller holds RenderTargetMutex.
+/// </summary>
+NK_INTERN void
+nk_glfw3_render_target_unlink(struct nk_glfw_render_target* target)
+{
+   struct nk_glfw_render_target** link;
+   if (!target->owner) return;
+
+   for (link = &target->owner->targets; *link; link = &(*link)->next) {
+      if (*link == target) {
+         *link = target->next;
+         break;
+      }
+   }
+   target->owner = NULL;
+   target->next = NULL;
+}
+
+NK_INTERN void
+nk_glfw3_render_target_delete(const struct nk_glfw_render_target* target)
+{
+   if (target->framebuffer)
+      glDeleteFramebuffers(1, &target->framebuffer);
+   if (target->texture)
+      glDeleteTextures(1, &target->texture);
+}
+
+/// <summary>
+/// Deletes the objects of the targets released since the last call, needs the device's context current.
+/// </summary>
+NK_INTERN void
+nk_glfw3_free_released_targets(struct nk_glfw_device* dev)
+{
+   struct nk_glfw_render_target* released;
+   {
+      std::lock_guard<std::mutex> lock(RenderTargetMutex);
+      released = dev->released_targets;
+      dev->released_targets = NULL;
+   }
+
+   while (released) {
+      struct nk_glfw_render_target* next = released->next;
+      nk_glfw3_render_target_delete(released);
+      free(released);
+      released = next;
+   }
+}
+
+NK_API void
+nk_glfw3_render_target_free(struct nk_glfw_render_target* target)
+{
+   {
+      std::lock_guard<std::mutex> lock(RenderTargetMutex);
+      nk_glfw3_render_target_unlink(target);
+   }
+   nk_glfw3_render_target_delete(target);
+   memset(target, 0, sizeof(*target));
+}
+
+NK_API void
+nk_glfw3_render_target_release(struct nk_glfw_render_target* target)
+{
+   std::lock_guard<std::mutex> lock(RenderTargetMutex);
+   struct nk_glfw_device* owner = target->owner;
+   nk_glfw3_render_target_unlink(target);
+
+   /* without an owner the objects went with their window already */
+   if (owner && (target->framebuffer || target->texture)) {
+      struct nk_glfw_render_target* copy = (struct nk_glfw_render_target*)malloc(sizeof(struct nk_glfw_render_target));
+      *copy = *target;
+      copy->next = owner->released_targets;
+      owner->released_targets = copy;
+   }
+   memset(target, 0, sizeof(*target));
+}
 
 NK_API void
 nk_glfw3_device_create(struct nk_glfw* glfw)
 {
-   ShaderProg.LoadShader();
+   nk_glfw3_device_create_shared(glfw, NULL);
+}
+
+/// <summary>
+/// Creates the device for a window. When share is given, the current context must share
+/// objects with share's context: the program and font texture are reused and only the
+/// per context vao and the streaming buffers are created.
+/// </summary>
+NK_API void
+nk_glfw3_device_create_shared(struct nk_glfw* glfw, const struct nk_glfw* share)
+{
+   if (!share)
+      ShaderProg.LoadShader();
 
    struct nk_glfw_device* dev = &glfw->ogl;
    nk_buffer_init_default(&dev->cmds);
+   nk_buffer_init_default(&dev->staging);
+   dev->vertex_format = NK_GLFW_VERTEX_PACKED;
 
    dev->attrib_pos = ShaderProg.GetAttribLocation("Position");
    dev->attrib_uv = ShaderProg.GetAttribLocation("TexCoord");
    dev->attrib_col = ShaderProg.GetAttribLocation("Color");
 
+   /* buffer setup, storage for the streaming ring is allocated on the first render */
+   glGenBuffers(1, &dev->vbo);
+   glGenBuffers(1, &dev->ebo);
+   glGenVertexArrays(1, &dev->vao);
+   nk_glfw3_device_setup_attribs(dev);
+
+   dev->vertex_stream.target = GL_ARRAY_BUFFER;
+   dev->element_stream.target = GL_ELEMENT_ARRAY_BUFFER;
+   dev->stream_mode = GLEW_ARB_buffer_storage ? NK_GLFW3_STREAM_PERSISTENT : NK_GLFW3_STREAM_MAP_RANGE;
+
+   if (share)
    {
-      /* buffer setup */
-      GLsizei vs = sizeof(struct nk_glfw_vertex);
-      size_t vp = offsetof(struct nk_glfw_vertex, position);
-      size_t vt = offsetof(struct nk_glfw_vertex, uv);
-      size_t vc = offsetof(struct nk_glfw_vertex, col);
+      dev->font_tex = share->ogl.font_tex;
+      dev->tex_null = share->ogl.tex_null;
+      dev->font_owner = share->ogl.font_owner;
+      if (dev->font_owner)
+      {
+         /* the texture stays alive for as long as this window draws with it */
+         std::lock_guard<std::mutex> lock(FontTextureMutex);
+         dev->font_owner->refs++;
+      }
+      dev->atlas_format = share->ogl.atlas_format;
+      dev->font_sdf = share->ogl.font_sdf;
+   }
 
-      glGenBuffers(1, &dev->vbo);
-      glGenBuffers(1, &dev->ebo);
-      glGenVertexArrays(1, &dev->vao);
+   ShaderBase::Bind(ShaderProg.GetShaderProgram());
+   ShaderProg.LoadTexture(0);
 
-      glBindVertexArray(dev->vao);
+   glBindTexture(GL_TEXTURE_2D, 0);
+   glBindBuffer(GL_ARRAY_BUFFER, 0);
+   glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+   glBindVertexArray(0);
+}
+
+/// <summary>
+/// Blocks until the GPU is done reading the ring segment guarded by the given fence.
+/// </summary>
+NK_INTERN void
+nk_glfw3_stream_wait(GLsync* fence)
+{
+   if (!*fence) return;
+
+   for (;;)
+   {
+      GLenum result = glClientWaitSync(*fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);
+      if (result != GL_TIMEOUT_EXPIRED) break;
+   }
+
+   glDeleteSync(*fence);
+   *fence = 0;
+}
+
+/// <summary>
+/// Waits on all in flight frames and drops the ring storage. Buffers with immutable
+/// storage cannot be resized, so new buffer names are generated and bound to the vao.
+/// </summary>
+NK_INTERN void
+nk_glfw3_stream_release(struct nk_glfw_device* dev)
+{
+   int i;
+   for (i = 0; i < NK_GLFW_STREAM_FRAMES; ++i)
+      nk_glfw3_stream_wait(&dev->stream_fences[i]);
+
+   glBindVertexArray(dev->vao);
+   if (dev->vertex_stream.mapped)
+   {
       glBindBuffer(GL_ARRAY_BUFFER, dev->vbo);
+      glUnmapBuffer(GL_ARRAY_BUFFER);
+   }
+   if (dev->element_stream.mapped)
+   {
       glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, dev->ebo);
+      glUnmapBuffer(GL_ELEMENT_ARRAY_BUFFER);
+   }
+   glBindVertexArray(0);
 
-      glEnableVertexAttribArray((GLuint)dev->attrib_pos);
-      glEnableVertexAttribArray((GLuint)dev->attrib_uv);
-      glEnableVertexAttribArray((GLuint)dev->attrib_col);
+   glDeleteBuffers(1, &dev->vbo);
+   glDeleteBuffers(1, &dev->ebo);
+   dev->vertex_stream.mapped = 0;
+   dev->vertex_stream.segment_size = 0;
+   dev->element_stream.mapped = 0;
+   dev->element_stream.segment_size = 0;
+   dev->stream_frame = 0;
+}
 
-      glVertexAttribPointer((GLuint)dev->attrib_pos, 2, GL_FLOAT, GL_FALSE, vs, (void*)vp);
-      glVertexAttribPointer((GLuint)dev->attrib_uv, 2, GL_FLOAT, GL_FALSE, vs, (void*)vt);
-      glVertexAttribPointer((GLuint)dev->attrib_col, 4, GL_UNSIGNED_BYTE, GL_TRUE, vs, (void*)vc);
+NK_INTERN void
+nk_glfw3_stream_allocate(struct nk_glfw_stream_buffer* stream, enum nk_glfw_stream_mode mode, GLsizeiptr segment_size)
+{
+   GLsizeiptr total = segment_size * NK_GLFW_STREAM_FRAMES;
+   stream->segment_size = segment_size;
+
+   if (mode == NK_GLFW3_STREAM_PERSISTENT)
+   {
+      const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+      glBufferStorage(stream->target, total, NULL, flags);
+      stream->mapped = glMapBufferRange(stream->target, 0, total, flags);
+   }
+   else
+   {
+      glBufferData(stream->target, total, NULL, GL_STREAM_DRAW);
    }
+}
 
-   ShaderBase::Bind(ShaderProg.GetShaderProgram());
-   ShaderProg.LoadTexture(0);
+/// <summary>
+/// Makes sure the ring has a segment of at least the requested size for each frame.
+/// </summary>
+NK_INTERN void
+nk_glfw3_stream_reserve(struct nk_glfw_device* dev, GLsizeiptr vertex_size, GLsizeiptr element_size)
+{
+   /* Segments have to start on a whole vertex so the draw can use a base vertex instead of rebinding attributes. */
+   const GLsizeiptr vs = nk_glfw3_vertex_stride(dev);
+   const GLsizeiptr es = sizeof(nk_draw_index);
+   vertex_size = ((vertex_size + vs - 1) / vs) * vs;
+   element_size = ((element_size + es - 1) / es) * es;
+
+   if (dev->vertex_stream.segment_size == vertex_size &&
+      dev->element_stream.segment_size == element_size)
+      return;
+
+   if (dev->vertex_stream.segment_size || dev->element_stream.segment_size)
+   {
+      nk_glfw3_stream_release(dev);
+      glGenBuffers(1, &dev->vbo);
+      glGenBuffers(1, &dev->ebo);
+      nk_glfw3_device_setup_attribs(dev);
+   }
+
+   glBindVertexArray(dev->vao);
+   glBindBuffer(GL_ARRAY_BUFFER, dev->vbo);
+   glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, dev->ebo);
+   nk_glfw3_stream_allocate(&dev->vertex_stream, dev->stream_mode, vertex_size);
+   nk_glfw3_stream_allocate(&dev->element_stream, dev->stream_mode, element_size);
+}
+
+/// <summary>
+/// Returns writable memory for the given frame segment. The caller must have waited on its fence.
+/// </summary>
+NK_INTERN void*
+nk_glfw3_stream_map(struct nk_glfw_stream_buffer* stream, int frame)
+{
+   GLintptr offset = stream->segment_size * frame;
+   if (stream->mapped)
+      return (nk_byte*)stream->mapped + offset;
+
+   return glMapBufferRange(stream->target, offset, stream->segment_size,
+      GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT | GL_MAP_INVALIDATE_RANGE_BIT);
+}
+
+NK_INTERN void
+nk_glfw3_stream_unmap(struct nk_glfw_stream_buffer* stream)
+{
+   if (!stream->mapped)
+      glUnmapBuffer(stream->target);
+}
+
+NK_API void
+nk_glfw3_set_stream_mode(struct nk_glfw* glfw, enum nk_glfw_stream_mode mode)
+{
+   struct nk_glfw_device* dev = &glfw->ogl;
+   if (mode == NK_GLFW3_STREAM_PERSISTENT && !GLEW_ARB_buffer_storage)
+      mode = NK_GLFW3_STREAM_MAP_RANGE;
+   if (dev->stream_mode == mode) return;
+
+   nk_glfw3_stream_release(dev);
+   glGenBuffers(1, &dev->vbo);
+   glGenBuffers(1, &dev->ebo);
+   nk_glfw3_device_setup_attribs(dev);
+   glBindBuffer(GL_ARRAY_BUFFER, 0);
+   glBindVertexArray(0);
+   dev->stream_mode = mode;
+}
+
+NK_API void
+nk_glfw3_set_vertex_format(struct nk_glfw* glfw, enum nk_glfw_vertex_format fmt)
+{
+   struct nk_glfw_device* dev = &glfw->ogl;
+   if (dev->vertex_format == fmt) return;
+
+   /* the ring segments are sized in whole vertices of the old layout */
+   nk_glfw3_stream_release(dev);
+   glGenBuffers(1, &dev->vbo);
+   glGenBuffers(1, &dev->ebo);
+   dev->vertex_format = fmt;
+   nk_glfw3_device_setup_attribs(dev);
+   glBindBuffer(GL_ARRAY_BUFFER, 0);
+   glBindVertexArray(0);
+}
+
+/// <summary>
+/// Packs converted vertices into the 12 byte layout. Positions round to the nearest subpixel step
+/// and clamp to what 16 bits hold, anything that far out is outside every window's scissor anyway.
+/// dst may be write combined mapped memory, every vertex is written whole and in order.
+/// </summary>
+NK_API void
+nk_glfw3_pack_vertices(struct nk_glfw_packed_vertex* dst, const struct nk_glfw_vertex* src, nk_size count)
+{
+   const float scale = (float)NK_GLFW_POSITION_SUBPIXELS;
+   nk_size i;
+   for (i = 0; i < count; ++i)
+   {
+      struct nk_glfw_packed_vertex packed;
+      float x = NK_CLAMP(-32768.0f, src[i].position[0] * scale, 32767.0f);
+      float y = NK_CLAMP(-32768.0f, src[i].position[1] * scale, 32767.0f);
+      float u = NK_CLAMP(0.0f, src[i].uv[0], 1.0f);
+      float v = NK_CLAMP(0.0f, src[i].uv[1], 1.0f);
+
+      packed.position[0] = (nk_short)(x < 0 ? x - 0.5f : x + 0.5f);
+      packed.position[1] = (nk_short)(y < 0 ? y - 0.5f : y + 0.5f);
+      packed.uv[0] = (nk_ushort)(u * 65535.0f + 0.5f);
+      packed.uv[1] = (nk_ushort)(v * 65535.0f + 0.5f);
+      NK_MEMCPY(packed.col, src[i].col, sizeof(packed.col));
+      dst[i] = packed;
+   }
+}
+
+NK_API void
+nk_glfw3_set_atlas_format(struct nk_glfw* glfw, enum nk_font_atlas_format fmt)
+{
+   /* picked up by the next nk_glfw3_font_stash_end */
+   glfw->ogl.atlas_format = fmt;
+}
+
+NK_API GLuint
+nk_glfw3_create_atlas_texture(const void* image, int width, int height, enum nk_font_atlas_format fmt)
+{
+   GLuint tex;
+   glGenTextures(1, &tex);
+   glBindTexture(GL_TEXTURE_2D, tex);
+   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+   if (fmt == NK_FONT_ATLAS_ALPHA8) {
+      /* Coverage only. The swizzle makes the sampler return (1, 1, 1, coverage), exactly what the
+       * RGBA32 bake stores, so the same program draws glyphs, tex_null fills and rgba images. */
+      const GLint swizzle[4] = { GL_ONE, GL_ONE, GL_ONE, GL_RED };
+      glTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_RGBA, swizzle);
+      glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+      glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, (GLsizei)width, (GLsizei)height, 0,
+         GL_RED, GL_UNSIGNED_BYTE, image);
+      glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+   } else {
+      glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, (GLsizei)width, (GLsizei)height, 0,
+         GL_RGBA, GL_UNSIGNED_BYTE, image);
+   }
+   return tex;
+}
+
+NK_API void
+nk_glfw3_use_atlas(struct nk_glfw* glfw, GLuint tex, const struct nk_draw_null_texture* tex_null)
+{
+   struct nk_glfw_device* dev = &glfw->ogl;
+   if (dev->font_owner && dev->font_owner->tex != tex)
+      nk_glfw3_font_texture_release(dev);
+   dev->font_tex = tex;
+   dev->tex_null = *tex_null;
+   dev->font_sdf = nk_false;
+   nk_glfw3_invalidate_frame(glfw);
+}
+
+NK_INTERN void
+nk_glfw3_load_program(wgui::DefaultGuiShader* prog)
+{
+   prog->LoadShader();
+   ShaderBase::Bind(prog->GetShaderProgram());
+   prog->LoadTexture(0);
+   ShaderBase::Unbind();
+}
+
+NK_API void
+nk_glfw3_use_sdf_atlas(struct nk_glfw* glfw, GLuint tex, const struct nk_draw_null_texture* tex_null)
+{
+   nk_glfw3_use_atlas(glfw, tex, tex_null);
+   if (!SdfShaderProg.GetShaderProgram())
+      nk_glfw3_load_program(&SdfShaderProg);
+   glfw->ogl.font_sdf = nk_true;
+}
+
+NK_API void
+nk_glfw3_release_thread_programs(void)
+{
+   ShaderProg.Release();
+   SdfShaderProg.Release();
+   QuadShaderProg.Release();
+   QuadSdfShaderProg.Release();
+}
+
+NK_INTERN void
+nk_glfw3_device_upload_atlas(struct nk_glfw* glfw, const void* image, int width, int height)
+{
+   struct nk_glfw_device* dev = &glfw->ogl;
+   nk_glfw3_font_texture_release(dev);
+   nk_glfw3_font_texture_own(dev, nk_glfw3_create_atlas_texture(image, width, height, dev->atlas_format));
+}
+
+NK_API void
+nk_glfw3_device_destroy(struct nk_glfw* glfw)
+{
+   struct nk_glfw_device* dev = &glfw->ogl;
+   if (!dev->vao)
+   {
+      /* never created or already destroyed, only the command buffer may be left */
+      nk_buffer_free(&dev->cmds);
+      memset(&dev->cmds, 0, sizeof(dev->cmds));
+      return;
+   }
+
+   nk_glfw3_free_released_targets(dev);
+   {
+      /* the controls keep their emptied targets and capture again on whichever window draws them next */
+      std::lock_guard<std::mutex> lock(RenderTargetMutex);
+      while (dev->targets) {
+         struct nk_glfw_render_target* target = dev->targets;
+         dev->targets = target->next;
+         nk_glfw3_render_target_delete(target);
+         memset(target, 0, sizeof(*target));
+      }
+   }
+
+   nk_glfw3_font_texture_release(dev);
+   if (dev->timer_queries[0])
+      glDeleteQueries(NK_GLFW_STREAM_FRAMES, dev->timer_queries);
+   nk_glfw3_stream_release(dev);
+   glDeleteVertexArrays(1, &dev->vao);
+   if (dev->quad_vao)
+   {
+      GLuint buffers[3] = { dev->quad_vbo, dev->mesh_vbo, dev->mesh_ebo };
+      GLuint arrays[2] = { dev->quad_vao, dev->mesh_vao };
+      glDeleteBuffers(3, buffers);
+      glDeleteVertexArrays(2, arrays);
+      nk_glfw3_quad_frame_free(&dev->quads);
+   }
+   nk_buffer_free(&dev->cmds);
+   nk_buffer_free(&dev->staging);
+   memset(dev, 0, sizeof(*dev));
+}
+
+/// <summary>
+/// Points the instance attributes at the given instance of the bound quad buffer. GL 3.3 has no
+/// base instance for instanced draws, so every batch moves the pointers instead.
+/// </summary>
+NK_INTERN void
+nk_glfw3_quad_attribs(nk_uint first)
+{
+   GLsizei stride = sizeof(struct nk_glfw_quad_instance);
+   nk_size base = (nk_size)first * sizeof(struct nk_glfw_quad_instance);
+   glVertexAttribPointer(QuadShaderProg.GetAttribLocation("Rect"), 4, GL_FLOAT, GL_FALSE, stride,
+      (void*)(base + offsetof(struct nk_glfw_quad_instance, rect)));
+   glVertexAttribPointer(QuadShaderProg.GetAttribLocation("TexRect"), 4, GL_UNSIGNED_SHORT, GL_TRUE, stride,
+      (void*)(base + offsetof(struct nk_glfw_quad_instance, uv)));
+   glVertexAttribPointer(QuadShaderProg.GetAttribLocation("Color"), 4, GL_UNSIGNED_BYTE, GL_TRUE, stride,
+      (void*)(base + offsetof(struct nk_glfw_quad_instance, col)));
+}
+
+NK_API void
+nk_glfw3_set_quad_instancing(struct nk_glfw* glfw, int enable)
+{
+   struct nk_glfw_device* dev = &glfw->ogl;
+
+   /* instanced arrays and gl_VertexID */
+   dev->quad_instancing = enable && GLEW_VERSION_3_3;
+   nk_glfw3_invalidate_frame(glfw);
+   if (!dev->quad_instancing || dev->quad_vao)
+      return;
+
+   nk_glfw3_quad_frame_init(&dev->quads);
+   glGenVertexArrays(1, &dev->quad_vao);
+   glGenVertexArrays(1, &dev->mesh_vao);
+   glGenBuffers(1, &dev->quad_vbo);
+   glGenBuffers(1, &dev->mesh_vbo);
+   glGenBuffers(1, &dev->mesh_ebo);
+
+   glBindVertexArray(dev->quad_vao);
+   glBindBuffer(GL_ARRAY_BUFFER, dev->quad_vbo);
+   for (const char* name : { "Rect", "TexRect", "Color" })
+   {
+      glEnableVertexAttribArray(QuadShaderProg.GetAttribLocation(name));
+      glVertexAttribDivisor(QuadShaderProg.GetAttribLocation(name), 1);
+   }
+   nk_glfw3_quad_attribs(0);
+
+   /* the converted rest is small, it goes up as floats without the ring */
+   glBindVertexArray(dev->mesh_vao);
+   glBindBuffer(GL_ARRAY_BUFFER, dev->mesh_vbo);
+   glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, dev->mesh_ebo);
+   glEnableVertexAttribArray((GLuint)dev->attrib_pos);
+   glEnableVertexAttribArray((GLuint)dev->attrib_uv);
+   glEnableVertexAttribArray((GLuint)dev->attrib_col);
+   glVertexAttribPointer((GLuint)dev->attrib_pos, 2, GL_FLOAT, GL_FALSE, sizeof(struct nk_glfw_vertex),
+      (void*)offsetof(struct nk_glfw_vertex, position));
+   glVertexAttribPointer((GLuint)dev->attrib_uv, 2, GL_FLOAT, GL_FALSE, sizeof(struct nk_glfw_vertex),
+      (void*)offsetof(struct nk_glfw_vertex, uv));
+   glVertexAttribPointer((GLuint)dev->attrib_col, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(struct nk_glfw_vertex),
+      (void*)offsetof(struct nk_glfw_vertex, col));
+
+   glBindVertexArray(0);
+   glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+NK_API void
+nk_glfw3_set_gpu_timing(struct nk_glfw* glfw, int enable)
+{
+   struct nk_glfw_device* dev = &glfw->ogl;
+   glfw->stats.gpu_ms = -1.0f;
+   dev->gpu_timing = enable && (GLEW_ARB_timer_query || GLEW_VERSION_3_3);
+   if (dev->gpu_timing && !dev->timer_queries[0])
+      glGenQueries(NK_GLFW_STREAM_FRAMES, dev->timer_queries);
+}
+
+/// <summary>
+/// Collects the oldest timer query if the gpu got to it and starts timing this frame's draws
+/// in its place. Returns false when that query is still in flight, the frame goes untimed then.
+/// </summary>
+NK_INTERN int
+nk_glfw3_timer_begin(struct nk_glfw* glfw)
+{
+   struct nk_glfw_device* dev = &glfw->ogl;
+   int slot = dev->timer_frame;
+
+   if (dev->timer_pending[slot]) {
+      GLint available = 0;
+      GLuint64 elapsed = 0;
+      glGetQueryObjectiv(dev->timer_queries[slot], GL_QUERY_RESULT_AVAILABLE, &available);
+      if (!available) return nk_false;
+      glGetQueryObjectui64v(dev->timer_queries[slot], GL_QUERY_RESULT, &elapsed);
+      glfw->stats.gpu_ms = (float)((double)elapsed / 1000000.0);
+      dev->timer_pending[slot] = nk_false;
+   }
+
+   glBeginQuery(GL_TIME_ELAPSED, dev->timer_queries[slot]);
+   return nk_true;
+}
+
+NK_INTERN void
+nk_glfw3_timer_end(struct nk_glfw_device* dev)
+{
+   glEndQuery(GL_TIME_ELAPSED);
+   dev->timer_pending[dev->timer_frame] = nk_true;
+   dev->timer_frame = (dev->timer_frame + 1) % NK_GLFW_STREAM_FRAMES;
+}
+
+NK_INTERN GLsizeiptr
+nk_glfw3_grow_capacity(GLsizeiptr capacity, nk_size needed)
+{
+   do capacity *= 2;
+   while ((nk_size)capacity < needed);
+   return capacity;
+}
+
+/* A run of draw commands that can go out as one draw call. */
+struct nk_glfw_draw_batch
+{
+   GLuint texture;
+   GLint scissor[4];
+   nk_size offset;
+   GLsizei count;
+};
+
+/* GL state the batches left behind, so unchanged program, texture and scissor aren't set again. */
+struct nk_glfw_draw_state
+{
+   int valid;
+   GLuint program;
+   GLuint texture;
+   GLint scissor[4];
+   /* the blend function is set up for premultiplied colors, every pass starts out straight */
+   int premultiplied;
+};
+
+/// <summary>
+/// Whether the texture belongs to one of the device's render targets.
+/// </summary>
+NK_INTERN int
+nk_glfw3_is_target_texture(struct nk_glfw_device* dev, GLuint texture)
+{
+   std::lock_guard<std::mutex> lock(RenderTargetMutex);
+   for (const struct nk_glfw_render_target* target = dev->targets; target; target = target->next) {
+      if (target->texture == texture)
+         return nk_true;
+   }
+   return nk_false;
+}
+
+/// <summary>
+/// Binds the texture of a batch. Render targets were drawn with their alpha applied already, so they
+/// composite with GL_ONE instead of weighting their colors by alpha a second time.
+/// </summary>
+NK_INTERN void
+nk_glfw3_bind_texture(struct nk_glfw_device* dev, struct nk_glfw_draw_state* state, GLuint texture)
+{
+   int premultiplied;
+   glBindTexture(GL_TEXTURE_2D, texture);
+
+   premultiplied = nk_glfw3_is_target_texture(dev, texture);
+   if (state->premultiplied != premultiplied) {
+      glBlendFuncSeparate(premultiplied ? GL_ONE : GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+      state->premultiplied = premultiplied;
+   }
+}
+
+NK_INTERN void
+nk_glfw3_flush_batch(struct nk_glfw* glfw, struct nk_glfw_draw_state* state,
+   struct nk_glfw_draw_batch* batch, GLint base_vertex)
+{
+   GLuint program;
+   if (!batch->count) return;
+
+   /* a distance field atlas needs its own shader, everything else samples plain colors */
+   program = glfw->ogl.font_sdf && batch->texture == glfw->ogl.font_tex ?
+      SdfShaderProg.GetShaderProgram() : ShaderProg.GetShaderProgram();
+   if (state->program != program) {
+      ShaderBase::Bind(program);
+      state->program = program;
+   }
+
+   if (!state->valid || state->texture != batch->texture)
+      nk_glfw3_bind_texture(&glfw->ogl, state, batch->texture);
+   if (!state->valid || memcmp(state->scissor, batch->scissor, sizeof(batch->scissor)))
+      glScissor(batch->scissor[0], batch->scissor[1], batch->scissor[2], batch->scissor[3]);
+
+   state->valid = nk_true;
+   state->texture = batch->texture;
+   memcpy(state->scissor, batch->scissor, sizeof(batch->scissor));
+
+   glDrawElementsBaseVertex(GL_TRIANGLES, batch->count, DrawIndexType, (const void*)batch->offset, base_vertex);
+   glfw->stats.draw_count++;
+   batch->count = 0;
+}
+
+/// <summary>
+/// Hashes everything a command contributes to the picture. Command memory is zeroed
+/// (NK_ZERO_COMMAND_MEMORY) so struct padding hashes the same every frame.
+/// </summary>
+NK_INTERN nk_hash
+nk_glfw3_hash_command(const struct nk_command* cmd, nk_hash seed)
+{
+   /* The header only holds the offset of the next command, skip it. */
+   const nk_byte* body = (const nk_byte*)cmd + sizeof(struct nk_command);
+   nk_size size = sizeof(struct nk_command);
+
+   switch (cmd->type)
+   {
+   case NK_COMMAND_SCISSOR: size = sizeof(struct nk_command_scissor); break;
+   case NK_COMMAND_LINE: size = sizeof(struct nk_command_line); break;
+   case NK_COMMAND_CURVE: size = sizeof(struct nk_command_curve); break;
+   case NK_COMMAND_RECT: size = sizeof(struct nk_command_rect); break;
+   case NK_COMMAND_RECT_FILLED: size = sizeof(struct nk_command_rect_filled); break;
+   case NK_COMMAND_RECT_MULTI_COLOR: size = sizeof(struct nk_command_rect_multi_color); break;
+   case NK_COMMAND_CIRCLE: size = sizeof(struct nk_command_circle); break;
+   case NK_COMMAND_CIRCLE_FILLED: size = sizeof(struct nk_command_circle_filled); break;
+   case NK_COMMAND_ARC: size = sizeof(struct nk_command_arc); break;
+   case NK_COMMAND_ARC_FILLED: size = sizeof(struct nk_command_arc_filled); break;
+   case NK_COMMAND_TRIANGLE: size = sizeof(struct nk_command_triangle); break;
+   case NK_COMMAND_TRIANGLE_FILLED: size = sizeof(struct nk_command_triangle_filled); break;
+   case NK_COMMAND_IMAGE: size = sizeof(struct nk_command_image); break;
+   case NK_COMMAND_CUSTOM: size = sizeof(struct nk_command_custom); break;
+   case NK_COMMAND_POLYGON: {
+      const struct nk_command_polygon* p = (const struct nk_command_polygon*)cmd;
+      size = NK_OFFSETOF(struct nk_command_polygon, points);
+      seed = nk_murmur_hash(p->points, (int)(p->point_count * sizeof(struct nk_vec2i)), seed);
+   } break;
+   case NK_COMMAND_POLYGON_FILLED: {
+      const struct nk_command_polygon_filled* p = (const struct nk_command_polygon_filled*)cmd;
+      size = NK_OFFSETOF(struct nk_command_polygon_filled, points);
+      seed = nk_murmur_hash(p->points, (int)(p->point_count * sizeof(struct nk_vec2i)), seed);
+   } break;
+   case NK_COMMAND_POLYLINE: {
+      const struct nk_command_polyline* p = (const struct nk_command_polyline*)cmd;
+      size = NK_OFFSETOF(struct nk_command_polyline, points);
+      seed = nk_murmur_hash(p->points, (int)(p->point_count * sizeof(struct nk_vec2i)), seed);
+   } break;
+   case NK_COMMAND_TEXT: {
+      const struct nk_command_text* t = (const struct nk_command_text*)cmd;
+      size = NK_OFFSETOF(struct nk_command_text, string);
+      seed = nk_murmur_hash(t->string, t->length, seed);
+   } break;
+   default: break;
+   }
+
+   seed = nk_murmur_hash(&cmd->type, (int)sizeof(cmd->type), seed);
+   return nk_murmur_hash(body, (int)(size - sizeof(struct nk_command)), seed);
+}
+
+/// <summary>
+/// Returns whether the command list built this frame differs from the one seen on the
+/// previous call. Has to be called after the ui is laid out and before nk_glfw3_render.
+/// </summary>
+NK_API int
+nk_glfw3_frame_changed(struct nk_glfw* glfw)
+{
+   const struct nk_command* cmd;
+   int custom = nk_false;
+   int changed;
+   int dims[4] = { glfw->width, glfw->height, glfw->display_width, glfw->display_height };
+   nk_hash hash = nk_murmur_hash(dims, (int)sizeof(dims), 0);
+
+   nk_foreach(cmd, &glfw->ctx)
+   {
+      /* custom callbacks draw things we can't see, always treat them as changed */
+      if (cmd->type == NK_COMMAND_CUSTOM) custom = nk_true;
+      hash = nk_glfw3_hash_command(cmd, hash);
+   }
+
+   changed = custom || !glfw->frame_hash_valid || hash != glfw->frame_hash;
+   glfw->frame_hash = hash;
+   glfw->frame_hash_valid = nk_true;
+   return changed;
+}
+
+/// <summary>
+/// Forces the next nk_glfw3_frame_changed to report a change, e.g. after the font texture is replaced.
+/// </summary>
+NK_API void
+nk_glfw3_invalidate_frame(struct nk_glfw* glfw)
+{
+   glfw->frame_hash_valid = nk_false;
+}
+
+/// <summary>
+/// Conversion settings producing nk_glfw_vertex output, shared with the headless renderer.
+/// </summary>
+NK_API void
+nk_glfw3_fill_convert_config(struct nk_glfw* glfw, enum nk_anti_aliasing AA, struct nk_convert_config* config)
+{
+   static const struct nk_draw_vertex_layout_element vertex_layout[] = {
+       {NK_VERTEX_POSITION, NK_FORMAT_FLOAT, NK_OFFSETOF(struct nk_glfw_vertex, position)},
+       {NK_VERTEX_TEXCOORD, NK_FORMAT_FLOAT, NK_OFFSETOF(struct nk_glfw_vertex, uv)},
+       {NK_VERTEX_COLOR, NK_FORMAT_R8G8B8A8, NK_OFFSETOF(struct nk_glfw_vertex, col)},
+       {NK_VERTEX_LAYOUT_END}
+   };
+   memset(config, 0, sizeof(*config));
+   config->vertex_layout = vertex_layout;
+   config->vertex_size = sizeof(struct nk_glfw_vertex);
+   config->vertex_alignment = NK_ALIGNOF(struct nk_glfw_vertex);
+   config->tex_null = glfw->ogl.tex_null;
+   config->circle_segment_count = 22;
+   config->curve_segment_count = 22;
+   config->arc_segment_count = 22;
+   config->global_alpha = 1.0f;
+   config->shape_AA = AA;
+   config->line_AA = AA;
+}
+
+/// <summary>
+/// Segments an arc of the given radius and angle needs so no chord strays further than tolerance
+/// from the circle. A 2px radio button gets a handful, a large knob up to NK_GLFW_MAX_ARC_SEGMENTS.
+/// </summary>
+NK_API unsigned int
+nk_glfw3_arc_segments(float radius, float angle, float tolerance)
+{
+   float step, segments;
+   angle = NK_ABS(angle);
+
+   /* a chord spanning step radians sits radius * (1 - cos(step / 2)) inside the arc */
+   if (radius > tolerance)
+   {
+      step = 2.0f * acosf(1.0f - tolerance / radius);
+      segments = ceilf(angle / step);
+   }
+   else
+   {
+      segments = 1.0f;
+   }
+
+   /* keep full circles round enough to still read as circles */
+   if (angle >= 2.0f * NK_PI - 0.001f)
+      segments = NK_MAX(segments, 6.0f);
+   return (unsigned int)NK_CLAMP(1.0f, segments, (float)NK_GLFW_MAX_ARC_SEGMENTS);
+}
+
+NK_INTERN unsigned int
+nk_glfw3_curve_segments(struct nk_vec2 p0, struct nk_vec2 p1, struct nk_vec2 p2, struct nk_vec2 p3, float tolerance)
+{
+   /* a cubic split into n steps strays at most 3/4 * max second difference / n^2 from its chords */
+   float ax = p0.x - 2.0f * p1.x + p2.x, ay = p0.y - 2.0f * p1.y + p2.y;
+   float bx = p1.x - 2.0f * p2.x + p3.x, by = p1.y - 2.0f * p2.y + p3.y;
+   float dd = NK_MAX(sqrtf(ax * ax + ay * ay), sqrtf(bx * bx + by * by));
+   float segments = ceilf(sqrtf(0.75f * dd / tolerance));
+   return (unsigned int)NK_CLAMP(1.0f, segments, (float)NK_GLFW_MAX_ARC_SEGMENTS);
+}
+
+/// <summary>
+/// Rectangle outline or fill. Rounded corners get segments for their own radius. Square ones are
+/// drawn without the anti aliasing fringe, they are axis aligned on whole units and only ever get
+/// blurred by it. Outlines become four bands since nuklear's plain strokes leave the corners open.
+/// </summary>
+NK_INTERN void
+nk_glfw3_convert_rect(struct nk_draw_list* list, struct nk_rect r, struct nk_color col,
+   float rounding, float thickness, int filled, float tolerance)
+{
+   float radius = NK_MIN(rounding, NK_MIN(r.w, r.h));
+   if (!col.a) return;
+
+   if (radius > 0.0f)
+   {
+      unsigned int segs = nk_glfw3_arc_segments(radius, NK_PI * 0.5f, tolerance);
+      float x0 = r.x + radius, x1 = r.x + r.w - radius;
+      float y0 = r.y + radius, y1 = r.y + r.h - radius;
+      nk_draw_list_path_arc_to(list, nk_vec2(x0, y0), radius, NK_PI, NK_PI * 1.5f, segs);
+      nk_draw_list_path_arc_to(list, nk_vec2(x1, y0), radius, NK_PI * 1.5f, NK_PI * 2.0f, segs);
+      nk_draw_list_path_arc_to(list, nk_vec2(x1, y1), radius, 0.0f, NK_PI * 0.5f, segs);
+      nk_draw_list_path_arc_to(list, nk_vec2(x0, y1), radius, NK_PI * 0.5f, NK_PI, segs);
+      if (filled)
+         nk_draw_list_path_fill(list, col);
+      else
+         nk_draw_list_path_stroke(list, col, NK_STROKE_CLOSED, thickness);
+      return;
+   }
+
+   {
+      enum nk_anti_aliasing shape_AA = list->config.shape_AA;
+      list->config.shape_AA = NK_ANTI_ALIASING_OFF;
+      if (filled)
+      {
+         nk_draw_list_fill_rect(list, r, col, 0.0f);
+      }
+      else
+      {
+         float half = thickness * 0.5f;
+         nk_draw_list_fill_rect(list, nk_rect(r.x - half, r.y - half, r.w + thickness, thickness), col, 0.0f);
+         nk_draw_list_fill_rect(list, nk_rect(r.x - half, r.y + r.h - half, r.w + thickness, thickness), col, 0.0f);
+         if (r.h > thickness)
+         {
+            nk_draw_list_fill_rect(list, nk_rect(r.x - half, r.y + half, thickness, r.h - thickness), col, 0.0f);
+            nk_draw_list_fill_rect(list, nk_rect(r.x + r.w - half, r.y + half, thickness, r.h - thickness), col, 0.0f);
+         }
+      }
+      list->config.shape_AA = shape_AA;
+   }
+}
+
+/// <summary>
+/// Adds one command to the draw list like nk_convert does, with circles, arcs, curves and rectangles
+/// tessellated by nk_glfw3_arc_segments instead of the fixed counts in the list's config.
+/// </summary>
+NK_INTERN void
+nk_glfw3_convert_command(struct nk_draw_list* list, const struct nk_command* cmd, float tolerance)
+{
+#ifdef NK_INCLUDE_COMMAND_USERDATA
+   list->userdata = cmd->userdata;
+#endif
+   switch (cmd->type) {
+   case NK_COMMAND_CURVE: {
+      const struct nk_command_curve* q = (const struct nk_command_curve*)cmd;
+      struct nk_vec2 p0 = nk_vec2(q->begin.x, q->begin.y), p3 = nk_vec2(q->end.x, q->end.y);
+      struct nk_vec2 p1 = nk_vec2(q->ctrl[0].x, q->ctrl[0].y), p2 = nk_vec2(q->ctrl[1].x, q->ctrl[1].y);
+      nk_draw_list_stroke_curve(list, p0, p1, p2, p3, q->color,
+         nk_glfw3_curve_segments(p0, p1, p2, p3, tolerance), q->line_thickness);
+   } break;
+   case NK_COMMAND_RECT: {
+      const struct nk_command_rect* r = (const struct nk_command_rect*)cmd;
+      nk_glfw3_convert_rect(list, nk_rect(r->x, r->y, r->w, r->h), r->color,
+         (float)r->rounding, r->line_thickness, nk_false, tolerance);
+   } break;
+   case NK_COMMAND_RECT_FILLED: {
+      const struct nk_command_rect_filled* r = (const struct nk_command_rect_filled*)cmd;
+      nk_glfw3_convert_rect(list, nk_rect(r->x, r->y, r->w, r->h), r->color,
+         (float)r->rounding, 0.0f, nk_true, tolerance);
+   } break;
+   case NK_COMMAND_CIRCLE: {
+      const struct nk_command_circle* c = (const struct nk_command_circle*)cmd;
+      float radius = (float)c->w / 2;
+      nk_draw_list_stroke_circle(list, nk_vec2((float)c->x + radius, (float)c->y + (float)c->h / 2),
+         radius, c->color, nk_glfw3_arc_segments(radius, 2.0f * NK_PI, tolerance), c->line_thickness);
+   } break;
+   case NK_COMMAND_CIRCLE_FILLED: {
+      const struct nk_command_circle_filled* c = (const struct nk_command_circle_filled*)cmd;
+      float radius = (float)c->w / 2;
+      nk_draw_list_fill_circle(list, nk_vec2((float)c->x + radius, (float)c->y + (float)c->h / 2),
+         radius, c->color, nk_glfw3_arc_segments(radius, 2.0f * NK_PI, tolerance));
+   } break;
+   case NK_COMMAND_ARC: {
+      const struct nk_command_arc* c = (const struct nk_command_arc*)cmd;
+      nk_draw_list_path_line_to(list, nk_vec2(c->cx, c->cy));
+      nk_draw_list_path_arc_to(list, nk_vec2(c->cx, c->cy), c->r, c->a[0], c->a[1],
+         nk_glfw3_arc_segments(c->r, c->a[1] - c->a[0], tolerance));
+      nk_draw_list_path_stroke(list, c->color, NK_STROKE_CLOSED, c->line_thickness);
+   } break;
+   case NK_COMMAND_ARC_FILLED: {
+      const struct nk_command_arc_filled* c = (const struct nk_command_arc_filled*)cmd;
+      nk_draw_list_path_line_to(list, nk_vec2(c->cx, c->cy));
+      nk_draw_list_path_arc_to(list, nk_vec2(c->cx, c->cy), c->r, c->a[0], c->a[1],
+         nk_glfw3_arc_segments(c->r, c->a[1] - c->a[0], tolerance));
+      nk_draw_list_path_fill(list, c->color);
+   } break;
+   case NK_COMMAND_SCISSOR: {
+      const struct nk_command_scissor* s = (const struct nk_command_scissor*)cmd;
+      nk_draw_list_add_clip(list, nk_rect(s->x, s->y, s->w, s->h));
+   } break;
+   case NK_COMMAND_LINE: {
+      const struct nk_command_line* l = (const struct nk_command_line*)cmd;
+      nk_draw_list_stroke_line(list, nk_vec2(l->begin.x, l->begin.y),
+         nk_vec2(l->end.x, l->end.y), l->color, l->line_thickness);
+   } break;
+   case NK_COMMAND_RECT_MULTI_COLOR: {
+      const struct nk_command_rect_multi_color* r = (const struct nk_command_rect_multi_color*)cmd;
+      nk_draw_list_fill_rect_multi_color(list, nk_rect(r->x, r->y, r->w, r->h),
+         r->left, r->top, r->right, r->bottom);
+   } break;
+   case NK_COMMAND_TRIANGLE: {
+      const struct nk_command_triangle* t = (const struct nk_command_triangle*)cmd;
+      nk_draw_list_stroke_triangle(list, nk_vec2(t->a.x, t->a.y), nk_vec2(t->b.x, t->b.y),
+         nk_vec2(t->c.x, t->c.y), t->color, t->line_thickness);
+   } break;
+   case NK_COMMAND_TRIANGLE_FILLED: {
+      const struct nk_command_triangle_filled* t = (const struct nk_command_triangle_filled*)cmd;
+      nk_draw_list_fill_triangle(list, nk_vec2(t->a.x, t->a.y), nk_vec2(t->b.x, t->b.y),
+         nk_vec2(t->c.x, t->c.y), t->color);
+   } break;
+   case NK_COMMAND_POLYGON: {
+      const struct nk_command_polygon* p = (const struct nk_command_polygon*)cmd;
+      int i;
+      for (i = 0; i < p->point_count; ++i)
+         nk_draw_list_path_line_to(list, nk_vec2((float)p->points[i].x, (float)p->points[i].y));
+      nk_draw_list_path_stroke(list, p->color, NK_STROKE_CLOSED, p->line_thickness);
+   } break;
+   case NK_COMMAND_POLYGON_FILLED: {
+      const struct nk_command_polygon_filled* p = (const struct nk_command_polygon_filled*)cmd;
+      int i;
+      for (i = 0; i < p->point_count; ++i)
+         nk_draw_list_path_line_to(list, nk_vec2((float)p->points[i].x, (float)p->points[i].y));
+      nk_draw_list_path_fill(list, p->color);
+   } break;
+   case NK_COMMAND_POLYLINE: {
+      const struct nk_command_polyline* p = (const struct nk_command_polyline*)cmd;
+      int i;
+      for (i = 0; i < p->point_count; ++i)
+         nk_draw_list_path_line_to(list, nk_vec2((float)p->points[i].x, (float)p->points[i].y));
+      nk_draw_list_path_stroke(list, p->color, NK_STROKE_OPEN, p->line_thickness);
+   } break;
+   case NK_COMMAND_TEXT: {
+      const struct nk_command_text* t = (const struct nk_command_text*)cmd;
+      nk_draw_list_add_text(list, t->font, nk_rect(t->x, t->y, t->w, t->h),
+         t->string, t->length, t->height, t->foreground);
+   } break;
+   case NK_COMMAND_IMAGE: {
+      const struct nk_command_image* i = (const struct nk_command_image*)cmd;
+      nk_draw_list_add_image(list, i->img, nk_rect(i->x, i->y, i->w, i->h), i->col);
+   } break;
+   case NK_COMMAND_CUSTOM: {
+      const struct nk_command_custom* c = (const struct nk_command_custom*)cmd;
+      c->callback(list, c->x, c->y, c->w, c->h, c->callback_data);
+   } break;
+   default: break;
+   }
+}
+
+/// <summary>
+/// nk_convert with the shapes tessellated by nk_glfw3_convert_command. Tolerance is in the
+/// units of the commands, pixels divided by the framebuffer scale.
+/// </summary>
+NK_API nk_flags
+nk_glfw3_convert(struct nk_context* ctx, struct nk_buffer* cmds, struct nk_buffer* vertices,
+   struct nk_buffer* elements, const struct nk_convert_config* config, float tolerance)
+{
+   struct nk_draw_list* list = &ctx->draw_list;
+   const struct nk_command* cmd;
+   nk_flags res = NK_CONVERT_SUCCESS;
+
+   if (tolerance <= 0.0f)
+      return nk_convert(ctx, cmds, vertices, elements, config);
+
+   nk_draw_list_setup(list, config, cmds, vertices, elements, config->line_AA, config->shape_AA);
+   nk_foreach(cmd, ctx)
+   {
+      nk_glfw3_convert_command(list, cmd, tolerance);
+   }
+
+   res |= (cmds->needed > cmds->allocated + (cmds->memory.size - cmds->size)) ? NK_CONVERT_COMMAND_BUFFER_FULL : 0;
+   res |= (vertices->needed > vertices->allocated) ? NK_CONVERT_VERTEX_BUFFER_FULL : 0;
+   res |= (elements->needed > elements->allocated) ? NK_CONVERT_ELEMENT_BUFFER_FULL : 0;
+   return res;
+}
+
+NK_API void
+nk_glfw3_quad_frame_init(struct nk_glfw_quad_frame* frame)
+{
+   nk_buffer_init_default(&frame->instances);
+   nk_buffer_init_default(&frame->batches);
+   nk_buffer_init_default(&frame->segments);
+   nk_buffer_init_default(&frame->vertices);
+   nk_buffer_init_default(&frame->elements);
+}
+
+NK_API void
+nk_glfw3_quad_frame_free(struct nk_glfw_quad_frame* frame)
+{
+   nk_buffer_free(&frame->instances);
+   nk_buffer_free(&frame->batches);
+   nk_buffer_free(&frame->segments);
+   nk_buffer_free(&frame->vertices);
+   nk_buffer_free(&frame->elements);
+}
+
+NK_INTERN struct nk_glfw_quad_batch*
+nk_glfw3_last_batch(struct nk_buffer* batches)
+{
+   nk_size count = batches->allocated / sizeof(struct nk_glfw_quad_batch);
+   return count ? (struct nk_glfw_quad_batch*)nk_buffer_memory(batches) + count - 1 : NULL;
+}
+
+NK_INTERN void
+nk_glfw3_push_batch(struct nk_buffer* batches, int elements, nk_handle texture, struct nk_rect clip,
+   nk_uint first, nk_uint count)
+{
+   struct nk_glfw_quad_batch batch;
+   memset(&batch, 0, sizeof(batch));
+   batch.elements = elements;
+   batch.texture = texture;
+   batch.clip = clip;
+   batch.first = first;
+   batch.count = count;
+   nk_buffer_push(batches, NK_BUFFER_FRONT, &batch, sizeof(batch), NK_ALIGNOF(struct nk_glfw_quad_batch));
+}
+
+NK_INTERN void
+nk_glfw3_push_quad(struct nk_glfw_quad_frame* frame, const struct nk_draw_list* list, nk_handle texture,
+   struct nk_rect rect, struct nk_vec2 uv0, struct nk_vec2 uv1, struct nk_color col)
+{
+   struct nk_glfw_quad_instance quad;
+   struct nk_glfw_quad_batch* last = nk_glfw3_last_batch(&frame->segments);
+   nk_uint index = (nk_uint)(frame->instances.allocated / sizeof(struct nk_glfw_quad_instance));
+
+   if (!last || last->elements || last->texture.ptr != texture.ptr ||
+      memcmp(&last->clip, &list->clip_rect, sizeof(last->clip)))
+   {
+      nk_glfw3_push_batch(&frame->segments, nk_false, texture, list->clip_rect, index, 0);
+      last = nk_glfw3_last_batch(&frame->segments);
+   }
+   last->count++;
+
+   quad.rect[0] = rect.x;
+   quad.rect[1] = rect.y;
+   quad.rect[2] = rect.w;
+   quad.rect[3] = rect.h;
+   quad.uv[0] = (nk_ushort)(NK_CLAMP(0.0f, uv0.x, 1.0f) * 65535.0f + 0.5f);
+   quad.uv[1] = (nk_ushort)(NK_CLAMP(0.0f, uv0.y, 1.0f) * 65535.0f + 0.5f);
+   quad.uv[2] = (nk_ushort)(NK_CLAMP(0.0f, uv1.x, 1.0f) * 65535.0f + 0.5f);
+   quad.uv[3] = (nk_ushort)(NK_CLAMP(0.0f, uv1.y, 1.0f) * 65535.0f + 0.5f);
+   col.a = (nk_byte)((float)col.a * list->config.global_alpha);
+   memcpy(quad.col, &col, sizeof(quad.col));
+   nk_buffer_push(&frame->instances, NK_BUFFER_FRONT, &quad, sizeof(quad), NK_ALIGNOF(struct nk_glfw_quad_instance));
+}
+
+/// <summary>
+/// One instance per glyph, placed exactly like nk_draw_list_add_text places its quads.
+/// </summary>
+NK_INTERN void
+nk_glfw3_push_text(struct nk_glfw_quad_frame* frame, const struct nk_draw_list* list, const struct nk_command_text* t)
+{
+   const struct nk_user_font* font = t->font;
+   float x = t->x;
+   int text_len = 0;
+   nk_rune unicode = 0, next = 0;
+   int glyph_len, next_glyph_len;
+   struct nk_user_font_glyph g;
+
+   if (!t->length || !t->foreground.a) return;
+   if (!NK_INTERSECT(t->x, t->y, t->w, t->h,
+      list->clip_rect.x, list->clip_rect.y, list->clip_rect.w, list->clip_rect.h)) return;
+
+   glyph_len = nk_utf_decode(t->string, &unicode, t->length);
+   while (text_len < t->length && glyph_len)
+   {
+      if (unicode == NK_UTF_INVALID) break;
+      next_glyph_len = nk_utf_decode(t->string + text_len + glyph_len, &next, t->length - text_len);
+      font->query(font->userdata, t->height, &g, unicode, (next == NK_UTF_INVALID) ? '\0' : next);
+
+      nk_glfw3_push_quad(frame, list, font->texture, nk_rect(x + g.offset.x, t->y + g.offset.y, g.width, g.height),
+         g.uv[0], g.uv[1], t->foreground);
+
+      text_len += glyph_len;
+      x += g.xadvance;
+      glyph_len = next_glyph_len;
+      unicode = next;
+   }
+}
+
+/// <summary>
+/// Walks the commands once. Square filled rects, text and images become quad instances, every other
+/// command is converted into frame->vertices/elements. frame->batches then lists both kinds in command
+/// order, converted runs split along nuklear's draw commands so each batch has one texture and clip.
+/// </summary>
+NK_API void
+nk_glfw3_build_quads(struct nk_context* ctx, struct nk_buffer* cmds, struct nk_glfw_quad_frame* frame,
+   const struct nk_convert_config* config, float tolerance)
+{
+   struct nk_draw_list* list = &ctx->draw_list;
+   const struct nk_command* cmd;
+
+   /* there is no fixed segment count variant of the quad path */
+   if (tolerance <= 0.0f)
+      tolerance = NK_GLFW_TESSELLATION_TOLERANCE;
+
+   nk_buffer_clear(&frame->instances);
+   nk_buffer_clear(&frame->batches);
+   nk_buffer_clear(&frame->segments);
+   nk_buffer_clear(&frame->vertices);
+   nk_buffer_clear(&frame->elements);
+   nk_draw_list_setup(list, config, cmds, &frame->vertices, &frame->elements, config->line_AA, config->shape_AA);
+
+   nk_foreach(cmd, ctx)
+   {
+      switch (cmd->type) {
+      case NK_COMMAND_RECT_FILLED: {
+         const struct nk_command_rect_filled* r = (const struct nk_command_rect_filled*)cmd;
+         if (r->rounding) break;
+         if (r->color.a)
+            nk_glfw3_push_quad(frame, list, config->tex_null.texture, nk_rect(r->x, r->y, r->w, r->h),
+               config->tex_null.uv, config->tex_null.uv, r->color);
+      } continue;
+      case NK_COMMAND_TEXT: {
+         const struct nk_command_text* t = (const struct nk_command_text*)cmd;
+         if (!t->font->query) break;
+         nk_glfw3_push_text(frame, list, t);
+      } continue;
+      case NK_COMMAND_IMAGE: {
+         const struct nk_command_image* i = (const struct nk_command_image*)cmd;
+         struct nk_vec2 uv0 = nk_vec2(0.0f, 0.0f), uv1 = nk_vec2(1.0f, 1.0f);
+         if (nk_image_is_subimage(&i->img))
+         {
+            uv0 = nk_vec2(i->img.region[0] / (float)i->img.w, i->img.region[1] / (float)i->img.h);
+            uv1 = nk_vec2((i->img.region[0] + i->img.region[2]) / (float)i->img.w,
+               (i->img.region[1] + i->img.region[3]) / (float)i->img.h);
+         }
+         nk_glfw3_push_quad(frame, list, i->img.handle, nk_rect(i->x, i->y, i->w, i->h), uv0, uv1, i->col);
+      } continue;
+      default: break;
+      }
+
+      /* converted like nk_glfw3_convert, runs of converted elements become one segment */
+      {
+         nk_uint before = (nk_uint)list->element_count;
+         nk_glfw3_convert_command(list, cmd, tolerance);
+         if (list->element_count > before)
+         {
+            struct nk_glfw_quad_batch* last = nk_glfw3_last_batch(&frame->segments);
+            if (last && last->elements && last->first + last->count == before)
+               last->count += (nk_uint)list->element_count - before;
+            else
+               nk_glfw3_push_batch(&frame->segments, nk_true, config->tex_null.texture, list->clip_rect,
+                  before, (nk_uint)list->element_count - before);
+         }
+      }
+   }
+
+   /* converted segments take texture and clip from the draw commands their elements fall in */
+   {
+      const struct nk_glfw_quad_batch* segments = (const struct nk_glfw_quad_batch*)nk_buffer_memory_const(&frame->segments);
+      nk_size count = frame->segments.allocated / sizeof(struct nk_glfw_quad_batch);
+      const struct nk_draw_command* draw = nk__draw_list_begin(list, cmds);
+      nk_uint draw_first = 0;
+      nk_size i;
+
+      for (i = 0; i < count; ++i)
+      {
+         nk_uint first = segments[i].first, end = segments[i].first + segments[i].count;
+         if (!segments[i].elements)
+         {
+            nk_buffer_push(&frame->batches, NK_BUFFER_FRONT, &segments[i], sizeof(segments[i]),
+               NK_ALIGNOF(struct nk_glfw_quad_batch));
+            continue;
+         }
+
+         while (draw && first < end)
+         {
+            nk_uint draw_end = draw_first + draw->elem_count;
+            if (draw_end > first)
+            {
+               nk_uint slice_end = NK_MIN(end, draw_end);
+               nk_glfw3_push_batch(&frame->batches, nk_true, draw->texture, draw->clip_rect, first, slice_end - first);
+               first = slice_end;
+            }
+            if (draw_end <= first)
+            {
+               draw_first = draw_end;
+               draw = nk__draw_list_next(draw, cmds, list);
+            }
+         }
+      }
+   }
+}
+
+NK_API float
+nk_glfw3_tessellation_tolerance(const struct nk_glfw* glfw)
+{
+   float scale;
+   if (glfw->fixed_tessellation)
+      return 0.0f;
+
+   /* commands are in window units, a 2x framebuffer needs half the tolerance in them */
+   scale = NK_MAX(glfw->fb_scale.x, glfw->fb_scale.y);
+   return scale > 0.0f ? NK_GLFW_TESSELLATION_TOLERANCE / scale : NK_GLFW_TESSELLATION_TOLERANCE;
+}
+
+NK_API void
+nk_glfw3_set_fixed_tessellation(struct nk_glfw* glfw, int enable)
+{
+   glfw->fixed_tessellation = enable;
+   nk_glfw3_invalidate_frame(glfw);
+}
 
-   glBindTexture(GL_TEXTURE_2D, 0);
+NK_INTERN void
+nk_glfw3_reset_state(void)
+{
+   /* default OpenGL state */
+   ShaderBase::Unbind();
    glBindBuffer(GL_ARRAY_BUFFER, 0);
    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
    glBindVertexArray(0);
+   glDisable(GL_BLEND);
+   glDisable(GL_SCISSOR_TEST);
 }
 
 NK_INTERN void
-nk_glfw3_device_upload_atlas(struct nk_glfw* glfw, const void* image, int width, int height)
+nk_glfw3_scissor(const struct nk_glfw* glfw, struct nk_rect clip, GLint scissor[4])
 {
-   struct nk_glfw_device* dev = &glfw->ogl;
-   glGenTextures(1, &dev->font_tex);
-   glBindTexture(GL_TEXTURE_2D, dev->font_tex);
-   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-   glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, (GLsizei)width, (GLsizei)height, 0,
-      GL_RGBA, GL_UNSIGNED_BYTE, image);
+   scissor[0] = (GLint)(clip.x * glfw->fb_scale.x);
+   scissor[1] = (GLint)((glfw->height - (GLint)(clip.y + clip.h)) * glfw->fb_scale.y);
+   scissor[2] = (GLint)(clip.w * glfw->fb_scale.x);
+   scissor[3] = (GLint)(clip.h * glfw->fb_scale.y);
 }
 
-NK_API void
-nk_glfw3_device_destroy(struct nk_glfw* glfw)
+/// <summary>
+/// The instanced path of nk_glfw3_render. Builds the frame with nk_glfw3_build_quads, uploads the
+/// instances and the converted rest by orphaning, then draws the batches in order.
+/// </summary>
+NK_INTERN void
+nk_glfw3_render_quads(struct nk_glfw* glfw, enum nk_anti_aliasing AA, const Matrix44f& projection)
 {
    struct nk_glfw_device* dev = &glfw->ogl;
-   glDeleteTextures(1, &dev->font_tex);
-   glDeleteBuffers(1, &dev->vbo);
-   glDeleteBuffers(1, &dev->ebo);
-   nk_buffer_free(&dev->cmds);
+   struct nk_glfw_quad_frame* frame = &dev->quads;
+   struct nk_glfw_draw_state state;
+   struct nk_convert_config config;
+   const struct nk_glfw_quad_batch* batches;
+   nk_size batch_count, i;
+   double convert_start, upload_start, draw_start;
+   GLuint vao = 0;
+   int timed;
+
+   if (!QuadShaderProg.GetShaderProgram())
+      nk_glfw3_load_program(&QuadShaderProg);
+   if (dev->font_sdf && !QuadSdfShaderProg.GetShaderProgram())
+      nk_glfw3_load_program(&QuadSdfShaderProg);
+
+   /* the converted rest goes up as floats, no program sees packed positions here */
+   ShaderBase::Bind(ShaderProg.GetShaderProgram());
+   ShaderProg.LoadProjection(projection);
+   ShaderBase::Bind(QuadShaderProg.GetShaderProgram());
+   QuadShaderProg.LoadProjection(projection);
+   if (dev->font_sdf) {
+      ShaderBase::Bind(SdfShaderProg.GetShaderProgram());
+      SdfShaderProg.LoadProjection(projection);
+      ShaderBase::Bind(QuadSdfShaderProg.GetShaderProgram());
+      QuadSdfShaderProg.LoadProjection(projection);
+   }
+   glViewport(0, 0, (GLsizei)glfw->display_width, (GLsizei)glfw->display_height);
+
+   nk_glfw3_fill_convert_config(glfw, AA, &config);
+   convert_start = glfwGetTime();
+   nk_glfw3_build_quads(&glfw->ctx, &dev->cmds, frame, &config, nk_glfw3_tessellation_tolerance(glfw));
+   upload_start = glfwGetTime();
+   glfw->stats.convert_ms = (float)((upload_start - convert_start) * 1000.0);
+
+   glBindBuffer(GL_ARRAY_BUFFER, dev->quad_vbo);
+   glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)frame->instances.allocated, NULL, GL_STREAM_DRAW);
+   glBufferSubData(GL_ARRAY_BUFFER, 0, (GLsizeiptr)frame->instances.allocated, nk_buffer_memory_const(&frame->instances));
+   glBindVertexArray(dev->mesh_vao);
+   glBindBuffer(GL_ARRAY_BUFFER, dev->mesh_vbo);
+   glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)frame->vertices.allocated, nk_buffer_memory_const(&frame->vertices), GL_STREAM_DRAW);
+   glBufferData(GL_ELEMENT_ARRAY_BUFFER, (GLsizeiptr)frame->elements.allocated, nk_buffer_memory_const(&frame->elements), GL_STREAM_DRAW);
+   glBindVertexArray(0);
+
+   draw_start = glfwGetTime();
+   glfw->stats.upload_ms = (float)((draw_start - upload_start) * 1000.0);
+   glfw->stats.grow_count = 0;
+   glfw->stats.vertex_count = glfw->ctx.draw_list.vertex_count;
+   glfw->stats.element_count = glfw->ctx.draw_list.element_count;
+   glfw->stats.instance_count = (nk_uint)(frame->instances.allocated / sizeof(struct nk_glfw_quad_instance));
+   glfw->stats.vertex_bytes = frame->vertices.allocated + frame->instances.allocated;
+   glfw->stats.vertex_buffer_size = frame->vertices.allocated + frame->instances.allocated;
+   glfw->stats.element_buffer_size = frame->elements.allocated;
+   glfw->stats.index_overflow = sizeof(nk_draw_index) == 2 && glfw->stats.vertex_count > 0xFFFF;
+   glfw->stats.draw_count = 0;
+
+   batches = (const struct nk_glfw_quad_batch*)nk_buffer_memory_const(&frame->batches);
+   batch_count = frame->batches.allocated / sizeof(struct nk_glfw_quad_batch);
+   glfw->stats.command_count = (nk_uint)batch_count;
+
+   memset(&state, 0, sizeof(state));
+   timed = dev->gpu_timing && nk_glfw3_timer_begin(glfw);
+   for (i = 0; i < batch_count; ++i)
+   {
+      const struct nk_glfw_quad_batch* batch = &batches[i];
+      struct nk_glfw_draw_batch draw;
+      GLuint program;
+
+      memset(&draw, 0, sizeof(draw));
+      draw.texture = (GLuint)batch->texture.id;
+      draw.count = (GLsizei)batch->count;
+      nk_glfw3_scissor(glfw, batch->clip, draw.scissor);
+
+      if (batch->elements)
+      {
+         if (vao != dev->mesh_vao)
+            glBindVertexArray(vao = dev->mesh_vao);
+         draw.offset = (nk_size)batch->first * sizeof(nk_draw_index);
+         nk_glfw3_flush_batch(glfw, &state, &draw, 0);
+         continue;
+      }
+
+      if (vao != dev->quad_vao)
+      {
+         glBindVertexArray(vao = dev->quad_vao);
+         glBindBuffer(GL_ARRAY_BUFFER, dev->quad_vbo);
+      }
+
+      program = dev->font_sdf && draw.texture == dev->font_tex ?
+         QuadSdfShaderProg.GetShaderProgram() : QuadShaderProg.GetShaderProgram();
+      if (state.program != program) {
+         ShaderBase::Bind(program);
+         state.program = program;
+      }
+      if (!state.valid || state.texture != draw.texture)
+         nk_glfw3_bind_texture(dev, &state, draw.texture);
+      if (!state.valid || memcmp(state.scissor, draw.scissor, sizeof(draw.scissor)))
+         glScissor(draw.scissor[0], draw.scissor[1], draw.scissor[2], draw.scissor[3]);
+      state.valid = nk_true;
+      state.texture = draw.texture;
+      memcpy(state.scissor, draw.scissor, sizeof(draw.scissor));
+
+      nk_glfw3_quad_attribs(batch->first);
+      glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, draw.count);
+      glfw->stats.draw_count++;
+   }
+   if (timed)
+      nk_glfw3_timer_end(dev);
+
+   glfw->stats.draw_ms = (float)((glfwGetTime() - draw_start) * 1000.0);
+   nk_clear(&glfw->ctx);
+   nk_buffer_clear(&dev->cmds);
 }
 
 NK_API void
@@ -100,6 +1490,8 @@ nk_glfw3_render(struct nk_glfw* glfw, enum nk_anti_aliasing AA, int max_vertex_b
    struct nk_glfw_device* dev = &glfw->ogl;
    struct nk_buffer vbuf, ebuf;
 
+   nk_glfw3_free_released_targets(dev);
+
    /* setup global state */
    glEnable(GL_BLEND);
    glBlendEquation(GL_FUNC_ADD);
@@ -109,7 +1501,11 @@ nk_glfw3_render(struct nk_glfw* glfw, enum nk_anti_aliasing AA, int max_vertex_b
    glEnable(GL_SCISSOR_TEST);
    glActiveTexture(GL_TEXTURE0);
 
-   /* setup program */
+   /* setup program, a render thread loads its own on its first frame */
+   if (!ShaderProg.GetShaderProgram())
+      nk_glfw3_load_program(&ShaderProg);
+   if (dev->font_sdf && !SdfShaderProg.GetShaderProgram())
+      nk_glfw3_load_program(&SdfShaderProg);
    ShaderBase::Bind(ShaderProg.GetShaderProgram());
 
    Matrix44f projMatrix(2.0, 0.0, 0.0, 0.0,
@@ -120,7 +1516,25 @@ nk_glfw3_render(struct nk_glfw* glfw, enum nk_anti_aliasing AA, int max_vertex_b
    projMatrix.data[0][0] /= (GLfloat)glfw->width;
    projMatrix.data[1][1] /= (GLfloat)glfw->height;
 
+   if (dev->quad_instancing)
+   {
+      nk_glfw3_render_quads(glfw, AA, projMatrix);
+      nk_glfw3_reset_state();
+      return;
+   }
+
+   /* packed positions are in subpixel steps, scaling the projection saves a shader variant */
+   if (dev->vertex_format == NK_GLFW_VERTEX_PACKED) {
+      projMatrix.data[0][0] /= (GLfloat)NK_GLFW_POSITION_SUBPIXELS;
+      projMatrix.data[1][1] /= (GLfloat)NK_GLFW_POSITION_SUBPIXELS;
+   }
+
    ShaderProg.LoadProjection(projMatrix);
+   if (dev->font_sdf) {
+      ShaderBase::Bind(SdfShaderProg.GetShaderProgram());
+      SdfShaderProg.LoadProjection(projMatrix);
+      ShaderBase::Bind(ShaderProg.GetShaderProgram());
+   }
    //ShaderProg.LoadMousePos(glfw->ctx.input.mouse.pos.x, glfw->ctx.input.mouse.pos.y);
    //ShaderProg.LoadWindowSize(glfw->width, glfw->height);
 
@@ -130,71 +1544,350 @@ nk_glfw3_render(struct nk_glfw* glfw, enum nk_anti_aliasing AA, int max_vertex_b
       const struct nk_draw_command* cmd;
       void* vertices, * elements;
       nk_size offset = 0;
+      nk_size element_base = 0;
+      GLint base_vertex = 0;
+      GLsizeiptr vertex_size, element_size;
+      int frame = dev->stream_frame;
+      int packed = dev->vertex_format == NK_GLFW_VERTEX_PACKED;
+      const GLsizeiptr stride = nk_glfw3_vertex_stride(dev);
+      int timed;
+      nk_flags result;
+      double upload_start, convert_start, draw_start;
+
+      struct nk_convert_config config;
+      nk_glfw3_fill_convert_config(glfw, AA, &config);
 
-      // Allocate buffers.
+      // The sizes passed in are only a lower bound, buffers keep whatever they grew to.
+      dev->vertex_capacity = NK_MAX(dev->vertex_capacity, (GLsizeiptr)max_vertex_buffer);
+      dev->element_capacity = NK_MAX(dev->element_capacity, (GLsizeiptr)max_element_buffer);
+      glfw->stats.grow_count = 0;
+      glfw->stats.convert_ms = 0;
+
+      upload_start = glfwGetTime();
       glBindVertexArray(dev->vao);
       glBindBuffer(GL_ARRAY_BUFFER, dev->vbo);
       glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, dev->ebo);
 
-      glBufferData(GL_ARRAY_BUFFER, max_vertex_buffer, NULL, GL_STREAM_DRAW);
-      glBufferData(GL_ELEMENT_ARRAY_BUFFER, max_element_buffer, NULL, GL_STREAM_DRAW);
+      for (;;)
+      {
+         if (dev->stream_mode == NK_GLFW3_STREAM_ORPHAN)
+         {
+            // Allocate buffers.
+            vertex_size = dev->vertex_capacity;
+            element_size = dev->element_capacity;
+            glBufferData(GL_ARRAY_BUFFER, vertex_size, NULL, GL_STREAM_DRAW);
+            glBufferData(GL_ELEMENT_ARRAY_BUFFER, element_size, NULL, GL_STREAM_DRAW);
+
+            vertices = glMapBuffer(GL_ARRAY_BUFFER, GL_WRITE_ONLY);
+            elements = glMapBuffer(GL_ELEMENT_ARRAY_BUFFER, GL_WRITE_ONLY);
+         }
+         else
+         {
+            // Write into this frame's ring segment once the gpu is done with it.
+            nk_glfw3_stream_reserve(dev, dev->vertex_capacity, dev->element_capacity);
+            frame = dev->stream_frame;
+            nk_glfw3_stream_wait(&dev->stream_fences[frame]);
+
+            vertex_size = dev->vertex_stream.segment_size;
+            element_size = dev->element_stream.segment_size;
+            vertices = nk_glfw3_stream_map(&dev->vertex_stream, frame);
+            elements = nk_glfw3_stream_map(&dev->element_stream, frame);
+            base_vertex = (GLint)(vertex_size * frame / stride);
+            element_base = (nk_size)(element_size * frame);
+         }
+
+         // Load draw vertices. Packed vertices are converted into staging and packed into the mapping.
+         nk_buffer_init_fixed(&vbuf, vertices, (nk_size)vertex_size);
+         nk_buffer_init_fixed(&ebuf, elements, (nk_size)element_size);
+         nk_buffer_clear(&dev->staging);
+         convert_start = glfwGetTime();
+         result = nk_glfw3_convert(&glfw->ctx, &dev->cmds, packed ? &dev->staging : &vbuf, &ebuf, &config,
+            nk_glfw3_tessellation_tolerance(glfw));
+         glfw->stats.convert_ms += (float)((glfwGetTime() - convert_start) * 1000.0);
+
+         if (packed && !(result & NK_CONVERT_ELEMENT_BUFFER_FULL))
+         {
+            nk_size count = glfw->ctx.draw_list.vertex_count;
+            vbuf.needed = count * sizeof(struct nk_glfw_packed_vertex);
+            if (vbuf.needed > (nk_size)vertex_size)
+               result |= NK_CONVERT_VERTEX_BUFFER_FULL;
+            else
+               nk_glfw3_pack_vertices((struct nk_glfw_packed_vertex*)vertices,
+                  (const struct nk_glfw_vertex*)nk_buffer_memory_const(&dev->staging), count);
+         }
+
+         if (dev->stream_mode == NK_GLFW3_STREAM_ORPHAN)
+         {
+            glUnmapBuffer(GL_ARRAY_BUFFER);
+            glUnmapBuffer(GL_ELEMENT_ARRAY_BUFFER);
+         }
+         else
+         {
+            nk_glfw3_stream_unmap(&dev->vertex_stream);
+            nk_glfw3_stream_unmap(&dev->element_stream);
+         }
+
+         if (!(result & (NK_CONVERT_VERTEX_BUFFER_FULL | NK_CONVERT_ELEMENT_BUFFER_FULL)))
+            break;
+
+         // The frame was truncated, grow what overflowed and convert it again.
+         if (result & NK_CONVERT_VERTEX_BUFFER_FULL)
+            dev->vertex_capacity = nk_glfw3_grow_capacity(dev->vertex_capacity, vbuf.needed);
+         if (result & NK_CONVERT_ELEMENT_BUFFER_FULL)
+            dev->element_capacity = nk_glfw3_grow_capacity(dev->element_capacity, ebuf.needed);
+
+         if (dev->vertex_capacity > NK_GLFW_MAX_STREAM_BUFFER || dev->element_capacity > NK_GLFW_MAX_STREAM_BUFFER)
+         {
+            // Draw what fit rather than ask the driver for absurd amounts of memory.
+            dev->vertex_capacity = NK_MIN(dev->vertex_capacity, (GLsizeiptr)NK_GLFW_MAX_STREAM_BUFFER);
+            dev->element_capacity = NK_MIN(dev->element_capacity, (GLsizeiptr)NK_GLFW_MAX_STREAM_BUFFER);
+            break;
+         }
+
+         glfw->stats.grow_count++;
+         nk_buffer_clear(&dev->cmds);
+      }
+
+      // Converting writes straight into the mapped buffers, the rest of the loop, packing included, is the upload.
+      draw_start = glfwGetTime();
+      glfw->stats.upload_ms = (float)((draw_start - upload_start) * 1000.0) - glfw->stats.convert_ms;
+
+      glfw->stats.vertex_count = glfw->ctx.draw_list.vertex_count;
+      glfw->stats.element_count = glfw->ctx.draw_list.element_count;
+      glfw->stats.vertex_bytes = (nk_size)glfw->stats.vertex_count * (nk_size)stride;
+      glfw->stats.vertex_buffer_size = (nk_size)vertex_size;
+      glfw->stats.element_buffer_size = (nk_size)element_size;
+      glfw->stats.index_overflow = sizeof(nk_draw_index) == 2 && glfw->stats.vertex_count > 0xFFFF;
+      glfw->stats.draw_count = 0;
+      glfw->stats.command_count = 0;
 
-      // Load draw vertices.
-      vertices = glMapBuffer(GL_ARRAY_BUFFER, GL_WRITE_ONLY);
-      elements = glMapBuffer(GL_ELEMENT_ARRAY_BUFFER, GL_WRITE_ONLY);
+      // Execute the draw commands, merging neighbours that share a texture and scissor.
       {
-         // Fill conversion config struct.
-         struct nk_convert_config config;
-         static const struct nk_draw_vertex_layout_element vertex_layout[] = {
-             {NK_VERTEX_POSITION, NK_FORMAT_FLOAT, NK_OFFSETOF(struct nk_glfw_vertex, position)},
-             {NK_VERTEX_TEXCOORD, NK_FORMAT_FLOAT, NK_OFFSETOF(struct nk_glfw_vertex, uv)},
-             {NK_VERTEX_COLOR, NK_FORMAT_R8G8B8A8, NK_OFFSETOF(struct nk_glfw_vertex, col)},
-             {NK_VERTEX_LAYOUT_END}
-         };
-         memset(&config, 0, sizeof(config));
-         config.vertex_layout = vertex_layout;
-         config.vertex_size = sizeof(struct nk_glfw_vertex);
-         config.vertex_alignment = NK_ALIGNOF(struct nk_glfw_vertex);
-         config.tex_null = dev->tex_null;
-         config.circle_segment_count = 22;
-         config.curve_segment_count = 22;
-         config.arc_segment_count = 22;
-         config.global_alpha = 1.0f;
-         config.shape_AA = AA;
-         config.line_AA = AA;
-
-         // Init buffers
-         nk_buffer_init_fixed(&vbuf, vertices, (size_t)max_vertex_buffer);
-         nk_buffer_init_fixed(&ebuf, elements, (size_t)max_element_buffer);
-         nk_convert(&glfw->ctx, &dev->cmds, &vbuf, &ebuf, &config);
+         struct nk_glfw_draw_batch batch;
+         struct nk_glfw_draw_state state;
+         memset(&batch, 0, sizeof(batch));
+         memset(&state, 0, sizeof(state));
+         state.program = ShaderProg.GetShaderProgram();
+         batch.offset = element_base;
+         timed = dev->gpu_timing && nk_glfw3_timer_begin(glfw);
+
+         nk_draw_foreach(cmd, &glfw->ctx, &dev->cmds)
+         {
+            GLint scissor[4];
+            if (!cmd->elem_count) continue;
+            glfw->stats.command_count++;
+
+            nk_glfw3_scissor(glfw, cmd->clip_rect, scissor);
+
+            // Elements of consecutive commands are contiguous, so a compatible command only extends the batch.
+            if (batch.count && batch.texture == (GLuint)cmd->texture.id &&
+               !memcmp(batch.scissor, scissor, sizeof(scissor)))
+            {
+               batch.count += (GLsizei)cmd->elem_count;
+            }
+            else
+            {
+               nk_glfw3_flush_batch(glfw, &state, &batch, base_vertex);
+               batch.offset = element_base + offset;
+               batch.count = (GLsizei)cmd->elem_count;
+               batch.texture = (GLuint)cmd->texture.id;
+               memcpy(batch.scissor, scissor, sizeof(scissor));
+            }
+
+            offset += cmd->elem_count * sizeof(nk_draw_index);
+         }
+
+         nk_glfw3_flush_batch(glfw, &state, &batch, base_vertex);
+         if (timed)
+            nk_glfw3_timer_end(dev);
       }
-      glUnmapBuffer(GL_ARRAY_BUFFER);
-      glUnmapBuffer(GL_ELEMENT_ARRAY_BUFFER);
+      glfw->stats.draw_ms = (float)((glfwGetTime() - draw_start) * 1000.0);
 
-      // Execute each draw command.
-      nk_draw_foreach(cmd, &glfw->ctx, &dev->cmds)
+      if (dev->stream_mode != NK_GLFW3_STREAM_ORPHAN)
       {
-         if (!cmd->elem_count) continue;
-         glBindTexture(GL_TEXTURE_2D, (GLuint)cmd->texture.id);
-         glScissor(
-            (GLint)(cmd->clip_rect.x * glfw->fb_scale.x),
-            (GLint)((glfw->height - (GLint)(cmd->clip_rect.y + cmd->clip_rect.h)) * glfw->fb_scale.y),
-            (GLint)(cmd->clip_rect.w * glfw->fb_scale.x),
-            (GLint)(cmd->clip_rect.h * glfw->fb_scale.y));
-         glDrawElements(GL_TRIANGLES, (GLsizei)cmd->elem_count, GL_UNSIGNED_SHORT, (const void*)offset);
-         offset += cmd->elem_count * sizeof(nk_draw_index);
+         // Guard the segment until the gpu has consumed it, then move on to the next one.
+         dev->stream_fences[frame] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+         dev->stream_frame = (frame + 1) % NK_GLFW_STREAM_FRAMES;
       }
       nk_clear(&glfw->ctx);
       nk_buffer_clear(&dev->cmds);
    }
 
-   /* default OpenGL state */
-   ShaderBase::Unbind();
-   glBindBuffer(GL_ARRAY_BUFFER, 0);
-   glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
-   glBindVertexArray(0);
-   glDisable(GL_BLEND);
+   nk_glfw3_reset_state();
+}
+
+/// <summary>
+/// (Re)creates the target's texture and framebuffer at the given size and leaves the framebuffer bound.
+/// </summary>
+NK_INTERN int
+nk_glfw3_render_target_bind(struct nk_glfw_device* dev, struct nk_glfw_render_target* target, int width, int height)
+{
+   if (target->framebuffer && target->owner == dev && target->width == width && target->height == height) {
+      glBindFramebuffer(GL_FRAMEBUFFER, target->framebuffer);
+      return nk_true;
+   }
+
+   /* a framebuffer of another window's context can only be deleted by that window */
+   if (target->owner == dev)
+      nk_glfw3_render_target_free(target);
+   else
+      nk_glfw3_render_target_release(target);
+
+   glGenTextures(1, &target->texture);
+   glBindTexture(GL_TEXTURE_2D, target->texture);
+   /* composited at the pixel size it was drawn at, filtering would only blur the text */
+   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+   glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+
+   glGenFramebuffers(1, &target->framebuffer);
+   glBindFramebuffer(GL_FRAMEBUFFER, target->framebuffer);
+   glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, target->texture, 0);
+   if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+      glBindFramebuffer(GL_FRAMEBUFFER, 0);
+      nk_glfw3_render_target_free(target);
+      return nk_false;
+   }
+
+   target->width = width;
+   target->height = height;
+   {
+      std::lock_guard<std::mutex> lock(RenderTargetMutex);
+      target->owner = dev;
+      target->next = dev->targets;
+      dev->targets = target;
+   }
+   return nk_true;
+}
+
+NK_API int
+nk_glfw3_render_commands(struct nk_glfw* glfw, struct nk_glfw_render_target* target,
+   nk_size begin, nk_size end, struct nk_rect area)
+{
+   struct nk_glfw_device* dev = &glfw->ogl;
+   const nk_byte* memory = (const nk_byte*)glfw->ctx.memory.memory.ptr;
+   const nk_size align = NK_ALIGNOF(struct nk_command);
+   struct nk_convert_config config;
+   struct nk_draw_list list;
+   struct nk_buffer cmds, vertices, elements;
+   const struct nk_draw_command* cmd;
+   struct nk_glfw_draw_batch batch;
+   struct nk_glfw_draw_state state;
+   GLfloat clear_color[4];
+   GLuint vao, buffers[2];
+   nk_size offset = (begin + align - 1) / align * align;
+   float tolerance;
+   int width = (int)(area.w * glfw->fb_scale.x + 0.5f);
+   int height = (int)(area.h * glfw->fb_scale.y + 0.5f);
+
+   if (!dev->vao || width <= 0 || height <= 0 || !nk_glfw3_render_target_bind(dev, target, width, height))
+      return nk_false;
+
+   /* same commands, same geometry as the frame would have had, fixed tessellation has no per command path here */
+   nk_glfw3_fill_convert_config(glfw, NK_ANTI_ALIASING_ON, &config);
+   tolerance = nk_glfw3_tessellation_tolerance(glfw);
+   if (tolerance <= 0.0f)
+      tolerance = NK_GLFW_TESSELLATION_TOLERANCE;
+
+   nk_buffer_init_default(&cmds);
+   nk_buffer_init_default(&vertices);
+   nk_buffer_init_default(&elements);
+   nk_draw_list_init(&list);
+   nk_draw_list_setup(&list, &config, &cmds, &vertices, &elements, config.line_AA, config.shape_AA);
+   while (offset < end)
+   {
+      const struct nk_command* command = (const struct nk_command*)(memory + offset);
+      nk_glfw3_convert_command(&list, command, tolerance);
+      offset = command->next;
+   }
+
+   if (!ShaderProg.GetShaderProgram())
+      nk_glfw3_load_program(&ShaderProg);
+   if (dev->font_sdf && !SdfShaderProg.GetShaderProgram())
+      nk_glfw3_load_program(&SdfShaderProg);
+
+   {
+      /* area.y lands on the first row, so the texture reads top down like every other nk_image */
+      Matrix44f projection(2.0f / area.w, 0.0f, 0.0f, 0.0f,
+                           0.0f, 2.0f / area.h, 0.0f, 0.0f,
+                           0.0f, 0.0f, -1.0f, 0.0f,
+                           -1.0f - 2.0f * area.x / area.w, -1.0f - 2.0f * area.y / area.h, 0.0f, 1.0f);
+      if (dev->font_sdf) {
+         ShaderBase::Bind(SdfShaderProg.GetShaderProgram());
+         SdfShaderProg.LoadProjection(projection);
+      }
+      ShaderBase::Bind(ShaderProg.GetShaderProgram());
+      ShaderProg.LoadProjection(projection);
+   }
+
+   /* the capture is rare, a throwaway float layout keeps the frame's ring and formats out of it */
+   glGenVertexArrays(1, &vao);
+   glGenBuffers(2, buffers);
+   glBindVertexArray(vao);
+   glBindBuffer(GL_ARRAY_BUFFER, buffers[0]);
+   glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffers[1]);
+   glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)vertices.allocated, nk_buffer_memory_const(&vertices), GL_STREAM_DRAW);
+   glBufferData(GL_ELEMENT_ARRAY_BUFFER, (GLsizeiptr)elements.allocated, nk_buffer_memory_const(&elements), GL_STREAM_DRAW);
+   glEnableVertexAttribArray((GLuint)dev->attrib_pos);
+   glEnableVertexAttribArray((GLuint)dev->attrib_uv);
+   glEnableVertexAttribArray((GLuint)dev->attrib_col);
+   glVertexAttribPointer((GLuint)dev->attrib_pos, 2, GL_FLOAT, GL_FALSE, sizeof(struct nk_glfw_vertex),
+      (void*)offsetof(struct nk_glfw_vertex, position));
+   glVertexAttribPointer((GLuint)dev->attrib_uv, 2, GL_FLOAT, GL_FALSE, sizeof(struct nk_glfw_vertex),
+      (void*)offsetof(struct nk_glfw_vertex, uv));
+   glVertexAttribPointer((GLuint)dev->attrib_col, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(struct nk_glfw_vertex),
+      (void*)offsetof(struct nk_glfw_vertex, col));
+
+   glViewport(0, 0, width, height);
+   glGetFloatv(GL_COLOR_CLEAR_VALUE, clear_color);
    glDisable(GL_SCISSOR_TEST);
+   glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+   glClear(GL_COLOR_BUFFER_BIT);
+   glClearColor(clear_color[0], clear_color[1], clear_color[2], clear_color[3]);
+
+   /* alpha accumulates as coverage and the colors end up premultiplied by it, which is how the target
+      composites later. Straight colors would need unpremultiplying first */
+   glEnable(GL_BLEND);
+   glBlendEquation(GL_FUNC_ADD);
+   glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+   glDisable(GL_CULL_FACE);
+   glDisable(GL_DEPTH_TEST);
+   glEnable(GL_SCISSOR_TEST);
+   glActiveTexture(GL_TEXTURE0);
+
+   memset(&batch, 0, sizeof(batch));
+   memset(&state, 0, sizeof(state));
+   state.program = ShaderProg.GetShaderProgram();
+   offset = 0;
+   nk_draw_list_foreach(cmd, &list, &cmds)
+   {
+      if (!cmd->elem_count) continue;
+
+      /* clip rects are in window units, the target's origin is the area's corner */
+      batch.texture = (GLuint)cmd->texture.id;
+      batch.scissor[0] = (GLint)((cmd->clip_rect.x - area.x) * glfw->fb_scale.x);
+      batch.scissor[1] = (GLint)((cmd->clip_rect.y - area.y) * glfw->fb_scale.y);
+      batch.scissor[2] = (GLint)NK_MAX(cmd->clip_rect.w * glfw->fb_scale.x, 0.0f);
+      batch.scissor[3] = (GLint)NK_MAX(cmd->clip_rect.h * glfw->fb_scale.y, 0.0f);
+      batch.offset = offset;
+      batch.count = (GLsizei)cmd->elem_count;
+      nk_glfw3_flush_batch(glfw, &state, &batch, 0);
+      offset += cmd->elem_count * sizeof(nk_draw_index);
+   }
+
+   glDeleteBuffers(2, buffers);
+   glDeleteVertexArrays(1, &vao);
+   glBindFramebuffer(GL_FRAMEBUFFER, 0);
+   glViewport(0, 0, (GLsizei)glfw->display_width, (GLsizei)glfw->display_height);
+   glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+   nk_glfw3_reset_state();
+
+   nk_buffer_free(&cmds);
+   nk_buffer_free(&vertices);
+   nk_buffer_free(&elements);
+   return nk_true;
 }
 
 NK_API void
@@ -258,6 +1951,12 @@ nk_glfw3_clipboard_copy(nk_handle usr, const char* text, int len)
 
 NK_API struct nk_context*
 nk_glfw3_init(struct nk_glfw* glfw, GLFWwindow* win, enum nk_glfw_init_state init_state)
+{
+   return nk_glfw3_init_shared(glfw, win, init_state, NULL);
+}
+
+NK_API struct nk_context*
+nk_glfw3_init_shared(struct nk_glfw* glfw, GLFWwindow* win, enum nk_glfw_init_state init_state, const struct nk_glfw* share)
 {
    glfwSetWindowUserPointer(win, glfw);
    glfw->win = win;
@@ -271,7 +1970,7 @@ nk_glfw3_init(struct nk_glfw* glfw, GLFWwindow* win, enum nk_glfw_init_state ini
    glfw->ctx.clip.paste = nk_glfw3_clipboard_paste;
    glfw->ctx.clip.userdata = nk_handle_ptr(&glfw);
    glfw->last_button_click = 0;
-   nk_glfw3_device_create(glfw);
+   nk_glfw3_device_create_shared(glfw, share);
 
    glfw->is_double_click_down = nk_false;
    glfw->double_click_pos = nk_vec2(0, 0);
@@ -279,6 +1978,21 @@ nk_glfw3_init(struct nk_glfw* glfw, GLFWwindow* win, enum nk_glfw_init_state ini
    return &glfw->ctx;
 }
 
+/// <summary>
+/// Sets up the nuklear side of the backend without a window or gl context. Input, fonts
+/// and drawing are left to the caller, nk_glfw3_render must not be used.
+/// </summary>
+NK_API struct nk_context*
+nk_glfw3_init_headless(struct nk_glfw* glfw)
+{
+   glfw->win = 0;
+   nk_init_default(&glfw->ctx, 0);
+   nk_buffer_init_default(&glfw->ogl.cmds);
+   glfw->is_double_click_down = nk_false;
+   glfw->double_click_pos = nk_vec2(0, 0);
+   return &glfw->ctx;
+}
+
 NK_API void
 nk_glfw3_font_stash_begin(struct nk_glfw* glfw, struct nk_font_atlas** atlas)
 {
@@ -287,80 +2001,475 @@ nk_glfw3_font_stash_begin(struct nk_glfw* glfw, struct nk_font_atlas** atlas)
    *atlas = &glfw->atlas;
 }
 
-NK_API void
-nk_glfw3_font_stash_end(struct nk_glfw* glfw)
+/* layout of a cached atlas, followed by font_count nk_baked_font, the cursors,
+ * glyph_count nk_font_glyph and the image */
+struct nk_glfw_atlas_cache_header {
+   int width, height;
+   int format;
+   int font_count;
+   int glyph_count;
+   struct nk_recti custom;
+};
+
+NK_INTERN nk_size
+nk_glfw3_atlas_image_size(int width, int height, enum nk_font_atlas_format fmt)
+{
+   return (nk_size)width * (nk_size)height * (fmt == NK_FONT_ATLAS_RGBA32 ? 4 : 1);
+}
+
+NK_INTERN uint64_t
+nk_glfw3_atlas_cache_key(const struct nk_font_atlas* atlas, enum nk_font_atlas_format fmt, int sdf)
+{
+   const struct nk_font_config* cfg;
+   wgui::CacheKey key;
+   key.Add(NK_GLFW_ATLAS_CACHE_VERSION).Add((int)fmt).Add(atlas->font_num)
+      .Add(sizeof(struct nk_font_glyph)).Add(sizeof(struct nk_baked_font));
+   if (sdf)
+      key.Add(NK_GLFW_SDF_PADDING).Add(NK_GLFW_SDF_ATLAS_WIDTH);
+
+   /* everything nk_font_atlas_bake reads from the configs, merged fonts included */
+   for (cfg = atlas->config; cfg; cfg = cfg->next) {
+      const struct nk_font_config* it = cfg;
+      do {
+         key.Add(it->ttf_blob, it->ttf_size);
+         key.Add(it->size).Add(it->oversample_h).Add(it->oversample_v).Add(it->pixel_snap)
+            .Add(it->merge_mode).Add(it->coord_type).Add(it->spacing).Add(it->fallback_glyph);
+         key.Add(it->range, sizeof(nk_rune) * (nk_size)(nk_range_count(it->range) * 2));
+      } while ((it = it->n) != cfg);
+   }
+   return key.Get();
+}
+
+NK_INTERN int
+nk_glfw3_atlas_restore(struct nk_font_atlas* atlas, enum nk_font_atlas_format fmt,
+   const nk_byte* data, nk_size size, const void** image)
+{
+   struct nk_glfw_atlas_cache_header header;
+   struct nk_font* font;
+   nk_size glyphs_size, expected;
+
+   if (size < sizeof(header)) return nk_false;
+   NK_MEMCPY(&header, data, sizeof(header));
+   if (header.format != (int)fmt || header.font_count != atlas->font_num ||
+       header.glyph_count <= 0 || header.width <= 0 || header.height <= 0)
+      return nk_false;
+
+   glyphs_size = sizeof(struct nk_font_glyph) * (nk_size)header.glyph_count;
+   expected = sizeof(header) + sizeof(struct nk_baked_font) * (nk_size)header.font_count +
+      sizeof(atlas->cursors) + glyphs_size + nk_glfw3_atlas_image_size(header.width, header.height, fmt);
+   if (size != expected) return nk_false;
+
+   atlas->glyphs = (struct nk_font_glyph*)atlas->permanent.alloc(atlas->permanent.userdata, 0, glyphs_size);
+   if (!atlas->glyphs) return nk_false;
+   atlas->glyph_count = header.glyph_count;
+   atlas->custom = header.custom;
+   atlas->tex_width = header.width;
+   atlas->tex_height = header.height;
+   data += sizeof(header);
+
+   /* same per font setup nk_font_atlas_bake does, from the stored metrics */
+   for (font = atlas->fonts; font; font = font->next) {
+      struct nk_font_config* config = font->config;
+      NK_MEMCPY(config->font, data, sizeof(struct nk_baked_font));
+      config->font->ranges = config->range;
+      data += sizeof(struct nk_baked_font);
+   }
+   NK_MEMCPY(atlas->cursors, data, sizeof(atlas->cursors));
+   data += sizeof(atlas->cursors);
+   NK_MEMCPY(atlas->glyphs, data, glyphs_size);
+   data += glyphs_size;
+
+   for (font = atlas->fonts; font; font = font->next) {
+      struct nk_font_config* config = font->config;
+      nk_font_init(font, config->size, config->fallback_glyph, atlas->glyphs,
+         config->font, nk_handle_ptr(0));
+   }
+   *image = data;
+   return nk_true;
+}
+
+NK_INTERN void
+nk_glfw3_atlas_store(const struct nk_font_atlas* atlas, enum nk_font_atlas_format fmt,
+   const char* cache_file, uint64_t key)
+{
+   struct nk_glfw_atlas_cache_header header;
+   struct nk_baked_font* baked;
+   const struct nk_font* font;
+   nk_size baked_size = sizeof(struct nk_baked_font) * (nk_size)atlas->font_num;
+   int i = 0;
+
+   baked = (struct nk_baked_font*)atlas->temporary.alloc(atlas->temporary.userdata, 0, baked_size);
+   if (!baked) return;
+   for (font = atlas->fonts; font; font = font->next)
+      baked[i++] = font->info;
+
+   nk_zero_struct(header);
+   header.width = atlas->tex_width;
+   header.height = atlas->tex_height;
+   header.format = (int)fmt;
+   header.font_count = atlas->font_num;
+   header.glyph_count = atlas->glyph_count;
+   header.custom = atlas->custom;
+
+   wgui::DiskCache::Store(cache_file, key, {
+      { &header, sizeof(header) },
+      { baked, baked_size },
+      { atlas->cursors, sizeof(atlas->cursors) },
+      { atlas->glyphs, sizeof(struct nk_font_glyph) * (nk_size)atlas->glyph_count },
+      { atlas->pixel, nk_glfw3_atlas_image_size(atlas->tex_width, atlas->tex_height, fmt) } });
+   atlas->temporary.free(atlas->temporary.userdata, baked);
+}
+
+/* One glyph's distance field while the atlas is being packed. */
+struct nk_glfw_sdf_glyph {
+   unsigned char* bitmap;
+   int w, h, xoff, yoff;
+   int x, y;
+};
+
+/// <summary>
+/// Bakes every glyph of the atlas' configs as a signed distance field into an ALPHA8 image.
+/// Glyphs are laid out in the order nk_font_find_glyph expects and described at each font's
+/// configured size, nuklear scales the metrics to whatever height the font handle asks for.
+/// The edge sits at 128 and the field falls off over NK_GLFW_SDF_PADDING texels.
+/// </summary>
+NK_INTERN const void*
+nk_glfw3_sdf_bake(struct nk_font_atlas* atlas, int* width, int* height)
+{
+   struct nk_font_config* cfg;
+   struct nk_glfw_sdf_glyph* sdf = 0;
+   struct nk_font* font;
+   int glyph_n = 0, i;
+   int pen_x, pen_y, row_h;
+   nk_size sdf_size;
+
+#ifdef NK_INCLUDE_DEFAULT_FONT
+   if (!atlas->font_num)
+      atlas->default_font = nk_font_atlas_add_default(atlas, 13.0f, 0);
+#endif
+   if (!atlas->font_num) return 0;
+
+   /* count glyphs over every config, merged ones included */
+   atlas->glyph_count = 0;
+   for (cfg = atlas->config; cfg; cfg = cfg->next) {
+      struct nk_font_config* it = cfg;
+      do {
+         const nk_rune* range;
+         for (range = it->range; range[0] && range[1]; range += 2)
+            atlas->glyph_count += (int)(range[1] - range[0]) + 1;
+      } while ((it = it->n) != cfg);
+   }
+
+   sdf_size = sizeof(struct nk_glfw_sdf_glyph) * (nk_size)atlas->glyph_count;
+   sdf = (struct nk_glfw_sdf_glyph*)atlas->temporary.alloc(atlas->temporary.userdata, 0, sdf_size);
+   atlas->glyphs = (struct nk_font_glyph*)atlas->permanent.alloc(atlas->permanent.userdata, 0,
+      sizeof(struct nk_font_glyph) * (nk_size)atlas->glyph_count);
+   if (!sdf || !atlas->glyphs) goto failed;
+   NK_MEMSET(sdf, 0, sdf_size);
+
+   /* the custom rect (white texel and cursors) goes first, glyphs follow on shelves */
+   atlas->custom.x = 0;
+   atlas->custom.y = 0;
+   atlas->custom.w = (NK_CURSOR_DATA_W * 2) + 1;
+   atlas->custom.h = NK_CURSOR_DATA_H + 1;
+   pen_x = atlas->custom.w + 1;
+   pen_y = 0;
+   row_h = atlas->custom.h;
+
+   for (cfg = atlas->config; cfg; cfg = cfg->next) {
+      struct nk_font_config* it = cfg;
+      do {
+         stbtt_fontinfo info;
+         const nk_rune* range;
+         struct nk_baked_font* dst_font = it->font;
+         const unsigned char* ttf = (const unsigned char*)it->ttf_blob;
+         float scale;
+         int ascent, descent, line_gap;
+
+         if (!stbtt_InitFont(&info, ttf, stbtt_GetFontOffsetForIndex(ttf, 0))) goto failed;
+         info.userdata = &atlas->temporary;
+         scale = stbtt_ScaleForPixelHeight(&info, it->size);
+         stbtt_GetFontVMetrics(&info, &ascent, &descent, &line_gap);
+
+         if (!it->merge_mode) {
+            dst_font->ranges = it->range;
+            dst_font->height = it->size;
+            dst_font->ascent = (float)ascent * scale;
+            dst_font->descent = (float)descent * scale;
+            dst_font->glyph_offset = (nk_rune)glyph_n;
+            dst_font->glyph_count = 0;
+         }
+
+         for (range = it->range; range[0] && range[1]; range += 2) {
+            nk_rune codepoint;
+            for (codepoint = range[0]; codepoint <= range[1]; ++codepoint) {
+               struct nk_glfw_sdf_glyph* g = &sdf[glyph_n];
+               struct nk_font_glyph* glyph = &atlas->glyphs[glyph_n++];
+               int advance, lsb;
+
+               g->bitmap = stbtt_GetCodepointSDF(&info, scale, (int)codepoint, NK_GLFW_SDF_PADDING,
+                  128, 128.0f / NK_GLFW_SDF_PADDING, &g->w, &g->h, &g->xoff, &g->yoff);
+               if (!g->bitmap) g->w = g->h = 0;
+
+               if (g->w) {
+                  if (pen_x + g->w > NK_GLFW_SDF_ATLAS_WIDTH) {
+                     pen_x = 0;
+                     pen_y += row_h + 1;
+                     row_h = 0;
+                  }
+                  g->x = pen_x;
+                  g->y = pen_y;
+                  pen_x += g->w + 1;
+                  row_h = NK_MAX(row_h, g->h);
+               }
+
+               stbtt_GetCodepointHMetrics(&info, (int)codepoint, &advance, &lsb);
+               glyph->codepoint = codepoint;
+               glyph->x0 = (float)g->xoff;
+               glyph->y0 = (float)g->yoff + (dst_font->ascent + 0.5f);
+               glyph->x1 = glyph->x0 + (float)g->w;
+               glyph->y1 = glyph->y0 + (float)g->h;
+               glyph->w = (float)g->w;
+               glyph->h = (float)g->h;
+               glyph->xadvance = (float)advance * scale + it->spacing.x;
+               if (it->pixel_snap)
+                  glyph->xadvance = (float)(int)(glyph->xadvance + 0.5f);
+               dst_font->glyph_count++;
+            }
+         }
+      } while ((it = it->n) != cfg);
+   }
+
+   *width = NK_GLFW_SDF_ATLAS_WIDTH;
+   *height = pen_y + row_h + 1;
+   atlas->pixel = atlas->temporary.alloc(atlas->temporary.userdata, 0, (nk_size)(*width * *height));
+   if (!atlas->pixel) goto failed;
+   NK_MEMSET(atlas->pixel, 0, (nk_size)(*width * *height));
+
+   for (i = 0; i < atlas->glyph_count; ++i) {
+      struct nk_glfw_sdf_glyph* g = &sdf[i];
+      struct nk_font_glyph* glyph = &atlas->glyphs[i];
+      int row;
+      for (row = 0; row < g->h; ++row)
+         NK_MEMCPY((nk_byte*)atlas->pixel + (nk_size)(g->y + row) * (nk_size)*width + g->x,
+            g->bitmap + (nk_size)row * (nk_size)g->w, (nk_size)g->w);
+
+      glyph->u0 = (float)g->x / (float)*width;
+      glyph->v0 = (float)g->y / (float)*height;
+      glyph->u1 = (float)(g->x + g->w) / (float)*width;
+      glyph->v1 = (float)(g->y + g->h) / (float)*height;
+      if (g->bitmap) stbtt_FreeSDF(g->bitmap, &atlas->temporary);
+      g->bitmap = 0;
+   }
+
+   /* fully inside for the white texel, the cursors come out as hard edged shapes */
+   nk_font_bake_custom_data(atlas->pixel, *width, *height, atlas->custom,
+      nk_custom_cursor_data, NK_CURSOR_DATA_W, NK_CURSOR_DATA_H, '.', 'X');
+   atlas->tex_width = *width;
+   atlas->tex_height = *height;
+
+   for (font = atlas->fonts; font; font = font->next) {
+      struct nk_font_config* config = font->config;
+      nk_font_init(font, config->size, config->fallback_glyph, atlas->glyphs,
+         config->font, nk_handle_ptr(0));
+   }
+   NK_MEMSET(atlas->cursors, 0, sizeof(atlas->cursors));
+   atlas->temporary.free(atlas->temporary.userdata, sdf);
+   return atlas->pixel;
+
+failed:
+   if (sdf) {
+      for (i = 0; i < atlas->glyph_count; ++i)
+         if (sdf[i].bitmap) stbtt_FreeSDF(sdf[i].bitmap, &atlas->temporary);
+      atlas->temporary.free(atlas->temporary.userdata, sdf);
+   }
+   if (atlas->glyphs) {
+      atlas->permanent.free(atlas->permanent.userdata, atlas->glyphs);
+      atlas->glyphs = 0;
+   }
+   return 0;
+}
+
+NK_INTERN enum nk_glfw_atlas_source
+nk_glfw3_atlas_bake(struct nk_font_atlas* atlas, enum nk_font_atlas_format fmt, int sdf,
+   const char* cache_file, nk_glfw_atlas_upload upload, void* userdata)
+{
+   const void* image;
+   int w, h;
+   uint64_t key = 0;
+   int use_cache = cache_file && *cache_file && atlas->font_num > 0;
+
+   if (use_cache) {
+      wgui::MappedFile file;
+      size_t size;
+      const uint8_t* data;
+
+      key = nk_glfw3_atlas_cache_key(atlas, fmt, sdf);
+      data = wgui::DiskCache::Load(cache_file, key, file, size);
+      if (data && nk_glfw3_atlas_restore(atlas, fmt, data, size, &image)) {
+         /* the image is uploaded straight out of the mapping */
+         upload(userdata, image, atlas->tex_width, atlas->tex_height);
+         return NK_GLFW_ATLAS_CACHED;
+      }
+   }
+
+   image = sdf ? nk_glfw3_sdf_bake(atlas, &w, &h) : nk_font_atlas_bake(atlas, &w, &h, fmt);
+   if (!image) return NK_GLFW_ATLAS_FAILED;
+   if (use_cache)
+      nk_glfw3_atlas_store(atlas, fmt, cache_file, key);
+   upload(userdata, image, w, h);
+   return NK_GLFW_ATLAS_BAKED;
+}
+
+NK_API enum nk_glfw_atlas_source
+nk_glfw3_font_atlas_bake_cached(struct nk_font_atlas* atlas, enum nk_font_atlas_format fmt,
+   const char* cache_file, nk_glfw_atlas_upload upload, void* userdata)
+{
+   return nk_glfw3_atlas_bake(atlas, fmt, nk_false, cache_file, upload, userdata);
+}
+
+NK_API enum nk_glfw_atlas_source
+nk_glfw3_font_atlas_bake_sdf(struct nk_font_atlas* atlas, const char* cache_file,
+   nk_glfw_atlas_upload upload, void* userdata)
+{
+   return nk_glfw3_atlas_bake(atlas, NK_FONT_ATLAS_ALPHA8, nk_true, cache_file, upload, userdata);
+}
+
+NK_INTERN void
+nk_glfw3_font_stash_upload(void* userdata, const void* image, int width, int height)
+{
+   nk_glfw3_device_upload_atlas((struct nk_glfw*)userdata, image, width, height);
+}
+
+NK_API enum nk_glfw_atlas_source
+nk_glfw3_font_stash_end_cached(struct nk_glfw* glfw, const char* cache_file)
 {
-   const void* image; int w, h;
-   image = nk_font_atlas_bake(&glfw->atlas, &w, &h, NK_FONT_ATLAS_RGBA32);
-   nk_glfw3_device_upload_atlas(glfw, image, w, h);
+   enum nk_glfw_atlas_source source = nk_glfw3_font_atlas_bake_cached(&glfw->atlas,
+      glfw->ogl.atlas_format, cache_file, nk_glfw3_font_stash_upload, glfw);
    nk_font_atlas_end(&glfw->atlas, nk_handle_id((int)glfw->ogl.font_tex), &glfw->ogl.tex_null);
+   nk_glfw3_invalidate_frame(glfw);
    if (glfw->atlas.default_font)
       nk_style_set_font(&glfw->ctx, &glfw->atlas.default_font->handle);
+   return source;
+}
+
+NK_API void
+nk_glfw3_font_stash_end(struct nk_glfw* glfw)
+{
+   nk_glfw3_font_stash_end_cached(glfw, NULL);
 }
 
 NK_API void
 nk_glfw3_new_frame(struct nk_glfw* glfw)
+{
+   nk_glfw3_apply_input(glfw, nk_glfw3_capture_input(glfw));
+}
+
+/// <summary>
+/// Reads the window's size, keys, mouse and the text and scrolling the callbacks collected.
+/// Must be called on the main thread. The returned capture lives in glfw and is overwritten
+/// by the next call.
+/// </summary>
+NK_API const struct nk_glfw_input*
+nk_glfw3_capture_input(struct nk_glfw* glfw)
 {
    int i;
-   double x, y;
-   struct nk_context* ctx = &glfw->ctx;
+   struct nk_glfw_input* in = &glfw->input;
    struct GLFWwindow* win = glfw->win;
 
-   glfwGetWindowSize(win, &glfw->width, &glfw->height);
-   glfwGetFramebufferSize(win, &glfw->display_width, &glfw->display_height);
-   glfw->fb_scale.x = (float)glfw->display_width / (float)glfw->width;
-   glfw->fb_scale.y = (float)glfw->display_height / (float)glfw->height;
+   glfwGetWindowSize(win, &in->width, &in->height);
+   glfwGetFramebufferSize(win, &in->display_width, &in->display_height);
+   glfwGetWindowContentScale(win, &in->content_scale_x, &in->content_scale_y);
 
-   nk_input_begin(ctx);
    for (i = 0; i < glfw->text_len; ++i)
-      nk_input_unicode(ctx, glfw->text[i]);
+      in->text[i] = glfw->text[i];
+   in->text_len = glfw->text_len;
 
 #ifdef NK_GLFW_GL3_MOUSE_GRABBING
    /* optional grabbing behavior */
-   if (ctx->input.mouse.grab)
-      glfwSetInputMode(glfw.win, GLFW_CURSOR, GLFW_CURSOR_HIDDEN);
-   else if (ctx->input.mouse.ungrab)
+   if (glfw->ctx.input.mouse.grab)
+      glfwSetInputMode(glfw->win, GLFW_CURSOR, GLFW_CURSOR_HIDDEN);
+   else if (glfw->ctx.input.mouse.ungrab)
       glfwSetInputMode(glfw->win, GLFW_CURSOR, GLFW_CURSOR_NORMAL);
 #endif
 
-   nk_input_key(ctx, NK_KEY_DEL, glfwGetKey(win, GLFW_KEY_DELETE) == GLFW_PRESS);
-   nk_input_key(ctx, NK_KEY_ENTER, glfwGetKey(win, GLFW_KEY_ENTER) == GLFW_PRESS);
-   nk_input_key(ctx, NK_KEY_TAB, glfwGetKey(win, GLFW_KEY_TAB) == GLFW_PRESS);
-   nk_input_key(ctx, NK_KEY_BACKSPACE, glfwGetKey(win, GLFW_KEY_BACKSPACE) == GLFW_PRESS);
-   nk_input_key(ctx, NK_KEY_UP, glfwGetKey(win, GLFW_KEY_UP) == GLFW_PRESS);
-   nk_input_key(ctx, NK_KEY_DOWN, glfwGetKey(win, GLFW_KEY_DOWN) == GLFW_PRESS);
-   nk_input_key(ctx, NK_KEY_TEXT_START, glfwGetKey(win, GLFW_KEY_HOME) == GLFW_PRESS);
-   nk_input_key(ctx, NK_KEY_TEXT_END, glfwGetKey(win, GLFW_KEY_END) == GLFW_PRESS);
-   nk_input_key(ctx, NK_KEY_SCROLL_START, glfwGetKey(win, GLFW_KEY_HOME) == GLFW_PRESS);
-   nk_input_key(ctx, NK_KEY_SCROLL_END, glfwGetKey(win, GLFW_KEY_END) == GLFW_PRESS);
-   nk_input_key(ctx, NK_KEY_SCROLL_DOWN, glfwGetKey(win, GLFW_KEY_PAGE_DOWN) == GLFW_PRESS);
-   nk_input_key(ctx, NK_KEY_SCROLL_UP, glfwGetKey(win, GLFW_KEY_PAGE_UP) == GLFW_PRESS);
-   nk_input_key(ctx, NK_KEY_SHIFT, glfwGetKey(win, GLFW_KEY_LEFT_SHIFT) == GLFW_PRESS ||
-      glfwGetKey(win, GLFW_KEY_RIGHT_SHIFT) == GLFW_PRESS);
+   in->keys[NK_KEY_DEL] = glfwGetKey(win, GLFW_KEY_DELETE) == GLFW_PRESS;
+   in->keys[NK_KEY_ENTER] = glfwGetKey(win, GLFW_KEY_ENTER) == GLFW_PRESS;
+   in->keys[NK_KEY_TAB] = glfwGetKey(win, GLFW_KEY_TAB) == GLFW_PRESS;
+   in->keys[NK_KEY_BACKSPACE] = glfwGetKey(win, GLFW_KEY_BACKSPACE) == GLFW_PRESS;
+   in->keys[NK_KEY_UP] = glfwGetKey(win, GLFW_KEY_UP) == GLFW_PRESS;
+   in->keys[NK_KEY_DOWN] = glfwGetKey(win, GLFW_KEY_DOWN) == GLFW_PRESS;
+   in->keys[NK_KEY_TEXT_START] = glfwGetKey(win, GLFW_KEY_HOME) == GLFW_PRESS;
+   in->keys[NK_KEY_TEXT_END] = glfwGetKey(win, GLFW_KEY_END) == GLFW_PRESS;
+   in->keys[NK_KEY_SCROLL_START] = glfwGetKey(win, GLFW_KEY_HOME) == GLFW_PRESS;
+   in->keys[NK_KEY_SCROLL_END] = glfwGetKey(win, GLFW_KEY_END) == GLFW_PRESS;
+   in->keys[NK_KEY_SCROLL_DOWN] = glfwGetKey(win, GLFW_KEY_PAGE_DOWN) == GLFW_PRESS;
+   in->keys[NK_KEY_SCROLL_UP] = glfwGetKey(win, GLFW_KEY_PAGE_UP) == GLFW_PRESS;
+   in->keys[NK_KEY_SHIFT] = glfwGetKey(win, GLFW_KEY_LEFT_SHIFT) == GLFW_PRESS ||
+      glfwGetKey(win, GLFW_KEY_RIGHT_SHIFT) == GLFW_PRESS;
 
    if (glfwGetKey(win, GLFW_KEY_LEFT_CONTROL) == GLFW_PRESS ||
       glfwGetKey(win, GLFW_KEY_RIGHT_CONTROL) == GLFW_PRESS) {
-      nk_input_key(ctx, NK_KEY_COPY, glfwGetKey(win, GLFW_KEY_C) == GLFW_PRESS);
-      nk_input_key(ctx, NK_KEY_PASTE, glfwGetKey(win, GLFW_KEY_V) == GLFW_PRESS);
-      nk_input_key(ctx, NK_KEY_CUT, glfwGetKey(win, GLFW_KEY_X) == GLFW_PRESS);
-      nk_input_key(ctx, NK_KEY_TEXT_UNDO, glfwGetKey(win, GLFW_KEY_Z) == GLFW_PRESS);
-      nk_input_key(ctx, NK_KEY_TEXT_REDO, glfwGetKey(win, GLFW_KEY_R) == GLFW_PRESS);
-      nk_input_key(ctx, NK_KEY_TEXT_WORD_LEFT, glfwGetKey(win, GLFW_KEY_LEFT) == GLFW_PRESS);
-      nk_input_key(ctx, NK_KEY_TEXT_WORD_RIGHT, glfwGetKey(win, GLFW_KEY_RIGHT) == GLFW_PRESS);
-      nk_input_key(ctx, NK_KEY_TEXT_LINE_START, glfwGetKey(win, GLFW_KEY_B) == GLFW_PRESS);
-      nk_input_key(ctx, NK_KEY_TEXT_LINE_END, glfwGetKey(win, GLFW_KEY_E) == GLFW_PRESS);
+      in->keys[NK_KEY_COPY] = glfwGetKey(win, GLFW_KEY_C) == GLFW_PRESS;
+      in->keys[NK_KEY_PASTE] = glfwGetKey(win, GLFW_KEY_V) == GLFW_PRESS;
+      in->keys[NK_KEY_CUT] = glfwGetKey(win, GLFW_KEY_X) == GLFW_PRESS;
+      in->keys[NK_KEY_TEXT_UNDO] = glfwGetKey(win, GLFW_KEY_Z) == GLFW_PRESS;
+      in->keys[NK_KEY_TEXT_REDO] = glfwGetKey(win, GLFW_KEY_R) == GLFW_PRESS;
+      in->keys[NK_KEY_TEXT_WORD_LEFT] = glfwGetKey(win, GLFW_KEY_LEFT) == GLFW_PRESS;
+      in->keys[NK_KEY_TEXT_WORD_RIGHT] = glfwGetKey(win, GLFW_KEY_RIGHT) == GLFW_PRESS;
+      in->keys[NK_KEY_TEXT_LINE_START] = glfwGetKey(win, GLFW_KEY_B) == GLFW_PRESS;
+      in->keys[NK_KEY_TEXT_LINE_END] = glfwGetKey(win, GLFW_KEY_E) == GLFW_PRESS;
    }
    else {
-      nk_input_key(ctx, NK_KEY_LEFT, glfwGetKey(win, GLFW_KEY_LEFT) == GLFW_PRESS);
-      nk_input_key(ctx, NK_KEY_RIGHT, glfwGetKey(win, GLFW_KEY_RIGHT) == GLFW_PRESS);
-      nk_input_key(ctx, NK_KEY_COPY, 0);
-      nk_input_key(ctx, NK_KEY_PASTE, 0);
-      nk_input_key(ctx, NK_KEY_CUT, 0);
-      nk_input_key(ctx, NK_KEY_SHIFT, 0);
+      in->keys[NK_KEY_LEFT] = glfwGetKey(win, GLFW_KEY_LEFT) == GLFW_PRESS;
+      in->keys[NK_KEY_RIGHT] = glfwGetKey(win, GLFW_KEY_RIGHT) == GLFW_PRESS;
+      in->keys[NK_KEY_COPY] = 0;
+      in->keys[NK_KEY_PASTE] = 0;
+      in->keys[NK_KEY_CUT] = 0;
+      in->keys[NK_KEY_SHIFT] = 0;
    }
 
-   glfwGetCursorPos(win, &x, &y);
-   nk_input_motion(ctx, (int)x, (int)y);
+   glfwGetCursorPos(win, &in->mouse_x, &in->mouse_y);
+   in->buttons[NK_BUTTON_LEFT] = glfwGetMouseButton(win, GLFW_MOUSE_BUTTON_LEFT) == GLFW_PRESS;
+   in->buttons[NK_BUTTON_MIDDLE] = glfwGetMouseButton(win, GLFW_MOUSE_BUTTON_MIDDLE) == GLFW_PRESS;
+   in->buttons[NK_BUTTON_RIGHT] = glfwGetMouseButton(win, GLFW_MOUSE_BUTTON_RIGHT) == GLFW_PRESS;
+   in->buttons[NK_BUTTON_DOUBLE] = glfw->is_double_click_down;
+   in->double_click_pos = glfw->double_click_pos;
+   in->scroll = glfw->scroll;
+
+   glfw->text_len = 0;
+   glfw->scroll = nk_vec2(0, 0);
+   return in;
+}
+
+/// <summary>
+/// Feeds a capture to nuklear as the input of the next frame. Touches no glfw state,
+/// so it can run on the thread that lays out and draws the window.
+/// </summary>
+NK_API void
+nk_glfw3_apply_input(struct nk_glfw* glfw, const struct nk_glfw_input* in)
+{
+   int i;
+   int x = (int)in->mouse_x;
+   int y = (int)in->mouse_y;
+   struct nk_context* ctx = &glfw->ctx;
+
+   glfw->width = in->width;
+   glfw->height = in->height;
+   glfw->display_width = in->display_width;
+   glfw->display_height = in->display_height;
+   glfw->fb_scale.x = (float)glfw->display_width / (float)glfw->width;
+   glfw->fb_scale.y = (float)glfw->display_height / (float)glfw->height;
+
+   nk_input_begin(ctx);
+   for (i = 0; i < in->text_len; ++i)
+      nk_input_unicode(ctx, in->text[i]);
+
+   /* keys that were never captured stay up, nk_input_key ignores calls that don't change a key */
+   for (i = 0; i < NK_KEY_MAX; ++i)
+      nk_input_key(ctx, (enum nk_keys)i, in->keys[i]);
+
+   nk_input_motion(ctx, x, y);
 #ifdef NK_GLFW_GL3_MOUSE_GRABBING
    if (ctx->input.mouse.grabbed) {
       glfwSetCursorPos(glfw->win, ctx->input.mouse.prev.x, ctx->input.mouse.prev.y);
@@ -368,20 +2477,79 @@ nk_glfw3_new_frame(struct nk_glfw* glfw)
       ctx->input.mouse.pos.y = ctx->input.mouse.prev.y;
    }
 #endif
-   nk_input_button(ctx, NK_BUTTON_LEFT, (int)x, (int)y, glfwGetMouseButton(win, GLFW_MOUSE_BUTTON_LEFT) == GLFW_PRESS);
-   nk_input_button(ctx, NK_BUTTON_MIDDLE, (int)x, (int)y, glfwGetMouseButton(win, GLFW_MOUSE_BUTTON_MIDDLE) == GLFW_PRESS);
-   nk_input_button(ctx, NK_BUTTON_RIGHT, (int)x, (int)y, glfwGetMouseButton(win, GLFW_MOUSE_BUTTON_RIGHT) == GLFW_PRESS);
-   nk_input_button(ctx, NK_BUTTON_DOUBLE, (int)glfw->double_click_pos.x, (int)glfw->double_click_pos.y, glfw->is_double_click_down);
-   nk_input_scroll(ctx, glfw->scroll);
+   nk_input_button(ctx, NK_BUTTON_LEFT, x, y, in->buttons[NK_BUTTON_LEFT]);
+   nk_input_button(ctx, NK_BUTTON_MIDDLE, x, y, in->buttons[NK_BUTTON_MIDDLE]);
+   nk_input_button(ctx, NK_BUTTON_RIGHT, x, y, in->buttons[NK_BUTTON_RIGHT]);
+   nk_input_button(ctx, NK_BUTTON_DOUBLE, (int)in->double_click_pos.x, (int)in->double_click_pos.y,
+      in->buttons[NK_BUTTON_DOUBLE]);
+   nk_input_scroll(ctx, in->scroll);
    nk_input_end(&glfw->ctx);
-   glfw->text_len = 0;
-   glfw->scroll = nk_vec2(0, 0);
+}
+
+/// <summary>
+/// Combines two captures when the thread drawing the window fell behind the main thread.
+/// Sizes and positions come from the newer one, a key or button held in either counts as
+/// held so a quick click isn't lost, and text and scrolling accumulate.
+/// </summary>
+NK_API void
+nk_glfw3_merge_input(struct nk_glfw_input* pending, const struct nk_glfw_input* in)
+{
+   int i;
+   int keys[NK_KEY_MAX];
+   int buttons[NK_BUTTON_MAX];
+   unsigned int text[NK_GLFW_TEXT_MAX];
+   int text_len = pending->text_len;
+   struct nk_vec2 scroll = pending->scroll;
+
+   for (i = 0; i < NK_KEY_MAX; ++i)
+      keys[i] = pending->keys[i] || in->keys[i];
+   for (i = 0; i < NK_BUTTON_MAX; ++i)
+      buttons[i] = pending->buttons[i] || in->buttons[i];
+   NK_MEMCPY(text, pending->text, sizeof(text));
+
+   *pending = *in;
+   NK_MEMCPY(pending->keys, keys, sizeof(keys));
+   NK_MEMCPY(pending->buttons, buttons, sizeof(buttons));
+   NK_MEMCPY(pending->text, text, sizeof(text));
+   pending->text_len = text_len;
+   for (i = 0; i < in->text_len && pending->text_len < NK_GLFW_TEXT_MAX; ++i)
+      pending->text[pending->text_len++] = in->text[i];
+   pending->scroll.x = scroll.x + in->scroll.x;
+   pending->scroll.y = scroll.y + in->scroll.y;
+}
+
+/// <summary>
+/// Returns whether the input gathered by the last nk_glfw3_new_frame has anything the
+/// user did: motion, scrolling, text or any key or button held or clicked.
+/// </summary>
+NK_API int
+nk_glfw3_input_active(const struct nk_glfw* glfw)
+{
+   int i;
+   const struct nk_input* in = &glfw->ctx.input;
+
+   if (in->mouse.delta.x != 0 || in->mouse.delta.y != 0 ||
+      in->mouse.scroll_delta.x != 0 || in->mouse.scroll_delta.y != 0 ||
+      in->keyboard.text_len)
+      return nk_true;
+
+   for (i = 0; i < NK_BUTTON_MAX; ++i)
+      if (in->mouse.buttons[i].down || in->mouse.buttons[i].clicked)
+         return nk_true;
+
+   for (i = 0; i < NK_KEY_MAX; ++i)
+      if (in->keyboard.keys[i].down || in->keyboard.keys[i].clicked)
+         return nk_true;
+
+   return nk_false;
 }
 
 NK_API
 void nk_glfw3_shutdown(struct nk_glfw* glfw)
 {
-   nk_font_atlas_clear(&glfw->atlas);
+   /* windows sharing another window's font never start an atlas */
+   if (glfw->atlas.permanent.alloc)
+      nk_font_atlas_clear(&glfw->atlas);
    nk_free(&glfw->ctx);
    nk_glfw3_device_destroy(glfw);
    memset(glfw, 0, sizeof(*glfw));
@@ -1,5 +1,7 @@
+#include <atomic>
 #include <cassert>
 #include <functional>
+#include <cstdio>
 
 #include "Window.h"
 #include "NuklearWindowRenderer.h"
@@ -13,6 +15,58 @@ namespace
 {
    using namespace wgui;
 
+   /// <summary>
+   /// Whether the mouse does more than hover over the bounds this frame. Clicks on them, drags that started on
+   /// them and scrolling over them change state nuklear keeps for itself, so a picture taken before can't be trusted.
+   /// </summary>
+   bool MouseInteracting(const nk_context* context, const struct nk_rect& bounds)
+   {
+      const nk_input& input = context->input;
+      bool hovering = nk_input_is_mouse_hovering_rect(&input, bounds);
+      for (int button = 0; button < NK_BUTTON_MAX; button++)
+      {
+         const nk_mouse_button& state = input.mouse.buttons[button];
+         if ((state.down || state.clicked) &&
+            (hovering || nk_input_has_mouse_click_in_rect(&input, static_cast<nk_buttons>(button), bounds)))
+         {
+            return true;
+         }
+      }
+
+      return hovering && (input.mouse.scroll_delta.x != 0 || input.mouse.scroll_delta.y != 0);
+   }
+
+   /// <summary>
+   /// Whether typing or an open popup has the focus. Neither has bounds to test, so nothing is captured while
+   /// they last, but pictures taken before stay good.
+   /// </summary>
+   bool FocusInteracting(const nk_context* context)
+   {
+      const nk_window* current = context->current;
+      return context->input.keyboard.text_len > 0 || (current && (current->popup.active || current->edit.active));
+   }
+
+   // Drawn in place of an image that is still decoding or failed to load.
+   static constexpr nk_symbol_type ImagePlaceholder = NK_SYMBOL_RECT_OUTLINE;
+
+   /// <summary>
+   /// The image at the path if it is in the window's atlas, otherwise null and its load is under way.
+   /// Only the first frame with a path or atlas goes through the atlas' lock, the request keeps the image after.
+   /// </summary>
+   const struct nk_image* GetResidentImage(WindowBase* window, const std::string& path, ImageRequest& request)
+   {
+      ImageAtlas* atlas = window->GetImageAtlas();
+      if (request.Atlas != atlas || request.Path != path)
+      {
+         request.Atlas = atlas;
+         request.Path = path;
+         request.Image = atlas ? atlas->Request(path) : nullptr;
+      }
+
+      AtlasImage* image = request.Image;
+      return image && image->IsResident() ? &image->GetImage() : nullptr;
+   }
+
    nk_flags WinFlagsToNkWinFlags(int winFlags)
    {
       nk_flags result = 0;
@@ -72,22 +126,81 @@ namespace wgui
       RegisterControl<GuiProgressBar>();
       RegisterControl<GuiInputInt>();
       RegisterControl<GuiInputReal>();
+      RegisterControl<GuiPerfOverlay>();
    }
 
-   void ControlTreeIterator::BuildPath()
+   ControlTreeIterator& ControlTreeIterator::operator++()
    {
-      mPath.push({ {}, 0, 0 });
-
-      if (!mCurrent)
+      // Below the stored path the walk goes down the first children and back up through the parent links.
+      if (mOverflow > 0)
       {
-         return;
+         if (mCurrent->GetChildCount() > 0)
+         {
+            mCurrent = mCurrent->GetChild(0);
+            mOverflow++;
+            return *this;
+         }
+
+         while (mOverflow > 1)
+         {
+            GuiControlBase* parent = mCurrent->GetParent();
+            if (parent == nullptr)
+            {
+               static std::atomic<bool> logged = false;
+               if (!logged.exchange(true))
+               {
+                  Application::Logger.error("Control tree deeper than {int} without parent links, skipping the rest of it",
+                     MaxDepth);
+               }
+
+               break;
+            }
+
+            size_t count = parent->GetChildCount();
+            size_t next = 0;
+            while (next < count && parent->GetChild(next) != mCurrent)
+            {
+               next++;
+            }
+
+            if (++next < count)
+            {
+               mCurrent = parent->GetChild(next);
+               return *this;
+            }
+
+            mCurrent = parent;
+            mOverflow--;
+         }
+
+         // Back at a child of the deepest stored control, the path knows its next sibling.
+         mOverflow = 0;
       }
 
-      mCurrent->ForEachChild([&](GuiControlBase* child, int childIndex) 
+      while (mDepth > 0)
       {
-         mPath.top().Children.push_back(child);
-         mPath.top().ChildrenCount++;
-      });
+         PathInfo& top = mPath[mDepth - 1];
+         if (top.NextChild < top.Control->GetChildCount())
+         {
+            mCurrent = top.Control->GetChild(top.NextChild++);
+
+            if (mDepth < MaxDepth)
+            {
+               mPath[mDepth++] = { mCurrent, 0 };
+            }
+            else
+            {
+               mOverflow = 1;
+            }
+
+            return *this;
+         }
+
+         mDepth--;
+      }
+
+      mCurrent = nullptr;
+      return *this;
    }
 
    void StandardGuiRenderer::Init()
@@ -96,7 +209,10 @@ namespace wgui
       {
          for (auto it = mControls[i]->begin(); it != mControls[i]->end(); ++it)
          {
-            (*it)->OnInitialized();
+            // Abstract controls fill in their children without AddChild, link every parent here.
+            GuiControlBase* control = *it;
+            control->VisitChildren([control](GuiControlBase* child, int index) { child->SetParent(control); });
+            control->OnInitialized();
          }
       }
    }
@@ -123,7 +239,7 @@ namespace wgui
 
       for (int i = 0; i < mControls.size(); i++)
       {
-         float ht = mControls[i]->GetHeight(window, context);
+         float ht = mControls[i]->GetLayoutHeight(window, context);
          ht += mControls[i]->GetVerticalSpacing(window, context);
          if (ht > maxHeight)
          {
@@ -140,13 +256,63 @@ namespace wgui
 
       for (int i = 0; i < mControls.size(); i++)
       {
-         totalHeight += mControls[i]->GetHeight(window, context);
+         totalHeight += mControls[i]->GetLayoutHeight(window, context);
          totalHeight += mControls[i]->GetVerticalSpacing(window, context);
       }
 
       return totalHeight;
    }
 
+   uint64_t GuiControlBase::NextControlId()
+   {
+      // Layouts can be built on any thread.
+      static std::atomic<uint64_t> nextId = 1;
+      return nextId.fetch_add(1, std::memory_order_relaxed);
+   }
+
+   float GuiControlBase::GetLayoutHeight(WindowBase* const window, nk_context* context) const
+   {
+      double scale = window->GetContentScaleY();
+      uint64_t styleRevision = window->GetStyleRevision();
+
+      if (!mLayoutValid || mLayoutWindow != window || mLayoutScale != scale || mLayoutStyleRevision != styleRevision)
+      {
+         mLayoutHeight = GetHeight(window, context);
+         mLayoutWindow = window;
+         mLayoutScale = scale;
+         mLayoutStyleRevision = styleRevision;
+         mLayoutValid = true;
+      }
+
+      return mLayoutHeight;
+   }
+
+   void GuiControlBase::InvalidateLayout()
+   {
+      // An invalid parent had everything above it invalidated along with it.
+      for (GuiControlBase* control = this; control != nullptr && control->mLayoutValid; control = control->mParent)
+      {
+         control->mLayoutValid = false;
+      }
+
+      InvalidateRender();
+   }
+
+   void GuiControlBase::OnAttributeChanged(attr_name_id_t name)
+   {
+      // Most attributes can change the height, auto sized text for one, re-measuring the path is cheap.
+      InvalidateLayout();
+   }
+
+   void GuiControlBase::InvalidateRender()
+   {
+      // Unlike heights, a group captured again since the last change has to hear about this one too.
+      for (GuiControlBase* control = this; control != nullptr; control = control->mParent)
+      {
+         control->OnSubtreeChanged();
+      }
+   }
+
    void ChildSupportingGuiControlBase::ForEachChild(std::function<void(GuiControlBase* child, int index)> function) 
    {
       for (int i = 0; i < mControls.size(); i++)
@@ -164,6 +330,12 @@ namespace wgui
 
    void GuiControlBase::Render(WindowBase* const window, nk_context* context)
    {
+      ControlProfiler* profiler = window->GetControlProfiler();
+      if (profiler)
+      {
+         profiler->Enter(this, context);
+      }
+
       if (!mEnabled)
       {
          nk_widget_disable_begin(context);
@@ -175,6 +347,11 @@ namespace wgui
          ChildRender(window, context);
          HandleEvents(window, context);
       }
+
+      if (profiler)
+      {
+         profiler->Exit(context);
+      }
    }
 
    void GuiLayoutWindow::ChildRender(WindowBase* window, nk_context* context)
@@ -197,7 +374,7 @@ namespace wgui
       }
       else
       {
-         height = GetHeight(window, context);
+         height = GetLayoutHeight(window, context);
          width = mWidth * window->GetContentScaleX();
          posX = mPosX * window->GetContentScaleX();
          posY = mPosY * window->GetContentScaleY();
@@ -256,7 +433,7 @@ namespace wgui
       struct nk_window* win = context->current;
       const struct nk_style* style = &context->style;
 
-      float thickness = GetHeight(window, context);
+      float thickness = GetLayoutHeight(window, context);
 
       nk_stroke_line(&win->buffer,
          bounds.x, bounds.y + (thickness / 2.0), bounds.x + bounds.w, bounds.y + (thickness / 2.0),
@@ -344,7 +521,7 @@ namespace wgui
                itemIndex++;
                items->push_back(cb);
 
-               texts->push_back(&cb->GetOrCreateAttribute<std::string, AttrString>((std::string)GuiLabel::TextAttr));
+               texts->push_back(&cb->GetOrCreateAttribute<std::string, AttrString>(AttributeNames::Of<GuiLabel::TextAttr>()));
             }
 
             if (control != nullptr && control->SupportsChildren())
@@ -358,7 +535,7 @@ namespace wgui
 
    void GuiComboboxItem::ChildRender(WindowBase* const window, nk_context* context)
    {
-      int itemHeight = GetHeight(window, context);
+      int itemHeight = GetLayoutHeight(window, context);
       nk_layout_row_dynamic(context, itemHeight, 1);
 
       if (nk_combo_item_label(context, mText.c_str(), mTextAlignment))
@@ -437,13 +614,73 @@ namespace wgui
       mSelected = static_cast<bool>(selected);
    }
 
+   void GuiPerfOverlay::ChildRender(WindowBase* const window, nk_context* context)
+   {
+      FrameProfiler* profiler = window->GetFrameProfiler();
+      if (!profiler)
+      {
+         window->SetFrameProfiling(true);
+         profiler = window->GetFrameProfiler();
+         mLastRefresh = FrameProfiler::Now();
+      }
+
+      // The overlay changes on its own, cached groups holding it have to draw it live every frame.
+      InvalidateRender();
+
+      FrameProfiler::Clock::time_point now = FrameProfiler::Now();
+      if (FrameProfiler::ElapsedMs(mLastRefresh, now) >= RefreshSeconds * 1000.0)
+      {
+         mLastRefresh = now;
+         profiler->GetSamples(mSamples);
+         for (size_t i = 0; i < mSummaries.size(); i++)
+         {
+            mSummaries[i] = FrameProfiler::Summarize(mSamples, static_cast<eFramePhase>(i));
+         }
+      }
+
+      if (!nk_group_begin(context, mName.c_str(), NK_WINDOW_NO_SCROLLBAR))
+      {
+         return;
+      }
+
+      float rowHeight = context->style.font->height;
+      char text[32];
+
+      nk_layout_row_dynamic(context, rowHeight, 4);
+      nk_label(context, "ms", NK_TEXT_LEFT);
+      nk_label(context, "p50", NK_TEXT_RIGHT);
+      nk_label(context, "p95", NK_TEXT_RIGHT);
+      nk_label(context, "p99", NK_TEXT_RIGHT);
+
+      for (size_t i = 0; i < mSummaries.size(); i++)
+      {
+         const FramePhaseSummary& summary = mSummaries[i];
+         nk_layout_row_dynamic(context, rowHeight, 4);
+         nk_label(context, FrameProfiler::GetPhaseName(static_cast<eFramePhase>(i)), NK_TEXT_LEFT);
+
+         for (float value : { summary.P50, summary.P95, summary.P99 })
+         {
+            std::snprintf(text, sizeof(text), "%.2f", value);
+            nk_label(context, text, NK_TEXT_RIGHT);
+         }
+      }
+
+      nk_group_end(context);
+   }
+
+   float GuiPerfOverlay::GetHeight(WindowBase* const window, nk_context* context) const
+   {
+      float rowHeight = context->style.font->height + context->style.window.spacing.y;
+      return rowHeight * RowCount + context->style.window.group_padding.y * 2;
+   }
+
 #pragma endregion
 
 #pragma region Layout Row Implementations
 
    void GuiLayoutRowDynamic::ChildRender(WindowBase* const window, nk_context* context)
    {
-      int height = GetHeight(window, context);
+      int height = GetLayoutHeight(window, context);
 
       nk_layout_row_dynamic(context, height, mControls.size());
       for (int i = 0; i < mControls.size(); i++)
@@ -454,7 +691,7 @@ namespace wgui
 
    void GuiLayoutRowStatic::ChildRender(WindowBase* const window, nk_context* context)
    {
-      int height = GetHeight(window, context);
+      int height = GetLayoutHeight(window, context);
       int width = mColWidth * window->GetContentScaleX();
 
       nk_layout_row_static(context, height, width, mControls.size());
@@ -471,7 +708,7 @@ namespace wgui
          throw std::runtime_error("More controls exist than scales.");
       }
 
-      int height = GetHeight(window, context);
+      int height = GetLayoutHeight(window, context);
       nk_layout_row_begin(context, NK_DYNAMIC, height, mControls.size());
 
       // There's guaranteed to be one scale for every control.
@@ -493,7 +730,7 @@ namespace wgui
       }
 
       // Min cols is ignored here.
-      int height = GetHeight(window, context);
+      int height = GetLayoutHeight(window, context);
       nk_layout_row_begin(context, NK_STATIC, height, mControls.size());
 
       // There's guaranteed to be one scale for every control.
@@ -516,7 +753,7 @@ namespace wgui
       }
 
       // Min cols is ignored here.
-      int height = GetHeight(window, context);
+      int height = GetLayoutHeight(window, context);
       nk_layout_row_template_begin(context, height);
 
       for (int i = 0; i < mControls.size(); i++)
@@ -535,18 +772,38 @@ namespace wgui
       }
    }
 
+   attr_name_id_t GuiLayoutSpace::GetWidthName()
+   {
+      static const attr_name_id_t name = AttributeNames::Intern((std::string)RootAttrName + "." + (std::string)WidthGridAttr);
+      return name;
+   }
+
+   attr_name_id_t GuiLayoutSpace::GetHeightName()
+   {
+      static const attr_name_id_t name = AttributeNames::Intern((std::string)RootAttrName + "." + (std::string)HeightGridAttr);
+      return name;
+   }
+
+   attr_name_id_t GuiLayoutSpace::GetPosXName()
+   {
+      static const attr_name_id_t name = AttributeNames::Intern((std::string)RootAttrName + "." + (std::string)PosXGridAttr);
+      return name;
+   }
+
+   attr_name_id_t GuiLayoutSpace::GetPosYName()
+   {
+      static const attr_name_id_t name = AttributeNames::Intern((std::string)RootAttrName + "." + (std::string)PosYGridAttr);
+      return name;
+   }
+
    bool GuiLayoutStaticSpace::AddChild(GuiControlBase* newControl)
    {
       if (GuiLayoutRowBase::AddChild(newControl))
       {
-         mWidths.push_back(&newControl->GetOrCreateAttribute<int64_t, AttrInt>
-            ((std::string)RootAttrName + "." + (std::string)WidthGridAttr));
-         mHeights.push_back(&newControl->GetOrCreateAttribute<int64_t, AttrInt>
-            ((std::string)RootAttrName + "." + (std::string)HeightGridAttr));
-         mPositionsX.push_back(&newControl->GetOrCreateAttribute<int64_t, AttrInt>
-            ((std::string)RootAttrName + "." + (std::string)PosXGridAttr));
-         mPositionsY.push_back(&newControl->GetOrCreateAttribute<int64_t, AttrInt>
-            ((std::string)RootAttrName + "." + (std::string)PosYGridAttr));
+         mWidths.push_back(&newControl->GetOrCreateAttribute<int64_t, AttrInt>(GetWidthName()));
+         mHeights.push_back(&newControl->GetOrCreateAttribute<int64_t, AttrInt>(GetHeightName()));
+         mPositionsX.push_back(&newControl->GetOrCreateAttribute<int64_t, AttrInt>(GetPosXName()));
+         mPositionsY.push_back(&newControl->GetOrCreateAttribute<int64_t, AttrInt>(GetPosYName()));
       }
 
       return true;
@@ -561,7 +818,7 @@ namespace wgui
       }
 
       // Min cols is ignored here.
-      int height = GetHeight(window, context);
+      int height = GetLayoutHeight(window, context);
       nk_layout_space_begin(context, NK_STATIC, height, mControls.size());
 
       for (int i = 0; i < mControls.size(); i++)
@@ -579,14 +836,10 @@ namespace wgui
    {
       if (GuiLayoutRowBase::AddChild(newControl))
       {
-         mWidths.push_back(&newControl->GetOrCreateAttribute<double, AttrReal>
-            ((std::string)RootAttrName + "." + (std::string)WidthGridAttr));
-         mHeights.push_back(&newControl->GetOrCreateAttribute<double, AttrReal>
-            ((std::string)RootAttrName + "." + (std::string)HeightGridAttr));
-         mPositionsX.push_back(&newControl->GetOrCreateAttribute<double, AttrReal>
-            ((std::string)RootAttrName + "." + (std::string)PosXGridAttr));
-         mPositionsY.push_back(&newControl->GetOrCreateAttribute<double, AttrReal>
-            ((std::string)RootAttrName + "." + (std::string)PosYGridAttr));
+         mWidths.push_back(&newControl->GetOrCreateAttribute<double, AttrReal>(GetWidthName()));
+         mHeights.push_back(&newControl->GetOrCreateAttribute<double, AttrReal>(GetHeightName()));
+         mPositionsX.push_back(&newControl->GetOrCreateAttribute<double, AttrReal>(GetPosXName()));
+         mPositionsY.push_back(&newControl->GetOrCreateAttribute<double, AttrReal>(GetPosYName()));
       }
 
       return true;
@@ -601,7 +854,7 @@ namespace wgui
       }
 
       // Min cols is ignored here.
-      int height = GetHeight(window, context);
+      int height = GetLayoutHeight(window, context);
       nk_layout_space_begin(context, NK_DYNAMIC, height, mControls.size());
 
       for (int i = 0; i < mControls.size(); i++)
@@ -627,6 +880,13 @@ namespace wgui
       flags |= (!mScrollable) ? NK_WINDOW_NO_SCROLLBAR : 0;
       flags |= (mBorder)? NK_WINDOW_BORDER : 0;
 
+      struct nk_rect bounds = nk_widget_bounds(context);
+      if (mCached && RenderFromCache(window, context, bounds))
+      {
+         return;
+      }
+
+      nk_size commandStart = context->memory.allocated;
       if (nk_group_begin_titled(context, mName.c_str(), mTitle.c_str(), flags))
       {
          for (int i = 0; i < mControls.size(); i++)
@@ -635,9 +895,73 @@ namespace wgui
          }
 
          nk_group_end(context);
+
+         if (mCached)
+         {
+            CaptureCache(window, context, bounds, commandStart);
+         }
       }
    }
 
+   bool GuiLayoutGroup::RenderFromCache(WindowBase* const window, nk_context* context, const struct nk_rect& bounds)
+   {
+      mDrawnFromCache = false;
+      if (MouseInteracting(context, bounds))
+      {
+         mCacheValid = false;
+         return false;
+      }
+
+      // Hovering only changes highlights, the picture is good again once the mouse leaves.
+      const nk_glfw* glfw = window->GetContext().GetGlfw();
+      if (!mCacheValid || nk_input_is_mouse_hovering_rect(&context->input, bounds) ||
+         bounds.w != mCacheBounds.w || bounds.h != mCacheBounds.h ||
+         mCacheTarget.width != static_cast<int>(bounds.w * glfw->fb_scale.x + 0.5f) ||
+         mCacheTarget.height != static_cast<int>(bounds.h * glfw->fb_scale.y + 0.5f) ||
+         mCacheStyleRevision != window->GetStyleRevision())
+      {
+         return false;
+      }
+
+      // Takes the slot the group would have, the children are skipped entirely.
+      struct nk_rect slot;
+      if (nk_widget(&slot, context) != NK_WIDGET_INVALID)
+      {
+         struct nk_image image = nk_image_id(static_cast<int>(mCacheTarget.texture));
+         nk_draw_image(nk_window_get_canvas(context), slot, &image, nk_rgb(255, 255, 255));
+      }
+
+      mDrawnFromCache = true;
+      return true;
+   }
+
+   void GuiLayoutGroup::CaptureCache(WindowBase* const window, nk_context* context, const struct nk_rect& bounds,
+      nk_size commandStart)
+   {
+      // Only a whole, undisturbed picture is worth keeping, partly scrolled out groups are captured once they're in.
+      struct nk_rect clip = context->current->layout->clip;
+      bool visible = bounds.x >= clip.x && bounds.y >= clip.y &&
+         bounds.x + bounds.w <= clip.x + clip.w && bounds.y + bounds.h <= clip.y + clip.h;
+
+      if (!visible || MouseInteracting(context, bounds) || FocusInteracting(context) ||
+         nk_input_is_mouse_hovering_rect(&context->input, bounds))
+      {
+         return;
+      }
+
+      // Subtrees that change every frame would capture every frame, wait for a frame without a change.
+      if (mSubtreeChanged)
+      {
+         mSubtreeChanged = false;
+         return;
+      }
+
+      mCacheValid = nk_glfw3_render_commands(window->GetContext().GetGlfw(), &mCacheTarget, commandStart,
+         context->memory.allocated, bounds);
+      mCacheBounds = bounds;
+      mCacheStyleRevision = window->GetStyleRevision();
+   }
+
    void GuiLayoutTreeNode::ChildRender(WindowBase* const window, nk_context* context)
    {
       nk_collapse_states state = mInitiallyOpen ? nk_collapse_states::NK_MAXIMIZED :
@@ -645,6 +969,10 @@ namespace wgui
 
       bool previousState = mExpanded;
       mExpanded = nk_tree_push_hashed(context, NK_TREE_NODE, mText.c_str(), state, mName.c_str(), mName.size(), 0);
+      if (mExpanded != previousState)
+      {
+         InvalidateLayout();
+      }
 
       // We need to delay the expansion of the tree by a single frame to avoid scrollbar issues.
       if (mExpanded != previousState && !previousState)
@@ -671,6 +999,10 @@ namespace wgui
 
       bool previousState = mExpanded;
       mExpanded = nk_tree_push_hashed(context, NK_TREE_TAB, mText.c_str(), state, mName.c_str(), mName.size(), 0);
+      if (mExpanded != previousState)
+      {
+         InvalidateLayout();
+      }
 
       // We need to delay the expansion of the tree by a single frame to avoid scrollbar stuff.
       if (mExpanded != previousState && !previousState)
@@ -708,26 +1040,59 @@ namespace wgui
 
    void GuiMenu::ChildRender(WindowBase* const window, nk_context* context)
    {
+      int width = mWidth * window->GetContentScaleX();
+      int height = GetLayoutHeight(window, context);
+      struct nk_vec2 size = nk_vec2(width, height);
+      bool open;
+
       if (mImagePath.empty())
       {
-         int width = mWidth * window->GetContentScaleX();
-         int height = GetHeight(window, context);
-         if (nk_menu_begin_label(context, mText.c_str(), mTextAlignFlags,
-            nk_vec2(width, height)))
+         open = nk_menu_begin_label(context, mText.c_str(), mTextAlignFlags, size);
+      }
+      else
+      {
+         // Menus are keyed on their text, or the path without one, so the popup survives the image arriving.
+         const struct nk_image* image = GetResidentImage(window, mImagePath, mImageRequest);
+         if (image != nullptr)
          {
-            for (int i = 0; i < mControls.size(); i++)
-            {
-               mControls[i]->Render(window, context);
-            }
+            open = mText.empty() ? nk_menu_begin_image(context, mImagePath.c_str(), *image, size) :
+               nk_menu_begin_image_label(context, mText.c_str(), mTextAlignFlags, *image, size);
+         }
+         else
+         {
+            open = mText.empty() ? nk_menu_begin_symbol(context, mImagePath.c_str(), ImagePlaceholder, size) :
+               nk_menu_begin_symbol_label(context, mText.c_str(), mTextAlignFlags, ImagePlaceholder, size);
+         }
+      }
 
-            nk_menu_end(context);
+      if (open)
+      {
+         for (int i = 0; i < mControls.size(); i++)
+         {
+            mControls[i]->Render(window, context);
          }
+
+         nk_menu_end(context);
       }
    }
 
    void GuiMenuItem::ChildRender(WindowBase* const window, nk_context* context)
    {
-      nk_menu_item_label(context, mText.c_str(), mTextAlignFlags);
+      if (mImagePath.empty())
+      {
+         nk_menu_item_label(context, mText.c_str(), mTextAlignFlags);
+         return;
+      }
+
+      const struct nk_image* image = GetResidentImage(window, mImagePath, mImageRequest);
+      if (image != nullptr)
+      {
+         nk_menu_item_image_label(context, *image, mText.c_str(), mTextAlignFlags);
+      }
+      else
+      {
+         nk_menu_item_symbol_label(context, ImagePlaceholder, mText.c_str(), mTextAlignFlags);
+      }
    }
 
 #pragma endregion
@@ -1,5 +1,7 @@
 #include "Shaders/ShaderBase.h"
+#include "DiskCache.h"
 
+#include <cstdio>
 #include <fstream>
 #include <iostream>
 
@@ -13,6 +15,15 @@ Shader::~Shader()
 {
 }
 
+void Shader::Release()
+{
+   if (mShader != 0)
+   {
+      glDeleteShader(mShader);
+      mShader = 0;
+   }
+}
+
 static bool LoadShaderi(const std::string& fileName, std::string& shaderString) 
 {
    std::ifstream file;
@@ -105,32 +116,37 @@ bool Shader::LoadShader(const std::string& shaderPath, int type, std::string& er
 
    if (LoadShaderi(shaderPath, text)) 
    {
-      mShader = glCreateShader((GLuint)type);
+      return CompileShader(shaderPath, text, type, errorMessage);
+   }
+   else 
+   {
+      errorMessage = "Could not open file: " + shaderPath;
+      return false;
+   }
+}
 
-      if (mShader == 0)
-      {
-         errorMessage = "Failed to create shader with type: " + (int)type;
-         return false;
-      }
+bool Shader::CompileShader(const std::string& shaderPath, const std::string& text, int type, std::string& errorMessage)
+{
+   mShader = glCreateShader((GLuint)type);
 
-      const GLchar* p[1];
-      p[0] = text.c_str();
-      GLint lengths[1];
-      lengths[0] = (GLint)text.length();
+   if (mShader == 0)
+   {
+      errorMessage = "Failed to create shader with type: " + (int)type;
+      return false;
+   }
 
-      glShaderSource(mShader, 1, p, lengths);
-      glCompileShader(mShader);
+   const GLchar* p[1];
+   p[0] = text.c_str();
+   GLint lengths[1];
+   lengths[0] = (GLint)text.length();
 
-      std::string error;
-      if (!CheckShaderError(mShader, GL_COMPILE_STATUS, false, error))
-      {
-         errorMessage = "Error compiling shader: " + shaderPath + ":\n" + error;
-         return false;
-      }
-   }
-   else 
+   glShaderSource(mShader, 1, p, lengths);
+   glCompileShader(mShader);
+
+   std::string error;
+   if (!CheckShaderError(mShader, GL_COMPILE_STATUS, false, error))
    {
-      errorMessage = "Could not open file: " + shaderPath;
+      errorMessage = "Error compiling shader: " + shaderPath + ":\n" + error;
       return false;
    }
 
@@ -156,6 +172,55 @@ static bool LinkShaderProgram(GLuint mShaderProgram, std::string& error)
    return true;
 }
 
+static bool ProgramBinarySupported()
+{
+   return GLEW_ARB_get_program_binary || GLEW_VERSION_4_1;
+}
+
+/**
+ * Key of a linked program: both sources, the attribute bindings and the driver that built it.
+ * Drivers refuse binaries from another version, keying on it keeps a stale file from failing every launch.
+ * */
+static uint64_t GetProgramCacheKey(const std::string& vertexSource, const std::string& fragmentSource,
+   const std::map<std::string, int>& attributes)
+{
+   wgui::CacheKey key;
+   key.Add(vertexSource.data(), vertexSource.size()).Add('\0');
+   key.Add(fragmentSource.data(), fragmentSource.size()).Add('\0');
+
+   for (const auto& attribute : attributes)
+   {
+      key.Add(attribute.first.data(), attribute.first.size()).Add(attribute.second);
+   }
+
+   const GLenum driverStrings[] = { GL_VENDOR, GL_RENDERER, GL_VERSION };
+   for (GLenum name : driverStrings)
+   {
+      const char* value = reinterpret_cast<const char*>(glGetString(name));
+      if (value != nullptr)
+      {
+         key.Add(value, strlen(value));
+      }
+      key.Add('\0');
+   }
+
+   return key.Get();
+}
+
+/**
+ * One cache file per pair of shader files, the key stored in it decides whether it is still valid.
+ * */
+static std::string GetProgramCachePath(const std::string& vertexShaderPath, const std::string& fragmentShaderPath)
+{
+   wgui::CacheKey name;
+   name.Add(vertexShaderPath.data(), vertexShaderPath.size()).Add('\0');
+   name.Add(fragmentShaderPath.data(), fragmentShaderPath.size());
+
+   char fileName[32];
+   snprintf(fileName, sizeof(fileName), "program_%016llx.bin", static_cast<unsigned long long>(name.Get()));
+   return wgui::DiskCache::GetPath(fileName);
+}
+
 ShaderBase::ShaderBase(const std::vector<std::string>& mAttributes)
    :mVertexShader(), mFragmentShader(), mShaderProgram((GLuint)0),
    mAttributes()
@@ -168,47 +233,72 @@ ShaderBase::ShaderBase(const std::vector<std::string>& mAttributes)
 
 ShaderBase::~ShaderBase()
 {
-   if (mShaderProgram != 0)
+   Release();
+}
+
+void ShaderBase::Release()
+{
+   // Programs restored from a binary have no shader objects attached.
+   if (mShaderProgram != 0 && mVertexShader.GetShader() != 0)
    {
       glDetachShader(mShaderProgram, mVertexShader.GetShader());
-      glDetachShader(mShaderProgram, mFragmentShader.GetShader());
    }
 
-   if (mVertexShader.GetShader() != 0)
+   if (mShaderProgram != 0 && mFragmentShader.GetShader() != 0)
    {
-      glDeleteShader(mVertexShader.GetShader());
+      glDetachShader(mShaderProgram, mFragmentShader.GetShader());
    }
 
-   if (mFragmentShader.GetShader() != 0)
-   {
-      glDeleteShader(mFragmentShader.GetShader());
-   }
+   mVertexShader.Release();
+   mFragmentShader.Release();
 
    if (mShaderProgram != 0)
    {
       glDeleteProgram(mShaderProgram);
+      mShaderProgram = 0;
    }
 }
 
 bool ShaderBase::LoadShaders(const std::string& vertexShaderPath, const std::string& fragmentShaderPath) 
 {
-   constexpr int maxErrorLen = 2048 * 2;
-   GLchar errorLog[maxErrorLen];
    bool loadError = false;
    std::string currentError;
 
+   std::string vertexSource;
+   std::string fragmentSource;
+   bool vertexLoaded = LoadShaderi(vertexShaderPath, vertexSource);
+   bool fragmentLoaded = LoadShaderi(fragmentShaderPath, fragmentSource);
+
+   // Reuse the program the driver linked on a previous launch, compile from source if that fails for any reason.
+   bool useCache = vertexLoaded && fragmentLoaded && wgui::DiskCache::IsEnabled() && ProgramBinarySupported();
+   uint64_t cacheKey = 0;
+   std::string cachePath;
+
+   if (useCache)
+   {
+      cacheKey = GetProgramCacheKey(vertexSource, fragmentSource, mAttributes);
+      cachePath = GetProgramCachePath(vertexShaderPath, fragmentShaderPath);
+      if (LoadProgramBinary(cachePath, cacheKey))
+      {
+         SetUniformLocations();
+         return true;
+      }
+   }
+
    //create the shader program
    this->mShaderProgram = glCreateProgram();
 
    //load each shader from a file
-   if (!mVertexShader.LoadShader(vertexShaderPath, GL_VERTEX_SHADER, currentError)) 
+   if (!(vertexLoaded ? mVertexShader.CompileShader(vertexShaderPath, vertexSource, GL_VERTEX_SHADER, currentError) :
+                        mVertexShader.LoadShader(vertexShaderPath, GL_VERTEX_SHADER, currentError)))
    {
       loadError = true;
    }
 
    //load fragment shader from file
    currentError = "";
-   if (!mFragmentShader.LoadShader(fragmentShaderPath, GL_FRAGMENT_SHADER, currentError)) 
+   if (!(fragmentLoaded ? mFragmentShader.CompileShader(fragmentShaderPath, fragmentSource, GL_FRAGMENT_SHADER, currentError) :
+                          mFragmentShader.LoadShader(fragmentShaderPath, GL_FRAGMENT_SHADER, currentError)))
    {
       loadError = true;
    }
@@ -228,12 +318,21 @@ bool ShaderBase::LoadShaders(const std::string& vertexShaderPath, const std::str
          glBindAttribLocation(this->mShaderProgram, (GLuint)i->second, i->first.c_str());
       }
 
+      if (useCache)
+      {
+         glProgramParameteri(mShaderProgram, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+      }
+
       //create the shader program
       currentError = "";
       if (!LinkShaderProgram(this->mShaderProgram, currentError))
       {
          loadError = true;
       }
+      else if (useCache)
+      {
+         StoreProgramBinary(cachePath, cacheKey);
+      }
 
       //load uniforms
       SetUniformLocations();
@@ -246,3 +345,53 @@ bool ShaderBase::LoadShaders(const std::string& vertexShaderPath, const std::str
 
    return !loadError;
 }
+
+bool ShaderBase::LoadProgramBinary(const std::string& path, uint64_t key)
+{
+   wgui::MappedFile file;
+   size_t size = 0;
+   const uint8_t* data = wgui::DiskCache::Load(path, key, file, size);
+   if (data == nullptr || size <= sizeof(GLenum))
+   {
+      return false;
+   }
+
+   GLenum format;
+   memcpy(&format, data, sizeof(format));
+
+   mShaderProgram = glCreateProgram();
+   glProgramBinary(mShaderProgram, format, data + sizeof(format), (GLsizei)(size - sizeof(format)));
+
+   // Drivers may reject a binary at any time (updates, different gpu), treat it as a miss.
+   GLint linked = GL_FALSE;
+   glGetProgramiv(mShaderProgram, GL_LINK_STATUS, &linked);
+   if (linked != GL_TRUE)
+   {
+      glDeleteProgram(mShaderProgram);
+      mShaderProgram = 0;
+      return false;
+   }
+
+   return true;
+}
+
+void ShaderBase::StoreProgramBinary(const std::string& path, uint64_t key)
+{
+   GLint length = 0;
+   glGetProgramiv(mShaderProgram, GL_PROGRAM_BINARY_LENGTH, &length);
+   if (length <= 0)
+   {
+      return;
+   }
+
+   std::vector<uint8_t> binary((size_t)length);
+   GLenum format = 0;
+   GLsizei written = 0;
+   glGetProgramBinary(mShaderProgram, length, &written, &format, binary.data());
+   if (written <= 0)
+   {
+      return;
+   }
+
+   wgui::DiskCache::Store(path, key, { { &format, sizeof(format) }, { binary.data(), (size_t)written } });
+}
@@ -0,0 +1,346 @@
+#include "SoftwareRasterizer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define WGUI_RASTER_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace
+{
+   /// <summary>
+   /// Edge function of a->b in the form A*x + B*y + C, positive on the inside of a
+   /// triangle with positive area.
+   /// </summary>
+   struct Edge
+   {
+      Edge(const wgui::RasterVertex& a, const wgui::RasterVertex& b)
+      {
+         A = a.Position[1] - b.Position[1];
+         B = b.Position[0] - a.Position[0];
+         C = -(A * a.Position[0] + B * a.Position[1]);
+
+         // Pixels exactly on an edge belong to the triangle only for top and left edges,
+         // so triangles sharing an edge don't blend those pixels twice.
+         TopLeft = A > 0 || (A == 0 && B > 0);
+      }
+
+      float Eval(float x, float y) const { return A * x + B * y + C; }
+      bool Inside(float value) const { return value > 0 || (value == 0 && TopLeft); }
+
+      float A, B, C;
+      bool TopLeft;
+   };
+
+   inline void Texel(const wgui::RasterTexture* texture, int x, int y, float* out)
+   {
+      x = std::clamp(x, 0, texture->Width - 1);
+      y = std::clamp(y, 0, texture->Height - 1);
+      const uint8_t* p = &texture->Pixels[((size_t)y * texture->Width + x) * 4];
+      out[0] = p[0]; out[1] = p[1]; out[2] = p[2]; out[3] = p[3];
+   }
+
+   /// <summary>
+   /// Bilinear, clamp to edge sample in [0, 255], like GL_LINEAR with texel centers at +0.5.
+   /// </summary>
+   inline void Sample(const wgui::RasterTexture* texture, float u, float v, float* out)
+   {
+      if (!texture)
+      {
+         out[0] = out[1] = out[2] = out[3] = 255.0f;
+         return;
+      }
+
+      float x = u * texture->Width - 0.5f;
+      float y = v * texture->Height - 0.5f;
+      float fx = std::floor(x);
+      float fy = std::floor(y);
+      float tx = x - fx;
+      float ty = y - fy;
+      int ix = (int)fx;
+      int iy = (int)fy;
+
+      float t00[4], t10[4], t01[4], t11[4];
+      Texel(texture, ix, iy, t00);
+      Texel(texture, ix + 1, iy, t10);
+      Texel(texture, ix, iy + 1, t01);
+      Texel(texture, ix + 1, iy + 1, t11);
+
+      for (int i = 0; i < 4; i++)
+      {
+         float top = t00[i] + (t10[i] - t00[i]) * tx;
+         float bottom = t01[i] + (t11[i] - t01[i]) * tx;
+         out[i] = top + (bottom - top) * ty;
+      }
+   }
+}
+
+namespace wgui
+{
+   void SoftwareRasterizer::Resize(int width, int height)
+   {
+      mWidth = std::max(width, 0);
+      mHeight = std::max(height, 0);
+      mPixels.assign((size_t)mWidth * mHeight * 4, 0);
+      ResetScissor();
+   }
+
+   void SoftwareRasterizer::Clear(uint8_t r, uint8_t g, uint8_t b, uint8_t a)
+   {
+      for (size_t i = 0; i < mPixels.size(); i += 4)
+      {
+         mPixels[i] = r;
+         mPixels[i + 1] = g;
+         mPixels[i + 2] = b;
+         mPixels[i + 3] = a;
+      }
+   }
+
+   int SoftwareRasterizer::AddTexture(const void* rgba, int width, int height)
+   {
+      RasterTexture texture;
+      texture.Width = width;
+      texture.Height = height;
+      texture.Pixels.resize((size_t)width * height * 4);
+      std::memcpy(texture.Pixels.data(), rgba, texture.Pixels.size());
+
+      mTextures.push_back(std::move(texture));
+      return (int)mTextures.size();
+   }
+
+   const RasterTexture* SoftwareRasterizer::GetTexture(int id) const
+   {
+      if (id <= 0 || id > (int)mTextures.size())
+      {
+         return nullptr;
+      }
+
+      return &mTextures[id - 1];
+   }
+
+   void SoftwareRasterizer::SetScissor(int x, int y, int width, int height)
+   {
+      mScissor[0] = std::clamp(x, 0, mWidth);
+      mScissor[1] = std::clamp(y, 0, mHeight);
+      mScissor[2] = std::clamp(x + width, 0, mWidth);
+      mScissor[3] = std::clamp(y + height, 0, mHeight);
+   }
+
+   void SoftwareRasterizer::ResetScissor()
+   {
+      SetScissor(0, 0, mWidth, mHeight);
+   }
+
+   void SoftwareRasterizer::DrawTriangle(const RasterVertex& v0, const RasterVertex& in1, const RasterVertex& in2,
+      const RasterTexture* texture)
+   {
+      float area = (in1.Position[0] - v0.Position[0]) * (in2.Position[1] - v0.Position[1]) -
+         (in1.Position[1] - v0.Position[1]) * (in2.Position[0] - v0.Position[0]);
+
+      if (area == 0)
+      {
+         return;
+      }
+
+      // Nuklear emits both windings and the gl backend doesn't cull, flip to a positive area.
+      const RasterVertex& v1 = area > 0 ? in1 : in2;
+      const RasterVertex& v2 = area > 0 ? in2 : in1;
+      area = std::abs(area);
+
+      // Edge opposite of each vertex, its value over the area is that vertex's barycentric weight.
+      const Edge edges[3] = { Edge(v1, v2), Edge(v2, v0), Edge(v0, v1) };
+      const RasterVertex* verts[3] = { &v0, &v1, &v2 };
+      const float invArea = 1.0f / area;
+
+      float minX = std::min({ v0.Position[0], v1.Position[0], v2.Position[0] });
+      float maxX = std::max({ v0.Position[0], v1.Position[0], v2.Position[0] });
+      float minY = std::min({ v0.Position[1], v1.Position[1], v2.Position[1] });
+      float maxY = std::max({ v0.Position[1], v1.Position[1], v2.Position[1] });
+
+      int x0 = std::max(mScissor[0], (int)std::floor(minX));
+      int x1 = std::min(mScissor[2], (int)std::ceil(maxX) + 1);
+      int y0 = std::max(mScissor[1], (int)std::floor(minY));
+      int y1 = std::min(mScissor[3], (int)std::ceil(maxY) + 1);
+
+      if (x0 >= x1 || y0 >= y1)
+      {
+         return;
+      }
+
+      // Attributes are linear in screen space, step them along x with their gradient.
+      float colorStep[4], uStep = 0, vStep = 0;
+      for (int c = 0; c < 4; c++)
+      {
+         colorStep[c] = 0;
+         for (int i = 0; i < 3; i++)
+         {
+            colorStep[c] += edges[i].A * invArea * verts[i]->Color[c];
+         }
+      }
+      for (int i = 0; i < 3; i++)
+      {
+         uStep += edges[i].A * invArea * verts[i]->Uv[0];
+         vStep += edges[i].A * invArea * verts[i]->Uv[1];
+      }
+
+      for (int y = y0; y < y1; y++)
+      {
+         const float py = y + 0.5f;
+         int lo = x0;
+         int hi = x1;
+         bool empty = false;
+
+         // Solve each edge for the covered range on this row.
+         for (const Edge& e : edges)
+         {
+            float rest = e.B * py + e.C;
+            if (e.A > 0)
+            {
+               lo = std::max(lo, (int)std::ceil(-rest / e.A - 0.5f));
+            }
+            else if (e.A < 0)
+            {
+               hi = std::min(hi, (int)std::floor(-rest / e.A - 0.5f) + 1);
+            }
+            else if (!e.Inside(rest))
+            {
+               empty = true;
+            }
+         }
+
+         if (empty)
+         {
+            continue;
+         }
+
+         auto inside = [&](int x)
+         {
+            float px = x + 0.5f;
+            return edges[0].Inside(edges[0].Eval(px, py)) &&
+               edges[1].Inside(edges[1].Eval(px, py)) &&
+               edges[2].Inside(edges[2].Eval(px, py));
+         };
+
+         // The division above can be a hair off, settle the ends with the exact test.
+         while (lo < hi && !inside(lo)) lo++;
+         while (hi > lo && !inside(hi - 1)) hi--;
+         while (lo > x0 && lo < hi && inside(lo - 1)) lo--;
+         while (hi < x1 && lo < hi && inside(hi)) hi++;
+
+         if (lo >= hi)
+         {
+            continue;
+         }
+
+         const float px = lo + 0.5f;
+         float w[3];
+         for (int i = 0; i < 3; i++)
+         {
+            w[i] = edges[i].Eval(px, py) * invArea;
+         }
+
+         float color[4];
+         for (int c = 0; c < 4; c++)
+         {
+            color[c] = w[0] * v0.Color[c] + w[1] * v1.Color[c] + w[2] * v2.Color[c];
+         }
+         float u = w[0] * v0.Uv[0] + w[1] * v1.Uv[0] + w[2] * v2.Uv[0];
+         float v = w[0] * v0.Uv[1] + w[1] * v1.Uv[1] + w[2] * v2.Uv[1];
+
+         ShadeSpan(&mPixels[((size_t)y * mWidth + lo) * 4], hi - lo, color, colorStep, u, v, uStep, vStep, texture);
+      }
+   }
+
+#ifdef WGUI_RASTER_SSE2
+   void SoftwareRasterizer::ShadeSpan(uint8_t* dst, int count, const float* color, const float* colorStep,
+      float u, float v, float uStep, float vStep, const RasterTexture* texture)
+   {
+      const __m128 inv255 = _mm_set1_ps(1.0f / 255.0f);
+      const __m128 scale255 = _mm_set1_ps(255.0f);
+      const __m128 half = _mm_set1_ps(0.5f);
+      const __m128 one = _mm_set1_ps(1.0f);
+      const __m128i zero = _mm_setzero_si128();
+      __m128 col = _mm_loadu_ps(color);
+      const __m128 step = _mm_loadu_ps(colorStep);
+
+      for (int i = 0; i < count; i++, dst += 4)
+      {
+         float texel[4];
+         Sample(texture, u, v, texel);
+
+         // src = vertex color * texel, both in [0, 255].
+         __m128 src = _mm_mul_ps(_mm_mul_ps(col, _mm_loadu_ps(texel)), _mm_mul_ps(inv255, inv255));
+         __m128 alpha = _mm_shuffle_ps(src, src, _MM_SHUFFLE(3, 3, 3, 3));
+
+         int packed;
+         std::memcpy(&packed, dst, 4);
+         __m128i d = _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(packed), zero), zero);
+         __m128 dstColor = _mm_mul_ps(_mm_cvtepi32_ps(d), inv255);
+
+         __m128 out = _mm_add_ps(_mm_mul_ps(src, alpha), _mm_mul_ps(dstColor, _mm_sub_ps(one, alpha)));
+         out = _mm_min_ps(_mm_max_ps(out, _mm_setzero_ps()), one);
+
+         __m128i o = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(out, scale255), half));
+         o = _mm_packs_epi32(o, zero);
+         o = _mm_packus_epi16(o, zero);
+         packed = _mm_cvtsi128_si32(o);
+         std::memcpy(dst, &packed, 4);
+
+         col = _mm_add_ps(col, step);
+         u += uStep;
+         v += vStep;
+      }
+   }
+#else
+   void SoftwareRasterizer::ShadeSpan(uint8_t* dst, int count, const float* color, const float* colorStep,
+      float u, float v, float uStep, float vStep, const RasterTexture* texture)
+   {
+      float col[4] = { color[0], color[1], color[2], color[3] };
+
+      for (int i = 0; i < count; i++, dst += 4)
+      {
+         float texel[4];
+         Sample(texture, u, v, texel);
+
+         float src[4];
+         for (int c = 0; c < 4; c++)
+         {
+            src[c] = col[c] * texel[c] / (255.0f * 255.0f);
+         }
+
+         float alpha = src[3];
+         for (int c = 0; c < 4; c++)
+         {
+            float out = src[c] * alpha + (dst[c] / 255.0f) * (1.0f - alpha);
+            out = std::clamp(out, 0.0f, 1.0f);
+            dst[c] = (uint8_t)(out * 255.0f + 0.5f);
+            col[c] += colorStep[c];
+         }
+
+         u += uStep;
+         v += vStep;
+      }
+   }
+#endif
+
+   bool SoftwareRasterizer::WritePpm(const std::string& path) const
+   {
+      std::ofstream file(path, std::ios::binary);
+      if (!file)
+      {
+         return false;
+      }
+
+      file << "P6\n" << mWidth << " " << mHeight << "\n255\n";
+      for (size_t i = 0; i < mPixels.size(); i += 4)
+      {
+         file.write(reinterpret_cast<const char*>(&mPixels[i]), 3);
+      }
+
+      return (bool)file;
+   }
+}
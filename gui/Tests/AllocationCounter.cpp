@@ -0,0 +1,57 @@
+#include "AllocationCounter.h"
+
+#include <cstdlib>
+#include <new>
+
+namespace
+{
+   thread_local bool CountAllocations = false;
+   thread_local size_t AllocationCount = 0;
+}
+
+AllocationCounter::AllocationCounter()
+{
+   AllocationCount = 0;
+   CountAllocations = true;
+}
+
+AllocationCounter::~AllocationCounter()
+{
+   Stop();
+}
+
+void AllocationCounter::Stop()
+{
+   CountAllocations = false;
+}
+
+size_t AllocationCounter::GetCount() const
+{
+   return AllocationCount;
+}
+
+void* operator new(size_t size)
+{
+   if (CountAllocations)
+   {
+      AllocationCount++;
+   }
+
+   void* memory = std::malloc(size == 0 ? 1 : size);
+   if (memory == nullptr)
+   {
+      throw std::bad_alloc();
+   }
+
+   return memory;
+}
+
+void operator delete(void* memory) noexcept
+{
+   std::free(memory);
+}
+
+void operator delete(void* memory, size_t) noexcept
+{
+   std::free(memory);
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <cstddef>
+
+/// <summary>
+/// Counts the allocations made on this thread from construction until Stop.
+/// Test executables using it link AllocationCounter.cpp, which replaces the global operator new.
+/// </summary>
+class AllocationCounter
+{
+public:
+   AllocationCounter();
+   ~AllocationCounter();
+
+   AllocationCounter(const AllocationCounter&) = delete;
+   AllocationCounter& operator=(const AllocationCounter&) = delete;
+
+   void Stop();
+   size_t GetCount() const;
+};
@@ -0,0 +1,85 @@
+#include <gtest/gtest.h>
+#include <string>
+
+#include "AllocationCounter.h"
+#include "StandardControls.h"
+
+using namespace wgui;
+
+namespace
+{
+   constexpr std::string_view ConstantName = "ConstantTestName";
+}
+
+TEST(AttributeTests, NamesIgnoreCase)
+{
+   attr_name_id_t name = AttributeNames::Intern("InternTestName");
+
+   EXPECT_EQ(name, AttributeNames::Intern("interntestname"));
+   EXPECT_EQ(name, AttributeNames::Find("INTERNTESTNAME"));
+   EXPECT_NE(name, AttributeNames::Intern("InternTestName2"));
+   EXPECT_EQ("InternTestName", AttributeNames::GetName(name));
+
+   // Looking up never adds names.
+   EXPECT_EQ(AttributeNames::NotAName, AttributeNames::Find("NeverInterned"));
+   EXPECT_EQ(AttributeNames::NotAName, AttributeNames::Find("NeverInterned"));
+}
+
+TEST(AttributeTests, ConstantNamesKeepTheirId)
+{
+   attr_name_id_t name = AttributeNames::Of<ConstantName>();
+
+   EXPECT_EQ(name, AttributeNames::Find("constanttestname"));
+   EXPECT_EQ(name, AttributeNames::Of<ConstantName>());
+   EXPECT_EQ(AttributeNames::Find(GuiLabel::TextAttr), AttributeNames::Of<GuiLabel::TextAttr>());
+}
+
+TEST(AttributeTests, SetsFindAttributesByIdAndName)
+{
+   AttributeSet attributes;
+   attributes.Add<AttrInt>("Zeta")->Set(3);
+   attributes.Add<AttrString>("Alpha")->Set("a");
+   attributes.Add<AttrBool>("Mid")->Set(true);
+
+   EXPECT_EQ(3u, attributes.Size());
+   EXPECT_TRUE(attributes.AttributeExists("zeta"));
+   EXPECT_TRUE(attributes.AttributeExists(AttributeNames::Find("ALPHA")));
+   EXPECT_FALSE(attributes.AttributeExists("NotOnThisSet"));
+   EXPECT_EQ(3, attributes.Get<AttrInt>("Zeta")->Get());
+   EXPECT_EQ("a", attributes.Get<AttrString>(AttributeNames::Find("alpha"))->Get());
+   EXPECT_TRUE(attributes.Get<AttrBool>("mid")->Get());
+
+   // Set replaces existing attributes and adds missing ones.
+   auto replacement = std::make_unique<Attribute>();
+   replacement->SetType<AttrInt>();
+   replacement->As<AttrInt>()->Set(7);
+   attributes.Set("Alpha", std::move(replacement));
+
+   auto added = std::make_unique<Attribute>();
+   added->SetType<AttrReal>();
+   added->As<AttrReal>()->Set(0.5);
+   attributes.Set("Beta", std::move(added));
+
+   EXPECT_EQ(4u, attributes.Size());
+   EXPECT_EQ(7, attributes.Get<AttrInt>("Alpha")->Get());
+   EXPECT_EQ(0.5, attributes.Get<AttrReal>("BETA")->Get());
+   EXPECT_EQ(3, attributes.Get<AttrInt>("Zeta")->Get());
+}
+
+TEST(AttributeTests, QueriesDoNotAllocate)
+{
+   GuiLabel label("Label", eTextAlignmentFlags::CenterLeft);
+   attr_name_id_t text = AttributeNames::Find(GuiLabel::TextAttr);
+   ASSERT_NE(AttributeNames::NotAName, text);
+
+   AllocationCounter allocations;
+   bool exists = label.AttributeExists(GuiLabel::TextAttr) && label.AttributeExists("textalign");
+   const std::string& value = label.GetAttributes()->Get<AttrString>(text)->GetRef();
+   int64_t missing = label.AttributeExists("Height");
+   allocations.Stop();
+
+   EXPECT_TRUE(exists);
+   EXPECT_EQ("Label", value);
+   EXPECT_FALSE(missing);
+   EXPECT_EQ(0u, allocations.GetCount());
+}
@@ -0,0 +1,122 @@
+#include <gtest/gtest.h>
+#include <memory>
+#include <optional>
+#include <sstream>
+#include <vector>
+
+#include "ControlProfiler.h"
+#include "StandardControls.h"
+#include "NkTestContext.h"
+
+using namespace wgui;
+
+namespace
+{
+   /// <summary>
+   /// A window holding two labels, profiled the way GuiControlBase::Render wraps each control.
+   /// </summary>
+   void RenderFrame(TestContext& test, ControlProfiler& profiler, GuiControlBase* window,
+      GuiControlBase* first, GuiControlBase* second)
+   {
+      nk_context* ctx = &test.Context;
+      nk_input_begin(ctx);
+      nk_input_end(ctx);
+
+      profiler.BeginFrame();
+      profiler.Enter(window, ctx);
+      if (nk_begin(ctx, "Profiled", nk_rect(0, 0, 300, 200), NK_WINDOW_BORDER))
+      {
+         for (GuiControlBase* label : { first, second })
+         {
+            profiler.Enter(label, ctx);
+            nk_layout_row_dynamic(ctx, 20, 1);
+            nk_label(ctx, "Keyrita", NK_TEXT_LEFT);
+            profiler.Exit(ctx);
+         }
+      }
+      nk_end(ctx);
+      profiler.Exit(ctx);
+
+      profiler.EndFrame(ctx, test.Config, NK_GLFW_TESSELLATION_TOLERANCE);
+      nk_clear(ctx);
+   }
+}
+
+TEST(ControlProfilerTests, CostsAddUpThroughTheTree)
+{
+   TestContext test;
+   ControlProfiler profiler;
+   GuiLayoutWindow window;
+   GuiLabel first("First", eTextAlignmentFlags::CenterLeft);
+   GuiLabel second("Second", eTextAlignmentFlags::CenterLeft);
+   second.GetOrCreateAttribute<std::string, AttrString>((std::string)GuiControlBase::TagAttr) = "Second";
+
+   RenderFrame(test, profiler, &window, &first, &second);
+   RenderFrame(test, profiler, &window, &first, &second);
+   EXPECT_EQ(profiler.GetFrameCount(), 2u);
+
+   std::unique_ptr<ControlProfileNode> report = profiler.GetReport();
+   ASSERT_EQ(report->Children.size(), 1u);
+   const ControlProfileNode& windowNode = *report->Children[0];
+   EXPECT_EQ(windowNode.Label, "Window");
+   EXPECT_EQ(windowNode.Cost.Calls, 2u);
+
+   // Same label but different tags, so the labels keep separate nodes.
+   ASSERT_EQ(windowNode.Children.size(), 2u);
+   uint64_t childCommands = 0, childVertices = 0;
+   for (const auto& child : windowNode.Children)
+   {
+      EXPECT_EQ(child->Label, "Label");
+      EXPECT_EQ(child->Cost.Calls, 2u);
+      EXPECT_GT(child->Cost.ExclusiveCommands, 0u);
+      EXPECT_GT(child->Cost.ExclusiveVertices, 0u);
+      EXPECT_EQ(child->Cost.InclusiveVertices, child->Cost.ExclusiveVertices);
+      childCommands += child->Cost.InclusiveCommands;
+      childVertices += child->Cost.InclusiveVertices;
+   }
+
+   // The window's own background and border are exclusive to it, the labels' text is not.
+   EXPECT_EQ(windowNode.Cost.InclusiveCommands, windowNode.Cost.ExclusiveCommands + childCommands);
+   EXPECT_GT(windowNode.Cost.ExclusiveCommands, 0u);
+   EXPECT_EQ(windowNode.Cost.InclusiveVertices, windowNode.Cost.ExclusiveVertices + childVertices);
+   EXPECT_GT(windowNode.Cost.ExclusiveVertices, 0u);
+   EXPECT_GE(windowNode.Cost.InclusiveMs, windowNode.Cost.ExclusiveMs);
+
+   std::ostringstream text;
+   profiler.WriteReport(text);
+   EXPECT_NE(text.str().find("Label [Second]"), std::string::npos);
+
+   profiler.Reset();
+   profiler.BeginFrame();
+   EXPECT_EQ(profiler.GetFrameCount(), 0u);
+   EXPECT_TRUE(profiler.GetReport()->Children.empty());
+}
+
+TEST(ControlProfilerTests, RebuiltControlsGetTheirOwnNodes)
+{
+   TestContext test;
+   ControlProfiler profiler;
+   GuiLayoutWindow window;
+   GuiLabel first("First", eTextAlignmentFlags::CenterLeft);
+
+   // Rebuilding a layout can put a new control where an old one was, optional reuses its storage.
+   std::optional<GuiLabel> second;
+   second.emplace("Second", eTextAlignmentFlags::CenterLeft);
+   second->GetOrCreateAttribute<std::string, AttrString>((std::string)GuiControlBase::TagAttr) = "Old";
+   RenderFrame(test, profiler, &window, &first, &*second);
+
+   GuiControlBase* oldAddress = &*second;
+   second.emplace("Second", eTextAlignmentFlags::CenterLeft);
+   second->GetOrCreateAttribute<std::string, AttrString>((std::string)GuiControlBase::TagAttr) = "New";
+   ASSERT_EQ(oldAddress, &*second);
+   RenderFrame(test, profiler, &window, &first, &*second);
+
+   std::unique_ptr<ControlProfileNode> report = profiler.GetReport();
+   ASSERT_EQ(report->Children.size(), 1u);
+   const ControlProfileNode& windowNode = *report->Children[0];
+   ASSERT_EQ(windowNode.Children.size(), 3u);
+   for (const auto& child : windowNode.Children)
+   {
+      EXPECT_EQ(child->Cost.Calls, child->Tag == "Untagged" ? 2u : 1u);
+   }
+}
@@ -0,0 +1,118 @@
+#include <gtest/gtest.h>
+#include <iterator>
+#include <memory>
+#include <vector>
+
+#include "AllocationCounter.h"
+#include "StandardControls.h"
+#include "TestTrees.h"
+
+using namespace wgui;
+
+namespace
+{
+   void CollectPreOrder(GuiControlBase* control, std::vector<GuiControlBase*>& order)
+   {
+      order.push_back(control);
+      control->VisitChildren([&order](GuiControlBase* child, int index) { CollectPreOrder(child, order); });
+   }
+}
+
+TEST(ControlTreeIteratorTests, WalksInPreOrder)
+{
+   TestTree tree(3, 4, 5);
+   std::vector<GuiControlBase*> expected;
+   CollectPreOrder(tree.Root, expected);
+
+   std::vector<GuiControlBase*> walked;
+   for (GuiControlBase* control : *tree.Root)
+   {
+      walked.push_back(control);
+   }
+
+   EXPECT_EQ(tree.Owned.size(), walked.size());
+   EXPECT_EQ(expected, walked);
+
+   // A leaf walks over itself only, a null root over nothing.
+   GuiControlBase* label = tree.Owned.back().get();
+   EXPECT_EQ(1, std::distance(label->begin(), label->end()));
+   EXPECT_TRUE(ControlTreeIterator(nullptr) == tree.Root->end());
+}
+
+TEST(ControlTreeIteratorTests, WalkingDoesNotAllocate)
+{
+   TestTree tree(10, 20, 6);
+   size_t visited = 0;
+   size_t labels = 0;
+
+   AllocationCounter allocations;
+   for (auto it = tree.Root->begin(); it != tree.Root->end(); ++it)
+   {
+      visited++;
+   }
+
+   tree.Root->VisitChildren([&labels](GuiControlBase* child, int index)
+      {
+         for (GuiControlBase* control : *child)
+         {
+            labels += control->GetControlType() == eControlType::Widget;
+         }
+      });
+   allocations.Stop();
+
+   EXPECT_EQ(tree.Owned.size(), visited);
+   EXPECT_EQ(10u * 20 * 6, labels);
+   EXPECT_EQ(0u, allocations.GetCount());
+}
+
+TEST(ControlTreeIteratorTests, DescendsToTheMaximumDepth)
+{
+   std::vector<std::unique_ptr<GuiControlBase>> owned;
+   owned.push_back(std::make_unique<GuiLayoutGroup>("0"));
+   for (int depth = 1; depth < ControlTreeIterator::MaxDepth; depth++)
+   {
+      owned.push_back(std::make_unique<GuiLayoutGroup>("Nested"));
+      owned[depth - 1]->AddChild(owned[depth].get());
+   }
+
+   size_t visited = 0;
+   for (auto it = owned[0]->begin(); it != owned[0]->end(); ++it)
+   {
+      EXPECT_EQ(owned[visited].get(), *it);
+      visited++;
+   }
+
+   EXPECT_EQ(owned.size(), visited);
+}
+
+TEST(ControlTreeIteratorTests, WalksPastTheMaximumDepth)
+{
+   // A chain of groups three times deeper than the stored path, with a label before and after every
+   // nested group so the walk has siblings to find on its way back up.
+   std::vector<std::unique_ptr<GuiControlBase>> owned;
+   owned.push_back(std::make_unique<GuiLayoutGroup>("0"));
+   GuiControlBase* parent = owned[0].get();
+   for (int depth = 1; depth < ControlTreeIterator::MaxDepth * 3; depth++)
+   {
+      owned.push_back(std::make_unique<GuiLabel>("Before", eTextAlignmentFlags::CenterLeft));
+      parent->AddChild(owned.back().get());
+      owned.push_back(std::make_unique<GuiLayoutGroup>("Nested"));
+      GuiControlBase* nested = owned.back().get();
+      parent->AddChild(nested);
+      owned.push_back(std::make_unique<GuiLabel>("After", eTextAlignmentFlags::CenterLeft));
+      parent->AddChild(owned.back().get());
+      parent = nested;
+   }
+
+   std::vector<GuiControlBase*> expected;
+   CollectPreOrder(owned[0].get(), expected);
+
+   std::vector<GuiControlBase*> walked;
+   for (GuiControlBase* control : *owned[0])
+   {
+      walked.push_back(control);
+   }
+
+   EXPECT_EQ(owned.size(), walked.size());
+   EXPECT_EQ(expected, walked);
+}
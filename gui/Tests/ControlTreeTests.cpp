@@ -276,6 +276,24 @@ TEST(ControlTests, GetControlsWithAttributeTests)
    ASSERT_EQ(newAttr, nullptr);
 }
 
+TEST(ControlTests, ChildrenKnowTheirParent)
+{
+   for (int i = 0; i < RootControls.size(); i++)
+   {
+      ASSERT_EQ(RootControls[i]->GetParent(), nullptr);
+
+      // Height invalidation walks up through these links.
+      for (auto it = RootControls[i]->begin(); it != RootControls[i]->end(); ++it)
+      {
+         GuiControlBase* parent = *it;
+         parent->ForEachChild([parent](GuiControlBase* child, int index)
+            {
+               ASSERT_EQ(child->GetParent(), parent);
+            });
+      }
+   }
+}
+
 int main(int argc, char** argv)
 {
 	// Initialize the control factory with the standard control list.
@@ -284,4 +302,4 @@ int main(int argc, char** argv)
 
 	::testing::InitGoogleTest(&argc, argv);
 	return RUN_ALL_TESTS();
-}
\ No newline at end of file
+}
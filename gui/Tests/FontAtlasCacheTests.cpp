@@ -0,0 +1,162 @@
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <filesystem>
+#include <vector>
+
+#include "DiskCache.h"
+#include "include_nuk.h"
+
+using namespace wgui;
+
+namespace
+{
+   struct UploadedImage
+   {
+      std::vector<uint8_t> Pixels;
+      int Width = 0;
+      int Height = 0;
+   };
+
+   void CopyUpload(void* userdata, const void* image, int width, int height)
+   {
+      UploadedImage* uploaded = static_cast<UploadedImage*>(userdata);
+      const uint8_t* bytes = static_cast<const uint8_t*>(image);
+      uploaded->Pixels.assign(bytes, bytes + (size_t)width * height * 4);
+      uploaded->Width = width;
+      uploaded->Height = height;
+   }
+
+   std::string TempCachePath(const char* name)
+   {
+      return (std::filesystem::temp_directory_path() / name).string();
+   }
+
+   /// <summary>
+   /// Builds the atlas the same way the windows do, with nuklear's embedded font so the test has no file dependencies.
+   /// </summary>
+   nk_glfw_atlas_source BakeAtlas(nk_font_atlas& atlas, float height, const std::string& path, UploadedImage& image)
+   {
+      nk_font_atlas_init_default(&atlas);
+      nk_font_atlas_begin(&atlas);
+      struct nk_font_config cfg = nk_font_config(height);
+      cfg.oversample_h = 2;
+      cfg.oversample_v = 2;
+      nk_font_atlas_add_default(&atlas, height, &cfg);
+      return nk_glfw3_font_atlas_bake_cached(&atlas, NK_FONT_ATLAS_RGBA32, path.c_str(), CopyUpload, &image);
+   }
+}
+
+TEST(FontAtlasCacheTests, StoreAndLoadRoundTrip)
+{
+   std::string path = TempCachePath("wgui_disk_cache_test.bin");
+   std::remove(path.c_str());
+
+   const char first[] = "font";
+   const char second[] = "atlas";
+   ASSERT_TRUE(DiskCache::Store(path, 42, { { first, 4 }, { second, 5 } }));
+
+   MappedFile file;
+   size_t size;
+   const uint8_t* payload = DiskCache::Load(path, 42, file, size);
+   ASSERT_NE(payload, nullptr);
+   ASSERT_EQ(size, 9u);
+   EXPECT_EQ(memcmp(payload, "fontatlas", 9), 0);
+   file.Close();
+
+   // A different key means the inputs changed, the old file must not be used.
+   EXPECT_EQ(DiskCache::Load(path, 43, file, size), nullptr);
+   EXPECT_FALSE(file.IsOpen());
+
+   std::remove(path.c_str());
+}
+
+TEST(FontAtlasCacheTests, RestoredAtlasMatchesBake)
+{
+   std::string path = TempCachePath("wgui_font_atlas_test.bin");
+   std::remove(path.c_str());
+
+   nk_font_atlas baked;
+   UploadedImage bakedImage;
+   ASSERT_EQ(BakeAtlas(baked, 14, path, bakedImage), NK_GLFW_ATLAS_BAKED);
+
+   nk_font_atlas cached;
+   UploadedImage cachedImage;
+   ASSERT_EQ(BakeAtlas(cached, 14, path, cachedImage), NK_GLFW_ATLAS_CACHED);
+
+   EXPECT_EQ(bakedImage.Width, cachedImage.Width);
+   EXPECT_EQ(bakedImage.Height, cachedImage.Height);
+   EXPECT_EQ(bakedImage.Pixels, cachedImage.Pixels);
+   ASSERT_EQ(baked.glyph_count, cached.glyph_count);
+   EXPECT_EQ(memcmp(baked.glyphs, cached.glyphs, sizeof(nk_font_glyph) * baked.glyph_count), 0);
+
+   nk_draw_null_texture bakedNull, cachedNull;
+   nk_font_atlas_end(&baked, nk_handle_id(1), &bakedNull);
+   nk_font_atlas_end(&cached, nk_handle_id(1), &cachedNull);
+   EXPECT_EQ(bakedNull.uv.x, cachedNull.uv.x);
+   EXPECT_EQ(bakedNull.uv.y, cachedNull.uv.y);
+
+   nk_user_font* bakedFont = &baked.fonts->handle;
+   nk_user_font* cachedFont = &cached.fonts->handle;
+   EXPECT_EQ(bakedFont->height, cachedFont->height);
+   EXPECT_EQ(bakedFont->width(bakedFont->userdata, bakedFont->height, "Keyrita", 7),
+             cachedFont->width(cachedFont->userdata, cachedFont->height, "Keyrita", 7));
+
+   // Any change to the inputs bakes again and replaces the file.
+   nk_font_atlas resized;
+   UploadedImage resizedImage;
+   EXPECT_EQ(BakeAtlas(resized, 15, path, resizedImage), NK_GLFW_ATLAS_BAKED);
+
+   nk_font_atlas_clear(&baked);
+   nk_font_atlas_clear(&cached);
+   nk_font_atlas_clear(&resized);
+   std::remove(path.c_str());
+}
+
+TEST(FontAtlasCacheTests, SdfAtlasServesEveryHeight)
+{
+   std::string path = TempCachePath("wgui_font_atlas_sdf_test.bin");
+   std::remove(path.c_str());
+
+   nk_font_atlas atlas;
+   nk_font_atlas_init_default(&atlas);
+   nk_font_atlas_begin(&atlas);
+   nk_font* font = nk_font_atlas_add_default(&atlas, 32, nullptr);
+
+   std::vector<uint8_t> pixels;
+   int atlasWidth = 0, atlasHeight = 0;
+   struct Capture { std::vector<uint8_t>* Pixels; int* Width; int* Height; } capture = { &pixels, &atlasWidth, &atlasHeight };
+   ASSERT_EQ(nk_glfw3_font_atlas_bake_sdf(&atlas, path.c_str(),
+      [](void* userdata, const void* image, int width, int height)
+      {
+         Capture* capture = static_cast<Capture*>(userdata);
+         const uint8_t* bytes = static_cast<const uint8_t*>(image);
+         capture->Pixels->assign(bytes, bytes + (size_t)width * height);
+         *capture->Width = width;
+         *capture->Height = height;
+      }, &capture), NK_GLFW_ATLAS_BAKED);
+
+   nk_draw_null_texture texNull;
+   nk_font_atlas_end(&atlas, nk_handle_id(1), &texNull);
+
+   // Solid fills sample the white texel, which has to read as fully inside the field.
+   int nullX = (int)(texNull.uv.x * atlasWidth);
+   int nullY = (int)(texNull.uv.y * atlasHeight);
+   EXPECT_EQ(pixels[(size_t)nullY * atlasWidth + nullX], 255);
+
+   // Glyph metrics come from the 32px bake and scale linearly with the requested height.
+   nk_user_font* handle = &font->handle;
+   float width32 = handle->width(handle->userdata, 32, "Keyrita", 7);
+   float width16 = handle->width(handle->userdata, 16, "Keyrita", 7);
+   EXPECT_GT(width32, 0.0f);
+   EXPECT_NEAR(width16 * 2, width32, 0.01f);
+
+   nk_user_font_glyph glyph;
+   handle->query(handle->userdata, 16, &glyph, 'K', 0);
+   EXPECT_GT(glyph.width, 0.0f);
+   EXPECT_GE(glyph.uv[0].x, 0.0f);
+   EXPECT_LE(glyph.uv[1].x, 1.0f);
+   EXPECT_LE(glyph.uv[1].y, 1.0f);
+
+   nk_font_atlas_clear(&atlas);
+   std::remove(path.c_str());
+}
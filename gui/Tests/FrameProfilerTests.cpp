@@ -0,0 +1,123 @@
+#include <gtest/gtest.h>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "FrameProfiler.h"
+
+using namespace wgui;
+
+namespace
+{
+   void CommitFrames(FrameProfiler& profiler, int count)
+   {
+      for (int i = 0; i < count; i++)
+      {
+         profiler.GetCurrentSample()[eFramePhase::Draw] = static_cast<float>(profiler.GetFrameCount());
+         profiler.Commit();
+      }
+   }
+}
+
+TEST(FrameProfilerTests, PercentilesUseNearestRank)
+{
+   std::vector<FrameSample> samples(100);
+   for (int i = 0; i < 100; i++)
+   {
+      // Out of order on purpose, the summary has to sort.
+      samples[i][eFramePhase::Layout] = static_cast<float>((i * 37) % 100 + 1);
+   }
+
+   FramePhaseSummary summary = FrameProfiler::Summarize(samples, eFramePhase::Layout);
+   EXPECT_FLOAT_EQ(summary.Mean, 50.5f);
+   EXPECT_FLOAT_EQ(summary.P50, 51.0f);
+   EXPECT_FLOAT_EQ(summary.P95, 95.0f);
+   EXPECT_FLOAT_EQ(summary.P99, 99.0f);
+
+   // Phases are independent, and no samples summarize to zeros.
+   EXPECT_FLOAT_EQ(FrameProfiler::Summarize(samples, eFramePhase::Draw).P99, 0.0f);
+   EXPECT_FLOAT_EQ(FrameProfiler::Summarize({}, eFramePhase::Draw).P50, 0.0f);
+}
+
+TEST(FrameProfilerTests, RingKeepsNewestSamples)
+{
+   auto profiler = std::make_unique<FrameProfiler>();
+   CommitFrames(*profiler, FrameProfiler::Capacity + 10);
+   EXPECT_EQ(profiler->GetFrameCount(), FrameProfiler::Capacity + 10);
+
+   std::vector<FrameSample> samples;
+   uint64_t end = profiler->GetSamples(samples);
+   EXPECT_EQ(end, FrameProfiler::Capacity + 10);
+   ASSERT_EQ(samples.size(), FrameProfiler::Capacity);
+   EXPECT_EQ(samples.front().Frame, 10u);
+   EXPECT_EQ(samples.back().Frame, FrameProfiler::Capacity + 9);
+   EXPECT_FLOAT_EQ(samples.front()[eFramePhase::Draw], 10.0f);
+
+   // Committing starts a fresh sample, nothing carries over to the next frame.
+   EXPECT_FLOAT_EQ(profiler->GetCurrentSample()[eFramePhase::Draw], 0.0f);
+}
+
+TEST(FrameProfilerTests, CsvCursorOnlyWritesNewRows)
+{
+   auto profiler = std::make_unique<FrameProfiler>();
+   std::ostringstream csv;
+   uint64_t cursor = 0;
+
+   FrameProfiler::WriteCsvHeader(csv);
+   CommitFrames(*profiler, 3);
+   profiler->WriteCsv(csv, cursor);
+   EXPECT_EQ(cursor, 3u);
+
+   CommitFrames(*profiler, 2);
+   profiler->WriteCsv(csv, cursor);
+   profiler->WriteCsv(csv, cursor);
+   EXPECT_EQ(cursor, 5u);
+
+   std::istringstream lines(csv.str());
+   std::string line;
+   std::vector<std::string> rows;
+   while (std::getline(lines, line))
+   {
+      rows.push_back(line);
+   }
+
+   ASSERT_EQ(rows.size(), 6u);
+   EXPECT_EQ(rows[0].rfind("frame,Input_ms,Layout_ms", 0), 0u);
+   EXPECT_EQ(rows[5].rfind("4,", 0), 0u);
+}
+
+TEST(FrameProfilerTests, CsvReportsOverwrittenRows)
+{
+   auto profiler = std::make_unique<FrameProfiler>();
+   std::ostringstream csv;
+   uint64_t cursor = 0;
+
+   CommitFrames(*profiler, 5);
+   EXPECT_EQ(profiler->WriteCsv(csv, cursor), 0u);
+
+   // The ring lapped the cursor, the first 10 frames after it are gone.
+   CommitFrames(*profiler, FrameProfiler::Capacity + 10);
+   EXPECT_EQ(profiler->WriteCsv(csv, cursor), 10u);
+   EXPECT_EQ(cursor, FrameProfiler::Capacity + 15);
+}
+
+TEST(FrameProfilerTests, UnmeasuredPhasesAreSkipped)
+{
+   auto profiler = std::make_unique<FrameProfiler>();
+   for (int i = 0; i < 4; i++)
+   {
+      // The first timer queries are still in flight.
+      profiler->GetCurrentSample()[eFramePhase::Gpu] = i < 2 ? FrameProfiler::NotMeasured : 4.0f;
+      profiler->Commit();
+   }
+
+   FramePhaseSummary summary = profiler->Summarize(eFramePhase::Gpu);
+   EXPECT_FLOAT_EQ(summary.Mean, 4.0f);
+   EXPECT_FLOAT_EQ(summary.P50, 4.0f);
+
+   std::ostringstream csv;
+   uint64_t cursor = 0;
+   profiler->WriteCsv(csv, cursor);
+   EXPECT_EQ(csv.str().rfind("0,0,0,0,0,0,0,,", 0), 0u);
+}
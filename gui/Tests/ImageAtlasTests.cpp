@@ -0,0 +1,158 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ImageAtlas.h"
+
+using namespace wgui;
+
+namespace
+{
+   struct PackedRect
+   {
+      int X, Y, Width, Height;
+   };
+
+   bool Overlaps(const PackedRect& a, const PackedRect& b, int padding)
+   {
+      return a.X - padding < b.X + b.Width + padding && b.X - padding < a.X + a.Width + padding &&
+         a.Y - padding < b.Y + b.Height + padding && b.Y - padding < a.Y + a.Height + padding;
+   }
+
+   /// <summary>
+   /// Solid square images with the size in the path, "16" decodes to 16x16, anything else fails.
+   /// </summary>
+   bool DecodeSquare(const std::string& path, DecodedImage& image)
+   {
+      int size = std::atoi(path.c_str());
+      if (size <= 0)
+      {
+         return false;
+      }
+
+      image.Width = size;
+      image.Height = size;
+      image.Pixels.assign(static_cast<size_t>(size) * size * 4, 255);
+      return true;
+   }
+
+   bool WaitForState(const AtlasImage* image, eImageState state)
+   {
+      auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+      while (image->GetState() != state && std::chrono::steady_clock::now() < deadline)
+      {
+         std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      }
+
+      return image->GetState() == state;
+   }
+}
+
+TEST(ImageAtlasTests, ShelvesNeverOverlap)
+{
+   const int padding = 1;
+   ShelfPacker packer(256, 256, padding);
+   std::mt19937 random(7);
+   std::uniform_int_distribution<int> sizes(8, 40);
+   std::vector<PackedRect> packed;
+
+   while (true)
+   {
+      PackedRect rect = { 0, 0, sizes(random), sizes(random) };
+      if (!packer.Pack(rect.Width, rect.Height, rect.X, rect.Y))
+      {
+         break;
+      }
+
+      EXPECT_GE(rect.X, padding);
+      EXPECT_GE(rect.Y, padding);
+      EXPECT_LE(rect.X + rect.Width + padding, 256);
+      EXPECT_LE(rect.Y + rect.Height + padding, 256);
+      for (const PackedRect& other : packed)
+      {
+         EXPECT_FALSE(Overlaps(rect, other, padding));
+      }
+
+      packed.push_back(rect);
+   }
+
+   // Random sizes still fill most of the page.
+   int area = 0;
+   for (const PackedRect& rect : packed)
+   {
+      area += rect.Width * rect.Height;
+   }
+
+   EXPECT_GT(area, 256 * 256 / 2);
+}
+
+TEST(ImageAtlasTests, IconsOfOneSizeShareAShelf)
+{
+   ShelfPacker packer(64, 64);
+   int x, y;
+
+   ASSERT_TRUE(packer.Pack(16, 16, x, y));
+   EXPECT_EQ(1, x);
+   EXPECT_EQ(1, y);
+   ASSERT_TRUE(packer.Pack(16, 16, x, y));
+   EXPECT_EQ(19, x);
+   EXPECT_EQ(1, y);
+
+   // Too wide for any page.
+   EXPECT_FALSE(packer.Pack(64, 8, x, y));
+}
+
+TEST(ImageAtlasTests, IdenticalPathsDecodeOnce)
+{
+   std::atomic<int> decodes = 0;
+   ImageAtlas atlas([&decodes](const std::string& path, DecodedImage& image)
+      {
+         decodes++;
+         return DecodeSquare(path, image);
+      });
+
+   AtlasImage* first = atlas.Request("16");
+   AtlasImage* second = atlas.Request("16");
+   AtlasImage* other = atlas.Request("24");
+
+   EXPECT_EQ(first, second);
+   EXPECT_NE(first, other);
+   ASSERT_TRUE(WaitForState(first, eImageState::Decoded));
+   ASSERT_TRUE(WaitForState(other, eImageState::Decoded));
+   EXPECT_EQ(first, atlas.Request("16"));
+   EXPECT_EQ(2, decodes.load());
+}
+
+TEST(ImageAtlasTests, DecodesOffTheCallingThread)
+{
+   std::thread::id decodeThread;
+   std::atomic<int> callbacks = 0;
+   ImageAtlas atlas([&decodeThread](const std::string& path, DecodedImage& image)
+      {
+         decodeThread = std::this_thread::get_id();
+         return DecodeSquare(path, image);
+      });
+   atlas.SetDecodedCallback([&callbacks]() { callbacks++; });
+
+   AtlasImage* image = atlas.Request("32");
+   AtlasImage* missing = atlas.Request("missing.png");
+
+   ASSERT_TRUE(WaitForState(image, eImageState::Decoded));
+   ASSERT_TRUE(WaitForState(missing, eImageState::Failed));
+   EXPECT_NE(std::this_thread::get_id(), decodeThread);
+   EXPECT_FALSE(image->IsResident());
+
+   // A callback for every finished decode, failed ones included, so nothing waits on a placeholder forever.
+   auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+   while (callbacks.load() < 2 && std::chrono::steady_clock::now() < deadline)
+   {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+   }
+
+   EXPECT_EQ(2, callbacks.load());
+}
@@ -0,0 +1,187 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#define popen _popen
+#define pclose _pclose
+#else
+#include <unistd.h>
+#endif
+
+#include "ControlArena.h"
+#include "XmlToUi.h"
+#include "TestTrees.h"
+
+using namespace wgui;
+
+// Builds each layout once per process, with the heap or an arena, and reports its construction time and
+// the resident memory it added. Run without arguments it starts itself once per layout, allocator and
+// run, so every build starts from a cold process instead of reusing memory freed by the previous one.
+//
+//    layout_arena_benchmark [runs]
+//    layout_arena_benchmark <layout> <heap|arena>
+
+namespace
+{
+   const char* const Layouts[] = { "ExampleUI.guix", "KeyritaMenu.guix", "synthetic" };
+
+   size_t ResidentBytes()
+   {
+#ifdef _WIN32
+      PROCESS_MEMORY_COUNTERS counters;
+      GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters));
+      return counters.WorkingSetSize;
+#else
+      std::ifstream statm("/proc/self/statm");
+      size_t pages = 0, resident = 0;
+      statm >> pages >> resident;
+      return resident * static_cast<size_t>(sysconf(_SC_PAGESIZE));
+#endif
+   }
+
+   std::string ReadFile(const std::string& path)
+   {
+      std::ifstream file(path);
+      std::stringstream text;
+      text << file.rdbuf();
+      return text.str();
+   }
+
+   struct BuildResult
+   {
+      size_t Controls = 0;
+      double Milliseconds = 0;
+      size_t ResidentBytes = 0;
+      size_t ArenaBytes = 0;
+   };
+
+   /// <summary>
+   /// Builds the layout once in this process. The synthetic layout is about 10k controls built in code,
+   /// the others are parsed from the gui resources.
+   /// </summary>
+   bool Build(const std::string& layout, bool useArena, BuildResult& result)
+   {
+      std::string xml;
+      if (layout != "synthetic")
+      {
+         XmlToUiUtil::Init();
+         xml = ReadFile(GUI_RES_DIR + layout);
+         if (xml.empty())
+         {
+            return false;
+         }
+      }
+
+      std::unique_ptr<ControlArena> arena = useArena ? std::make_unique<ControlArena>() : nullptr;
+      std::unique_ptr<TestTree> tree;
+      std::vector<std::unique_ptr<GuiControlBase>> owned;
+      std::vector<GuiControlBase*> roots;
+      bool built = true;
+
+      size_t residentBefore = ResidentBytes();
+      auto start = std::chrono::steady_clock::now();
+      if (xml.empty())
+      {
+         ControlArena::Scope scope(arena.get());
+         tree = std::make_unique<TestTree>(100, 26, 3);
+      }
+      else
+      {
+         built = XmlToUiUtil::ConstructLayoutFromXmlText(xml, owned, roots, arena.get());
+      }
+      auto end = std::chrono::steady_clock::now();
+
+      result.Milliseconds = std::chrono::duration<double, std::milli>(end - start).count();
+      result.ResidentBytes = ResidentBytes() - residentBefore;
+      result.Controls = tree ? tree->Owned.size() : owned.size();
+      result.ArenaBytes = arena ? arena->GetBytesAllocated() : 0;
+
+      // The controls go before their arena.
+      tree.reset();
+      owned.clear();
+      return built;
+   }
+
+   bool RunChild(const std::string& self, const std::string& layout, const char* allocator, BuildResult& result)
+   {
+      std::string command = "\"" + self + "\" " + layout + " " + allocator;
+      FILE* child = popen(command.c_str(), "r");
+      if (child == nullptr)
+      {
+         return false;
+      }
+
+      int read = fscanf(child, "%zu %lf %zu %zu", &result.Controls, &result.Milliseconds,
+         &result.ResidentBytes, &result.ArenaBytes);
+      return pclose(child) == 0 && read == 4;
+   }
+
+   template <typename T>
+   T Median(std::vector<T> values)
+   {
+      std::sort(values.begin(), values.end());
+      return values[values.size() / 2];
+   }
+
+   void Report(const std::string& self, const std::string& layout, const char* allocator, int runs)
+   {
+      std::vector<double> milliseconds;
+      std::vector<size_t> residentBytes;
+      BuildResult result;
+
+      for (int run = 0; run < runs; run++)
+      {
+         if (!RunChild(self, layout, allocator, result))
+         {
+            std::cout << layout << " " << allocator << ": failed to build" << std::endl;
+            return;
+         }
+
+         milliseconds.push_back(result.Milliseconds);
+         residentBytes.push_back(result.ResidentBytes);
+      }
+
+      std::cout << layout << " " << allocator << ": " << result.Controls << " controls, median of " << runs
+         << " runs " << Median(milliseconds) << " ms +" << Median(residentBytes) / 1024 << " KiB rss";
+      if (result.ArenaBytes > 0)
+      {
+         std::cout << " (" << result.ArenaBytes / 1024 << " KiB in the arena)";
+      }
+
+      std::cout << std::endl;
+   }
+}
+
+int main(int argc, char** argv)
+{
+   if (argc == 3)
+   {
+      BuildResult result;
+      if (!Build(argv[1], std::string(argv[2]) == "arena", result))
+      {
+         return 1;
+      }
+
+      std::printf("%zu %f %zu %zu\n", result.Controls, result.Milliseconds, result.ResidentBytes, result.ArenaBytes);
+      return 0;
+   }
+
+   int runs = argc == 2 ? std::max(1, std::atoi(argv[1])) : 5;
+   for (const char* layout : Layouts)
+   {
+      Report(argv[0], layout, "heap", runs);
+      Report(argv[0], layout, "arena", runs);
+   }
+
+   return 0;
+}
@@ -0,0 +1,101 @@
+#include <gtest/gtest.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "ControlArena.h"
+#include "XmlToUi.h"
+
+using namespace wgui;
+
+namespace
+{
+   /// <summary>
+   /// Groups of rows of labels, buttons and checkboxes, about 10k controls in total.
+   /// </summary>
+   std::string SyntheticLayout()
+   {
+      std::string xml = "<GuiRoot>\n";
+      for (int group = 0; group < 100; group++)
+      {
+         xml += "<Group Title=\"Group " + std::to_string(group) + "\" Scrollable=\"True\">\n";
+         for (int row = 0; row < 26; row++)
+         {
+            xml += "<DynamicRow Height=\"24\" Tag=\"Row\">"
+               "<Label Text=\"Bigram\" TextAlign=\"FLAGS:CenterLeft\"/>"
+               "<Button Text=\"Details\"/>"
+               "<Checkbox Text=\"Pinned\" Checked=\"False\"/>"
+               "</DynamicRow>\n";
+         }
+         xml += "</Group>\n";
+      }
+
+      return xml + "</GuiRoot>\n";
+   }
+
+   class LayoutArenaTests : public testing::Test
+   {
+   protected:
+      static void SetUpTestSuite()
+      {
+         XmlToUiUtil::Init();
+      }
+   };
+}
+
+TEST_F(LayoutArenaTests, ScopesPickTheArena)
+{
+   ControlArena outer;
+   ControlArena inner;
+   EXPECT_EQ(nullptr, ControlArena::GetCurrent());
+
+   {
+      ControlArena::Scope outerScope(&outer);
+      std::unique_ptr<GuiControlBase> label = std::make_unique<GuiLabel>("Label", eTextAlignmentFlags::CenterLeft);
+      size_t outerBytes = outer.GetBytesAllocated();
+      EXPECT_GT(outerBytes, sizeof(GuiLabel));
+
+      {
+         // A null arena keeps building next to the enclosing control.
+         ControlArena::Scope keepScope(nullptr);
+         EXPECT_EQ(&outer, ControlArena::GetCurrent());
+
+         ControlArena::Scope innerScope(&inner);
+         std::unique_ptr<GuiControlBase> row = std::make_unique<GuiLayoutRowDynamic>(20);
+         row->AddChild(label.get());
+         EXPECT_GT(inner.GetBytesAllocated(), 0u);
+         EXPECT_EQ(outerBytes, outer.GetBytesAllocated());
+      }
+
+      EXPECT_EQ(&outer, ControlArena::GetCurrent());
+      EXPECT_EQ("Label", label->GetAttributes()->Get<AttrString>(GuiLabel::TextAttr)->Get());
+   }
+
+   EXPECT_EQ(nullptr, ControlArena::GetCurrent());
+
+   // Outside of any scope controls are plain heap objects.
+   size_t outerBytes = outer.GetBytesAllocated();
+   std::unique_ptr<GuiControlBase> heapLabel = std::make_unique<GuiLabel>("Heap", eTextAlignmentFlags::CenterLeft);
+   EXPECT_EQ(outerBytes, outer.GetBytesAllocated());
+}
+
+TEST_F(LayoutArenaTests, ArenaLayoutsMatchHeapLayouts)
+{
+   std::string xml = SyntheticLayout();
+   ControlArena arena;
+   std::vector<std::unique_ptr<GuiControlBase>> heapOwned, arenaOwned;
+   std::vector<GuiControlBase*> heapRoots, arenaRoots;
+
+   ASSERT_TRUE(XmlToUiUtil::ConstructLayoutFromXmlText(xml, heapOwned, heapRoots));
+   ASSERT_TRUE(XmlToUiUtil::ConstructLayoutFromXmlText(xml, arenaOwned, arenaRoots, &arena));
+
+   ASSERT_EQ(heapOwned.size(), arenaOwned.size());
+   EXPECT_GT(arenaOwned.size(), 10000u);
+   for (size_t i = 0; i < heapOwned.size(); i++)
+   {
+      EXPECT_EQ(heapOwned[i]->GetLabel(), arenaOwned[i]->GetLabel());
+      EXPECT_EQ(heapOwned[i]->GetAttributes()->Size(), arenaOwned[i]->GetAttributes()->Size());
+   }
+
+   arenaOwned.clear();
+}
@@ -0,0 +1,189 @@
+#include <gtest/gtest.h>
+#include <string>
+
+#include "Window.h"
+#include "StandardControls.h"
+#include "NkTestContext.h"
+
+using namespace wgui;
+
+namespace
+{
+   /// <summary>
+   /// Headless window that is never created, only its scale and style revision are read when measuring.
+   /// </summary>
+   class MeasureWindow : public HeadlessWindow
+   {
+   public:
+      MeasureWindow()
+      {
+         SetScale(1.0);
+      }
+
+      void SetScale(double scale)
+      {
+         mContentScaleX = scale;
+         mContentScaleY = scale;
+      }
+   };
+
+   /// <summary>
+   /// Fixed height plus its children, counting how often it is measured.
+   /// </summary>
+   class CountingControl : public ChildSupportingGuiControlBase
+   {
+   public:
+      CountingControl(float height) : Height(height)
+      {
+         mAttributes->Add<AttrString>("Text");
+      }
+
+      eControlType GetControlType() const override { return eControlType::Widget; }
+      std::string GetLabel() const override { return "Counting"; }
+      void ChildRender(WindowBase* const window, nk_context* context) override { }
+
+      float GetHeight(WindowBase* const window, nk_context* context) const override
+      {
+         Measured++;
+         return Height + GetTotalChildHeight(window, context);
+      }
+
+      float GetVerticalSpacing(WindowBase* const window, nk_context* context) const override { return 0; }
+
+      mutable int Measured = 0;
+      int Changed = 0;
+      float Height;
+
+   protected:
+      void OnSubtreeChanged() override { Changed++; }
+   };
+
+   /// <summary>
+   /// Root with two children, the first of which holds a leaf.
+   /// </summary>
+   class LayoutHeightTests : public testing::Test
+   {
+   protected:
+      LayoutHeightTests()
+         : Root(10), Branch(20), Sibling(30), Leaf(40)
+      {
+         Root.AddChild(&Branch);
+         Root.AddChild(&Sibling);
+         Branch.AddChild(&Leaf);
+      }
+
+      float Measure()
+      {
+         return Root.GetLayoutHeight(&Window, &Test.Context);
+      }
+
+      TestContext Test;
+      MeasureWindow Window;
+      CountingControl Root;
+      CountingControl Branch;
+      CountingControl Sibling;
+      CountingControl Leaf;
+   };
+}
+
+TEST_F(LayoutHeightTests, MeasuresOnceUntilSomethingChanges)
+{
+   EXPECT_EQ(100, Measure());
+   EXPECT_EQ(100, Measure());
+   EXPECT_EQ(60, Branch.GetLayoutHeight(&Window, &Test.Context));
+
+   for (CountingControl* control : { &Root, &Branch, &Sibling, &Leaf })
+   {
+      EXPECT_EQ(1, control->Measured);
+   }
+}
+
+TEST_F(LayoutHeightTests, InvalidateLayoutReachesEveryAncestor)
+{
+   Measure();
+   Leaf.Height = 50;
+   Leaf.InvalidateLayout();
+
+   EXPECT_EQ(110, Measure());
+   EXPECT_EQ(2, Root.Measured);
+   EXPECT_EQ(2, Branch.Measured);
+   EXPECT_EQ(2, Leaf.Measured);
+
+   // Siblings of the path keep their height.
+   EXPECT_EQ(1, Sibling.Measured);
+
+   // So do new children.
+   CountingControl added(5);
+   Sibling.AddChild(&added);
+   EXPECT_EQ(115, Measure());
+   EXPECT_EQ(3, Root.Measured);
+   EXPECT_EQ(2, Branch.Measured);
+   EXPECT_EQ(2, Sibling.Measured);
+}
+
+TEST_F(LayoutHeightTests, StyleAndScaleChangesMeasureAgain)
+{
+   Measure();
+   Window.NotifyStyleChanged();
+   Measure();
+   Window.SetScale(2.0);
+   Measure();
+   Measure();
+
+   for (CountingControl* control : { &Root, &Branch, &Sibling, &Leaf })
+   {
+      EXPECT_EQ(3, control->Measured);
+   }
+
+   // Measured against another window.
+   MeasureWindow other;
+   Root.GetLayoutHeight(&other, &Test.Context);
+   EXPECT_EQ(4, Root.Measured);
+}
+
+TEST_F(LayoutHeightTests, InvalidateRenderReachesEveryAncestor)
+{
+   Root.Changed = Branch.Changed = Sibling.Changed = Leaf.Changed = 0;
+
+   // Cached groups recapture between changes, so unlike heights every change is reported.
+   Leaf.InvalidateLayout();
+   Leaf.InvalidateLayout();
+   Leaf.InvalidateRender();
+
+   EXPECT_EQ(3, Root.Changed);
+   EXPECT_EQ(3, Branch.Changed);
+   EXPECT_EQ(3, Leaf.Changed);
+   EXPECT_EQ(0, Sibling.Changed);
+}
+
+TEST_F(LayoutHeightTests, AttributeWritesReachEveryAncestor)
+{
+   Root.Changed = Branch.Changed = Sibling.Changed = Leaf.Changed = 0;
+   AttrString* text = Leaf.GetAttributes()->Get<AttrString>("Text");
+
+   text->Set("Changed");
+   EXPECT_EQ(1, Root.Changed);
+   EXPECT_EQ(1, Branch.Changed);
+   EXPECT_EQ(1, Leaf.Changed);
+   EXPECT_EQ(0, Sibling.Changed);
+
+   // Writing the same value again isn't a change.
+   text->Set("Changed");
+   EXPECT_EQ(1, Leaf.Changed);
+
+   // Neither are writes through the reference, those belong to nuklear.
+   text->GetRef() = "Unreported";
+   EXPECT_EQ(1, Leaf.Changed);
+}
+
+TEST_F(LayoutHeightTests, AttributeWritesMeasureAgain)
+{
+   Measure();
+   Leaf.GetAttributes()->Get<AttrString>("Text")->Set("Longer text");
+   Measure();
+
+   EXPECT_EQ(2, Root.Measured);
+   EXPECT_EQ(2, Branch.Measured);
+   EXPECT_EQ(2, Leaf.Measured);
+   EXPECT_EQ(1, Sibling.Measured);
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <memory>
+
+#include "include_nuk.h"
+
+/// <summary>
+/// Nuklear context with the embedded font and no gl, enough to push commands and convert them.
+/// The buffers take the output of a convert.
+/// </summary>
+struct TestContext
+{
+   TestContext()
+   {
+      nk_font_atlas_init_default(&Atlas);
+      nk_font_atlas_begin(&Atlas);
+      nk_font* font = nk_font_atlas_add_default(&Atlas, 14, nullptr);
+      int width, height;
+      nk_font_atlas_bake(&Atlas, &width, &height, NK_FONT_ATLAS_RGBA32);
+      nk_font_atlas_end(&Atlas, nk_handle_id(1), &Glfw->ogl.tex_null);
+      nk_init_default(&Context, &font->handle);
+      nk_glfw3_fill_convert_config(Glfw.get(), NK_ANTI_ALIASING_ON, &Config);
+
+      nk_buffer_init_default(&Commands);
+      nk_buffer_init_default(&Vertices);
+      nk_buffer_init_default(&Elements);
+   }
+
+   ~TestContext()
+   {
+      nk_buffer_free(&Commands);
+      nk_buffer_free(&Vertices);
+      nk_buffer_free(&Elements);
+      nk_free(&Context);
+      nk_font_atlas_clear(&Atlas);
+   }
+
+   TestContext(const TestContext&) = delete;
+   TestContext& operator=(const TestContext&) = delete;
+
+   void ClearBuffers()
+   {
+      nk_buffer_clear(&Commands);
+      nk_buffer_clear(&Vertices);
+      nk_buffer_clear(&Elements);
+   }
+
+   nk_size GetVertexCount() const
+   {
+      return Vertices.allocated / sizeof(nk_glfw_vertex);
+   }
+
+   std::unique_ptr<nk_glfw> Glfw = std::make_unique<nk_glfw>();
+   nk_font_atlas Atlas;
+   nk_context Context;
+   nk_convert_config Config;
+   nk_buffer Commands;
+   nk_buffer Vertices;
+   nk_buffer Elements;
+};
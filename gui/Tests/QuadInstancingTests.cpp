@@ -0,0 +1,171 @@
+#include <gtest/gtest.h>
+#include <string>
+
+#include "NkTestContext.h"
+
+namespace
+{
+   /// <summary>
+   /// The shared context with a quad frame to build instances into.
+   /// </summary>
+   struct QuadTestContext : TestContext
+   {
+      QuadTestContext()
+      {
+         nk_glfw3_quad_frame_init(&Quads);
+      }
+
+      ~QuadTestContext()
+      {
+         nk_glfw3_quad_frame_free(&Quads);
+      }
+
+      nk_glfw_quad_frame Quads;
+   };
+
+   /// <summary>
+   /// An analysis screen: a table of key names and numbers with a few buttons in between.
+   /// </summary>
+   void BuildLayout(nk_context* ctx)
+   {
+      nk_input_begin(ctx);
+      nk_input_end(ctx);
+
+      if (nk_begin(ctx, "Analysis", nk_rect(0, 0, 1200, 1400), NK_WINDOW_BORDER | NK_WINDOW_TITLE))
+      {
+         for (int row = 0; row < 60; row++)
+         {
+            nk_layout_row_dynamic(ctx, 20, 6);
+            nk_label(ctx, ("Bigram " + std::to_string(row)).c_str(), NK_TEXT_LEFT);
+            nk_label(ctx, std::to_string(row * 0.137).c_str(), NK_TEXT_RIGHT);
+            nk_label(ctx, std::to_string(row * 1.91).c_str(), NK_TEXT_RIGHT);
+            nk_label(ctx, "Left index", NK_TEXT_LEFT);
+            nk_label(ctx, "Same finger", NK_TEXT_LEFT);
+            if (row % 10 == 0)
+            {
+               nk_button_label(ctx, "Details");
+            }
+            else
+            {
+               nk_label(ctx, "Roll in", NK_TEXT_LEFT);
+            }
+         }
+      }
+      nk_end(ctx);
+   }
+
+   template <typename T>
+   const T* Items(const nk_buffer& buffer, nk_size& count)
+   {
+      count = buffer.allocated / sizeof(T);
+      return static_cast<const T*>(nk_buffer_memory_const(&buffer));
+   }
+}
+
+TEST(QuadInstancingTests, BatchesCoverTheFrameInOrder)
+{
+   QuadTestContext test;
+   const float tolerance = NK_GLFW_TESSELLATION_TOLERANCE;
+
+   BuildLayout(&test.Context);
+   ASSERT_EQ(NK_CONVERT_SUCCESS, nk_glfw3_convert(&test.Context, &test.Commands, &test.Vertices,
+      &test.Elements, &test.Config, tolerance));
+   nk_size convertedElements = test.Elements.allocated / sizeof(nk_draw_index);
+
+   nk_buffer_clear(&test.Commands);
+   nk_glfw3_build_quads(&test.Context, &test.Commands, &test.Quads, &test.Config, tolerance);
+   nk_clear(&test.Context);
+
+   nk_size instanceCount, batchCount;
+   Items<nk_glfw_quad_instance>(test.Quads.instances, instanceCount);
+   const nk_glfw_quad_batch* batches = Items<nk_glfw_quad_batch>(test.Quads.batches, batchCount);
+   nk_size elementCount = test.Quads.elements.allocated / sizeof(nk_draw_index);
+
+   // Every quad would have been 6 indices, the rest is converted exactly like nk_glfw3_convert does.
+   EXPECT_GT(instanceCount, 1000u);
+   EXPECT_EQ(convertedElements, instanceCount * 6 + elementCount);
+
+   // Both kinds are covered once, each in increasing order.
+   nk_uint nextInstance = 0;
+   nk_uint nextElement = 0;
+   for (nk_size i = 0; i < batchCount; i++)
+   {
+      EXPECT_GT(batches[i].count, 0u);
+      if (batches[i].elements)
+      {
+         EXPECT_EQ(nextElement, batches[i].first);
+         nextElement = batches[i].first + batches[i].count;
+      }
+      else
+      {
+         EXPECT_EQ(nextInstance, batches[i].first);
+         nextInstance = batches[i].first + batches[i].count;
+      }
+   }
+
+   EXPECT_EQ(instanceCount, nextInstance);
+   EXPECT_EQ(elementCount, nextElement);
+}
+
+TEST(QuadInstancingTests, GlyphsMatchTheConvertedQuads)
+{
+   QuadTestContext test;
+   nk_context* ctx = &test.Context;
+   const char text[] = "Keyrita";
+
+   // The text is drawn last, so its glyphs are the last quads of both outputs.
+   nk_input_begin(ctx);
+   nk_input_end(ctx);
+   if (nk_begin(ctx, "Text", nk_rect(0, 0, 200, 100), NK_WINDOW_NO_SCROLLBAR))
+   {
+      nk_draw_text(nk_window_get_canvas(ctx), nk_rect(10.5f, 20, 150, 20), text, 7,
+         ctx->style.font, nk_rgba(0, 0, 0, 0), nk_rgb(255, 255, 255));
+   }
+   nk_end(ctx);
+
+   ASSERT_EQ(NK_CONVERT_SUCCESS, nk_glfw3_convert(ctx, &test.Commands, &test.Vertices, &test.Elements,
+      &test.Config, NK_GLFW_TESSELLATION_TOLERANCE));
+   nk_size vertexCount;
+   const nk_glfw_vertex* vertices = Items<nk_glfw_vertex>(test.Vertices, vertexCount);
+
+   nk_buffer_clear(&test.Commands);
+   nk_glfw3_build_quads(ctx, &test.Commands, &test.Quads, &test.Config, NK_GLFW_TESSELLATION_TOLERANCE);
+   nk_clear(ctx);
+
+   nk_size instanceCount;
+   const nk_glfw_quad_instance* quads = Items<nk_glfw_quad_instance>(test.Quads.instances, instanceCount);
+
+   ASSERT_GE(instanceCount, 7u);
+   ASSERT_GE(vertexCount, 7u * 4);
+   for (nk_size glyph = 0; glyph < 7; glyph++)
+   {
+      const nk_glfw_quad_instance& quad = quads[instanceCount - 7 + glyph];
+      const nk_glfw_vertex* corners = &vertices[vertexCount - (7 - glyph) * 4];
+
+      EXPECT_FLOAT_EQ(corners[0].position[0], quad.rect[0]);
+      EXPECT_FLOAT_EQ(corners[0].position[1], quad.rect[1]);
+      EXPECT_FLOAT_EQ(corners[2].position[0], quad.rect[0] + quad.rect[2]);
+      EXPECT_FLOAT_EQ(corners[2].position[1], quad.rect[1] + quad.rect[3]);
+      EXPECT_NEAR(corners[0].uv[0], quad.uv[0] / 65535.0f, 1.0f / 65535.0f);
+      EXPECT_NEAR(corners[2].uv[1], quad.uv[3] / 65535.0f, 1.0f / 65535.0f);
+   }
+}
+
+TEST(QuadInstancingTests, InstancingGeneratesLessOnTextHeavyFrames)
+{
+   QuadTestContext test;
+   const float tolerance = NK_GLFW_TESSELLATION_TOLERANCE;
+
+   BuildLayout(&test.Context);
+   nk_glfw3_convert(&test.Context, &test.Commands, &test.Vertices, &test.Elements, &test.Config, tolerance);
+   nk_buffer_clear(&test.Commands);
+   nk_glfw3_build_quads(&test.Context, &test.Commands, &test.Quads, &test.Config, tolerance);
+   nk_clear(&test.Context);
+
+   nk_size convertBytes = test.Vertices.allocated + test.Elements.allocated;
+   nk_size quadBytes = test.Quads.instances.allocated + test.Quads.vertices.allocated + test.Quads.elements.allocated;
+   EXPECT_LT(quadBytes * 2, convertBytes);
+
+   RecordProperty("ConvertBytes", static_cast<int>(convertBytes));
+   RecordProperty("QuadBytes", static_cast<int>(quadBytes));
+}
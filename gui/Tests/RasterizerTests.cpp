@@ -0,0 +1,161 @@
+#include <gtest/gtest.h>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "SoftwareRasterizer.h"
+#include "Window.h"
+#include "XmlToUi.h"
+#include "NuklearWindowRenderer.h"
+
+using namespace wgui;
+
+namespace
+{
+   RasterVertex Vertex(float x, float y, uint8_t r, uint8_t g, uint8_t b, uint8_t a, float u = 0, float v = 0)
+   {
+      return RasterVertex{ { x, y }, { u, v }, { r, g, b, a } };
+   }
+
+   /// <summary>
+   /// Two triangles covering [x0, x1) x [y0, y1), laid out like nuklear's rect fill.
+   /// </summary>
+   void DrawQuad(SoftwareRasterizer& rasterizer, float x0, float y0, float x1, float y1,
+      uint8_t r, uint8_t g, uint8_t b, uint8_t a, int texture = 0)
+   {
+      RasterVertex vertices[4] = {
+         Vertex(x0, y0, r, g, b, a, 0, 0),
+         Vertex(x1, y0, r, g, b, a, 1, 0),
+         Vertex(x1, y1, r, g, b, a, 1, 1),
+         Vertex(x0, y1, r, g, b, a, 0, 1),
+      };
+      uint16_t indices[6] = { 0, 1, 2, 0, 2, 3 };
+      rasterizer.DrawIndexed(vertices, indices, 6, texture);
+   }
+}
+
+TEST(RasterizerTests, QuadCoversExactPixels)
+{
+   SoftwareRasterizer rasterizer;
+   rasterizer.Resize(16, 16);
+   rasterizer.Clear();
+
+   DrawQuad(rasterizer, 4, 4, 8, 10, 255, 0, 0, 255);
+
+   for (int y = 0; y < 16; y++)
+   {
+      for (int x = 0; x < 16; x++)
+      {
+         bool covered = x >= 4 && x < 8 && y >= 4 && y < 10;
+         EXPECT_EQ(rasterizer.GetPixel(x, y)[0], covered ? 255 : 0) << x << ", " << y;
+      }
+   }
+}
+
+TEST(RasterizerTests, SharedEdgeBlendsOnce)
+{
+   SoftwareRasterizer rasterizer;
+   rasterizer.Resize(16, 16);
+   rasterizer.Clear(0, 0, 0, 255);
+
+   // Half transparent white, any pixel on the diagonal drawn twice would come out brighter.
+   DrawQuad(rasterizer, 0, 0, 16, 16, 255, 255, 255, 128);
+
+   for (int y = 0; y < 16; y++)
+   {
+      for (int x = 0; x < 16; x++)
+      {
+         EXPECT_NEAR(rasterizer.GetPixel(x, y)[0], 128, 1) << x << ", " << y;
+      }
+   }
+}
+
+TEST(RasterizerTests, ScissorClipsTriangles)
+{
+   SoftwareRasterizer rasterizer;
+   rasterizer.Resize(16, 16);
+   rasterizer.Clear();
+
+   rasterizer.SetScissor(2, 2, 4, 4);
+   DrawQuad(rasterizer, 0, 0, 16, 16, 0, 255, 0, 255);
+
+   EXPECT_EQ(rasterizer.GetPixel(1, 1)[1], 0);
+   EXPECT_EQ(rasterizer.GetPixel(2, 2)[1], 255);
+   EXPECT_EQ(rasterizer.GetPixel(5, 5)[1], 255);
+   EXPECT_EQ(rasterizer.GetPixel(6, 6)[1], 0);
+}
+
+TEST(RasterizerTests, TextureModulatesVertexColor)
+{
+   SoftwareRasterizer rasterizer;
+   rasterizer.Resize(8, 8);
+   rasterizer.Clear();
+
+   // 2x1 texture, left half blue, right half transparent.
+   uint8_t texels[8] = { 0, 0, 255, 255,  0, 0, 0, 0 };
+   int texture = rasterizer.AddTexture(texels, 2, 1);
+
+   DrawQuad(rasterizer, 0, 0, 8, 8, 255, 255, 255, 255, texture);
+
+   EXPECT_EQ(rasterizer.GetPixel(0, 4)[2], 255);
+   EXPECT_EQ(rasterizer.GetPixel(7, 4)[2], 0);
+   EXPECT_EQ(rasterizer.GetPixel(7, 4)[3], 0);
+}
+
+TEST(RasterizerTests, HeadlessWindowDrawsXmlLayout)
+{
+   const std::string layout =
+      "<GuiRoot>"
+      "  <Window Title=\"Pixels\" TrackWin=\"True\" Scrollable=\"False\">"
+      "    <DynamicRow Height=\"40\">"
+      "      <Button Text=\"\"/>"
+      "    </DynamicRow>"
+      "  </Window>"
+      "</GuiRoot>";
+
+   XmlToUiUtil::Init();
+   std::vector<std::unique_ptr<GuiControlBase>> ownedControls;
+   std::vector<GuiControlBase*> controlTree;
+   ASSERT_TRUE(XmlToUiUtil::ConstructLayoutFromXmlText(layout, ownedControls, controlTree));
+
+   StandardGuiRenderer renderer;
+   for (GuiControlBase* control : controlTree)
+   {
+      renderer.AddChild(control);
+   }
+   renderer.Init();
+
+   HeadlessWindow window;
+   ASSERT_TRUE(window.CreateWindow("Pixels", 200, 100));
+   window.SetRenderer(&renderer);
+   window.Render();
+
+   const nk_style& style = window.GetContext().GetGlfw()->ctx.style;
+   const nk_color button = style.button.normal.data.color;
+   const nk_color background = style.window.fixed_background.data.color;
+   const SoftwareRasterizer& rasterizer = window.GetRasterizer();
+
+   auto matches = [](const uint8_t* pixel, nk_color color)
+   {
+      return std::abs(pixel[0] - color.r) <= 1 &&
+         std::abs(pixel[1] - color.g) <= 1 &&
+         std::abs(pixel[2] - color.b) <= 1;
+   };
+
+   // The button fills the row across the window, less padding and its rounded border.
+   int filled = 0;
+   for (int y = 0; y < rasterizer.GetHeight(); y++)
+   {
+      for (int x = 0; x < rasterizer.GetWidth(); x++)
+      {
+         filled += matches(rasterizer.GetPixel(x, y), button);
+      }
+   }
+
+   EXPECT_GT(filled, 150 * 30);
+   EXPECT_LT(filled, 200 * 50);
+
+   // Below the row is the window's own background.
+   EXPECT_TRUE(matches(rasterizer.GetPixel(100, 90), background));
+}
@@ -0,0 +1,90 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <string>
+
+#include "NkTestContext.h"
+
+namespace
+{
+   /// <summary>
+   /// Lays out radio buttons, sliders, rounded buttons and a knob, then converts with the given
+   /// tolerance and returns the vertex count.
+   /// </summary>
+   nk_size ConvertLayout(TestContext& test, float tolerance)
+   {
+      nk_context* ctx = &test.Context;
+      nk_input_begin(ctx);
+      nk_input_end(ctx);
+
+      ctx->style.button.rounding = 4;
+      if (nk_begin(ctx, "Shapes", nk_rect(0, 0, 800, 900), NK_WINDOW_BORDER))
+      {
+         for (int row = 0; row < 30; row++)
+         {
+            nk_layout_row_dynamic(ctx, 22, 4);
+            nk_bool selected = row % 2;
+            nk_radio_label(ctx, "Radio", &selected);
+            nk_button_label(ctx, ("Key " + std::to_string(row)).c_str());
+            float value = row / 30.0f;
+            nk_slider_float(ctx, 0, &value, 1, 0.01f);
+            nk_label(ctx, "Label", NK_TEXT_LEFT);
+         }
+
+         nk_layout_row_static(ctx, 200, 200, 1);
+         struct nk_rect bounds;
+         if (nk_widget(&bounds, ctx))
+         {
+            nk_command_buffer* canvas = nk_window_get_canvas(ctx);
+            nk_fill_circle(canvas, bounds, nk_rgb(200, 80, 40));
+            nk_stroke_rect(canvas, bounds, 0, 2, nk_rgb(255, 255, 255));
+         }
+      }
+      nk_end(ctx);
+
+      test.ClearBuffers();
+      nk_flags result = nk_glfw3_convert(ctx, &test.Commands, &test.Vertices, &test.Elements, &test.Config, tolerance);
+      EXPECT_EQ(NK_CONVERT_SUCCESS, result);
+      nk_clear(ctx);
+      return test.GetVertexCount();
+   }
+}
+
+TEST(TessellationTests, SegmentsFollowTheRadius)
+{
+   const float tolerance = NK_GLFW_TESSELLATION_TOLERANCE;
+   const float fullCircle = 2.0f * NK_PI;
+
+   // Small shapes get far fewer than the old fixed 22 segments, large ones more.
+   EXPECT_LT(nk_glfw3_arc_segments(2.0f, fullCircle, tolerance), 22u);
+   EXPECT_GT(nk_glfw3_arc_segments(200.0f, fullCircle, tolerance), 22u);
+   EXPECT_LE(nk_glfw3_arc_segments(10000.0f, fullCircle, tolerance), (unsigned int)NK_GLFW_MAX_ARC_SEGMENTS);
+   EXPECT_GE(nk_glfw3_arc_segments(0.1f, fullCircle, tolerance), 6u);
+   EXPECT_EQ(1u, nk_glfw3_arc_segments(0.1f, NK_PI * 0.5f, tolerance));
+
+   unsigned int previous = 0;
+   for (float radius = 1.0f; radius < 100.0f; radius += 1.0f)
+   {
+      unsigned int segments = nk_glfw3_arc_segments(radius, fullCircle, tolerance);
+      EXPECT_GE(segments, previous);
+      previous = segments;
+
+      // The chords never stray further than the tolerance from the circle.
+      if (segments < NK_GLFW_MAX_ARC_SEGMENTS)
+      {
+         float sagitta = radius * (1.0f - std::cos(fullCircle / segments / 2.0f));
+         EXPECT_LE(sagitta, tolerance * 1.001f) << "radius " << radius;
+      }
+   }
+}
+
+TEST(TessellationTests, AdaptiveTessellationProducesFewerVertices)
+{
+   TestContext test;
+   nk_size fixedCount = ConvertLayout(test, 0.0f);
+   nk_size adaptiveCount = ConvertLayout(test, NK_GLFW_TESSELLATION_TOLERANCE);
+
+   EXPECT_GT(fixedCount, 0u);
+   EXPECT_LT(adaptiveCount, fixedCount);
+   RecordProperty("FixedVertices", static_cast<int>(fixedCount));
+   RecordProperty("AdaptiveVertices", static_cast<int>(adaptiveCount));
+}
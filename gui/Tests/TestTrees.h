@@ -0,0 +1,50 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "StandardControls.h"
+
+/// <summary>
+/// A root group holding groups of rows of labels, the shape of a large analysis screen.
+/// The first label of each row is tagged "First".
+/// </summary>
+struct TestTree
+{
+   TestTree(int groups, int rowsPerGroup, int labelsPerRow)
+   {
+      Root = Add(std::make_unique<wgui::GuiLayoutGroup>("Root"));
+      for (int g = 0; g < groups; g++)
+      {
+         wgui::GuiControlBase* group = Add(std::make_unique<wgui::GuiLayoutGroup>("Group " + std::to_string(g)));
+         Root->AddChild(group);
+
+         for (int r = 0; r < rowsPerGroup; r++)
+         {
+            wgui::GuiControlBase* row = Add(std::make_unique<wgui::GuiLayoutRowDynamic>(20));
+            group->AddChild(row);
+
+            for (int l = 0; l < labelsPerRow; l++)
+            {
+               wgui::GuiControlBase* label = Add(std::make_unique<wgui::GuiLabel>("Label",
+                  wgui::eTextAlignmentFlags::CenterLeft));
+               row->AddChild(label);
+               if (l == 0)
+               {
+                  label->GetAttributes()->Get<wgui::AttrString>("Tag")->GetRef() = "First";
+               }
+            }
+         }
+      }
+   }
+
+   wgui::GuiControlBase* Add(std::unique_ptr<wgui::GuiControlBase> control)
+   {
+      Owned.push_back(std::move(control));
+      return Owned.back().get();
+   }
+
+   std::vector<std::unique_ptr<wgui::GuiControlBase>> Owned;
+   wgui::GuiControlBase* Root;
+};
@@ -0,0 +1,104 @@
+#include <gtest/gtest.h>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "NkTestContext.h"
+
+namespace
+{
+   /// <summary>
+   /// A window full of the widgets the layout editor is made of, a few thousand vertices worth.
+   /// </summary>
+   void BuildLayout(nk_context* ctx)
+   {
+      nk_input_begin(ctx);
+      nk_input_end(ctx);
+
+      if (nk_begin(ctx, "Layout", nk_rect(0, 0, 1280, 1600), NK_WINDOW_BORDER | NK_WINDOW_TITLE))
+      {
+         for (int row = 0; row < 60; row++)
+         {
+            nk_layout_row_dynamic(ctx, 22, 4);
+            nk_label(ctx, ("Row " + std::to_string(row)).c_str(), NK_TEXT_LEFT);
+            nk_button_label(ctx, "Apply");
+            nk_bool checked = row % 2;
+            nk_checkbox_label(ctx, "Enabled", &checked);
+            float value = row / 60.0f;
+            nk_slider_float(ctx, 0, &value, 1, 0.01f);
+         }
+      }
+      nk_end(ctx);
+   }
+}
+
+TEST(VertexFormatTests, PackingKeepsSubpixelPrecision)
+{
+   std::vector<nk_glfw_vertex> vertices;
+   for (int i = 0; i < 4096; i++)
+   {
+      nk_glfw_vertex vertex;
+      vertex.position[0] = i * 0.37f;
+      vertex.position[1] = 4000.0f - i * 0.61f;
+      vertex.uv[0] = (i % 997) / 997.0f;
+      vertex.uv[1] = 1.0f - (i % 613) / 613.0f;
+      vertex.col[0] = static_cast<nk_byte>(i);
+      vertex.col[1] = static_cast<nk_byte>(i >> 2);
+      vertex.col[2] = static_cast<nk_byte>(i >> 4);
+      vertex.col[3] = 255;
+      vertices.push_back(vertex);
+   }
+
+   std::vector<nk_glfw_packed_vertex> packed(vertices.size());
+   nk_glfw3_pack_vertices(packed.data(), vertices.data(), vertices.size());
+
+   const float subpixels = static_cast<float>(NK_GLFW_POSITION_SUBPIXELS);
+   for (size_t i = 0; i < vertices.size(); i++)
+   {
+      EXPECT_NEAR(packed[i].position[0] / subpixels, vertices[i].position[0], 0.5f / subpixels);
+      EXPECT_NEAR(packed[i].position[1] / subpixels, vertices[i].position[1], 0.5f / subpixels);
+      EXPECT_NEAR(packed[i].uv[0] / 65535.0f, vertices[i].uv[0], 1.0f / 65535.0f);
+      EXPECT_NEAR(packed[i].uv[1] / 65535.0f, vertices[i].uv[1], 1.0f / 65535.0f);
+      EXPECT_EQ(0, memcmp(packed[i].col, vertices[i].col, sizeof(packed[i].col)));
+   }
+}
+
+TEST(VertexFormatTests, PackingClampsOutOfRangeValues)
+{
+   nk_glfw_vertex vertices[2] = {};
+   vertices[0].position[0] = 1.0e6f;
+   vertices[0].position[1] = -1.0e6f;
+   vertices[0].uv[0] = 1.5f;
+   vertices[0].uv[1] = -0.5f;
+   vertices[1].position[0] = -0.1f;
+
+   nk_glfw_packed_vertex packed[2];
+   nk_glfw3_pack_vertices(packed, vertices, 2);
+
+   EXPECT_EQ(32767, packed[0].position[0]);
+   EXPECT_EQ(-32768, packed[0].position[1]);
+   EXPECT_EQ(65535, packed[0].uv[0]);
+   EXPECT_EQ(0, packed[0].uv[1]);
+   EXPECT_EQ(0, packed[1].position[0]);
+}
+
+TEST(VertexFormatTests, PackedUploadIsSmaller)
+{
+   TestContext test;
+   BuildLayout(&test.Context);
+   ASSERT_EQ(NK_CONVERT_SUCCESS, nk_convert(&test.Context, &test.Commands, &test.Vertices, &test.Elements, &test.Config));
+
+   nk_size count = test.GetVertexCount();
+   std::vector<nk_glfw_packed_vertex> packed(count);
+   nk_glfw3_pack_vertices(packed.data(), static_cast<const nk_glfw_vertex*>(nk_buffer_memory_const(&test.Vertices)), count);
+
+   nk_size floatBytes = count * sizeof(nk_glfw_vertex);
+   nk_size packedBytes = packed.size() * sizeof(nk_glfw_packed_vertex);
+
+   ASSERT_GT(count, 1000u);
+   EXPECT_EQ(floatBytes * 12, packedBytes * 20);
+
+   RecordProperty("Vertices", static_cast<int>(count));
+   RecordProperty("FloatBytes", static_cast<int>(floatBytes));
+   RecordProperty("PackedBytes", static_cast<int>(packedBytes));
+}
@@ -14,13 +14,14 @@ namespace wgui
    {
       for (xml_attribute_iterator attr = ctrl->attributes_begin(); attr != ctrl->attributes_end(); ++attr)
       {
-         bool attrExists = pCtrl->AttributeExists(attr->name());
+         attr_name_id_t name = AttributeNames::Intern(attr->name());
+         bool attrExists = pCtrl->AttributeExists(name);
          attr_type_id_t typeHint = AttributeTypeManager::NotAType;
 
          if (attrExists)
          {
             // Try to parse it using the hinted attribute type.
-            typeHint = pCtrl->GetAttributeType(attr->name());
+            typeHint = pCtrl->GetAttributeType(name);
          }
 
          std::unique_ptr<Attribute> parsedAttr = nullptr;
@@ -53,12 +54,12 @@ namespace wgui
             }
             else
             {
-               pCtrl->GetAttributes()->Set(attr->name(), std::move(parsedAttr));
+               pCtrl->GetAttributes()->Set(name, std::move(parsedAttr));
             }
          }
          else
          {
-            pCtrl->GetAttributes()->Get(attr->name())->SetValue(std::move(parsedAttr));
+            pCtrl->GetAttributes()->Get(name)->SetValue(std::move(parsedAttr));
          }
       }
    }
@@ -111,7 +112,8 @@ namespace wgui
 
    bool XmlToUiUtil::ConstructLayoutFromXmlFile(const std::string& fileName, 
       std::vector<std::unique_ptr<GuiControlBase>>& ownedControls,
-      std::vector<GuiControlBase*>& controlTree)
+      std::vector<GuiControlBase*>& controlTree,
+      ControlArena* arena)
    {
       controlTree.clear();
       ownedControls.clear();
@@ -137,6 +139,7 @@ namespace wgui
       }
 
       // Here, we will only work within the window tags. Ignore everything else.
+      ControlArena::Scope scope(arena);
       ConstructControls(doc.first_child().children(), nullptr, ownedControls, controlTree);
 
       return true;
@@ -144,7 +147,8 @@ namespace wgui
 
    bool XmlToUiUtil::ConstructLayoutFromXmlText(const std::string& text,
       std::vector<std::unique_ptr<GuiControlBase>>& ownedControls,
-      std::vector<GuiControlBase*>& controlTree)
+      std::vector<GuiControlBase*>& controlTree,
+      ControlArena* arena)
    {
       controlTree.clear();
       ownedControls.clear();
@@ -170,13 +174,33 @@ namespace wgui
       }
 
       // Here, we will only work within the window tags. Ignore everything else.
+      ControlArena::Scope scope(arena);
       ConstructControls(doc.first_child().children(), nullptr, ownedControls, controlTree);
 
       return true;
    }
 
-   bool XmlRenderer::ConstructLayoutFromXmlFile(const std::string& fileName)
+   bool XmlRenderer::ConstructLayoutFromXmlFile(const std::string& fileName, bool useArena)
    {
-      return XmlToUiUtil::ConstructLayoutFromXmlFile(fileName, mOwnedControls, mControls);
+      // The previous layout has to go before the arena it was built in.
+      mControls.clear();
+      mOwnedControls.clear();
+      mArena = useArena ? std::make_unique<ControlArena>() : nullptr;
+
+      bool constructed = XmlToUiUtil::ConstructLayoutFromXmlFile(fileName, mOwnedControls, mControls, mArena.get());
+
+      // Nothing links the parents of the new controls or initializes them otherwise.
+      if (constructed && mInitialized)
+      {
+         Init();
+      }
+
+      return constructed;
+   }
+
+   void XmlRenderer::Init()
+   {
+      StandardGuiRenderer::Init();
+      mInitialized = true;
    }
 }
\ No newline at end of file
@@ -1,9 +1,21 @@
 #pragma once
 
 #include "Window.h"
+#include <atomic>
 
 namespace wgui
 {
+   /// <summary>
+   /// How the application loop waits between frames.
+   /// Idle blocks on window events while nothing is happening, Continuous renders every
+   /// iteration and is meant for benchmarking.
+   /// </summary>
+   enum class eRenderMode
+   {
+      Idle,
+      Continuous
+   };
+
    class Application
    {
    public:
@@ -31,6 +43,34 @@ namespace wgui
 
       static void RenderWindows();
 
+      static void SetRenderMode(eRenderMode mode) { mRenderMode = mode; }
+      static eRenderMode GetRenderMode() { return mRenderMode; }
+
+      /// <summary>
+      /// Opt-in: every window gets a render thread that presents at its own monitor's rate,
+      /// RenderWindows then only pumps events and posts input. Set before the loop starts.
+      /// </summary>
+      static void SetThreadedRendering(bool threaded) { mThreadedRendering = threaded; }
+      static bool GetThreadedRendering() { return mThreadedRendering; }
+
+      /// <summary>
+      /// Longest time an idle loop blocks before rendering anyway, in seconds.
+      /// </summary>
+      static void SetIdleTimeout(double seconds) { mIdleTimeout = seconds; }
+
+      /// <summary>
+      /// Wakes the loop up if it is blocked waiting for events so the next frames get rendered.
+      /// Safe to call from any thread, meant for background jobs that changed what's on screen.
+      /// </summary>
+      static void WakeUp();
+
+      /// <summary>
+      /// Keeps the loop from idling for at least the given number of frames.
+      /// Safe to call from any thread.
+      /// </summary>
+      static void RequestAnimationFrames(int frameCount);
+      static bool Animating() { return mAnimationFrames.load() > 0; }
+
       /// <summary>
       /// Returns window associated with the GLFWwindow* 
       /// nullptr if it doesn't exist.
@@ -65,7 +105,17 @@ namespace wgui
          mWindows[window->GetContext().GetGlfw()->win] = window;
       }
 
+      static void WaitForNextFrame(bool presented, bool inputActive);
+      static void PostWindowInput();
+
       static std::map<GLFWwindow*, wgui::WindowBase*> mWindows;
       static MainWindow* mMainWindow;
+
+      static eRenderMode mRenderMode;
+      static bool mThreadedRendering;
+      static double mIdleTimeout;
+      static int mFramesUntilIdle;
+      static std::atomic<bool> mWakeRequested;
+      static std::atomic<int> mAnimationFrames;
    };
 }
@@ -6,12 +6,75 @@
 #include <functional>
 #include <cstdint>
 #include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
 
 #include "AttributeFlags.h"
+#include "ControlArena.h"
 
 namespace wgui
 {
    typedef int64_t attr_type_id_t;
+   typedef uint32_t attr_name_id_t;
+
+   /// <summary>
+   /// Global table of attribute names. Names differing only in case share one id, so attribute sets
+   /// compare integers instead of case folding strings on every lookup.
+   /// </summary>
+   class AttributeNames
+   {
+   public:
+      static constexpr attr_name_id_t NotAName = UINT32_MAX;
+
+      /// <summary>
+      /// Id of the name, added to the table the first time it's seen. Safe to call from any thread.
+      /// </summary>
+      static attr_name_id_t Intern(std::string_view name);
+
+      /// <summary>
+      /// Id of the name or NotAName, never adds to the table. Lookups from any number of threads
+      /// only share a reader lock, they wait on nothing but a name being interned.
+      /// </summary>
+      static attr_name_id_t Find(std::string_view name);
+
+      /// <summary>
+      /// The name with the case it was first interned with.
+      /// </summary>
+      static std::string_view GetName(attr_name_id_t id);
+
+      /// <summary>
+      /// Id of a constant name, interned by the first call only and kept in a static after that,
+      /// so control constructors don't go through the table for their own attributes.
+      /// </summary>
+      template <const std::string_view& Name>
+      static attr_name_id_t Of()
+      {
+         static const attr_name_id_t id = Intern(Name);
+         return id;
+      }
+
+   private:
+      struct FoldedHash
+      {
+         using is_transparent = void;
+         size_t operator()(std::string_view name) const;
+      };
+
+      struct FoldedEqual
+      {
+         using is_transparent = void;
+         bool operator()(std::string_view a, std::string_view b) const;
+      };
+
+      static AttributeNames& Instance();
+
+      std::shared_mutex mMutex;
+      std::unordered_map<std::string, attr_name_id_t, FoldedHash, FoldedEqual> mIds;
+      std::vector<const std::string*> mNames;
+   };
 
    class AttributeTypeManager
    {
@@ -113,12 +176,27 @@ namespace wgui
       static attr_type_id_t AlignFlagsId;
    };
 
-   class CtrlAttribute
+   /// <summary>
+   /// Told when an attribute of the set it watches is written through Set, an assignment or a copy.
+   /// Writes through GetRef aren't seen, those references are for nuklear to update values while drawing.
+   /// </summary>
+   class AttributeObserver
+   {
+   public:
+      virtual void OnAttributeChanged(attr_name_id_t name) = 0;
+
+   protected:
+      ~AttributeObserver() = default;
+   };
+
+   class CtrlAttribute : public ArenaAllocated
    {
    public:
       CtrlAttribute(attr_type_id_t typeId)
          : mType(typeId) { }
 
+      virtual ~CtrlAttribute() = default;
+
       attr_type_id_t GetType() const { return mType; }
 
       /// <summary>
@@ -128,8 +206,41 @@ namespace wgui
       /// <param name="other"></param>
       virtual void Copy(CtrlAttribute* other) = 0;
 
+      /// <summary>
+      /// Set by the attribute set holding this attribute, later writes are reported under the name.
+      /// </summary>
+      void Observe(AttributeObserver* observer, attr_name_id_t name)
+      {
+         mObserver = observer;
+         mName = name;
+      }
+
+   protected:
+      void NotifyChanged()
+      {
+         if (mObserver != nullptr)
+         {
+            mObserver->OnAttributeChanged(mName);
+         }
+      }
+
+      /// <summary>
+      /// Writes the value and reports it if it differs, so setting the same value every frame costs nothing.
+      /// </summary>
+      template <typename T>
+      void Write(T& value, const T& newValue)
+      {
+         if (value != newValue)
+         {
+            value = newValue;
+            NotifyChanged();
+         }
+      }
+
    private:
       attr_type_id_t mType;
+      attr_name_id_t mName = AttributeNames::NotAName;
+      AttributeObserver* mObserver = nullptr;
    };
 
    class AttrInt : public CtrlAttribute
@@ -144,17 +255,18 @@ namespace wgui
       void Copy(CtrlAttribute* other) override
       {
          mValue = reinterpret_cast<AttrInt*>(other)->mValue;
+         NotifyChanged();
       }
 
       AttrInt Set(int64_t value)
       {
-         mValue = value;
+         Write(mValue, value);
          return *this;
       }
 
       AttrInt operator = (int64_t value)
       {
-         mValue = value;
+         Write(mValue, value);
          return *this;
       }
 
@@ -179,17 +291,18 @@ namespace wgui
       void Copy(CtrlAttribute* other) override
       {
          mValue = reinterpret_cast<AttrReal*>(other)->mValue;
+         NotifyChanged();
       }
 
       AttrReal Set(double value)
       {
-         mValue = value;
+         Write(mValue, value);
          return *this;
       }
 
       AttrReal operator = (double value)
       {
-         mValue = value;
+         Write(mValue, value);
          return *this;
       }
 
@@ -214,17 +327,18 @@ namespace wgui
       void Copy(CtrlAttribute* other) override
       {
          mValue = reinterpret_cast<AttrString*>(other)->mValue;
+         NotifyChanged();
       }
 
       AttrString Set(const std::string& value)
       {
-         mValue = value;
+         Write(mValue, value);
          return *this;
       }
 
       AttrString operator = (const std::string& value)
       {
-         mValue = value;
+         Write(mValue, value);
          return *this;
       }
 
@@ -249,17 +363,18 @@ namespace wgui
       void Copy(CtrlAttribute* other) override
       {
          mValue = reinterpret_cast<AttrBool*>(other)->mValue;
+         NotifyChanged();
       }
 
       AttrBool Set(bool value)
       {
-         mValue = value;
+         Write(mValue, value);
          return *this;
       }
 
       AttrBool operator = (bool value)
       {
-         mValue = value;
+         Write(mValue, value);
          return *this;
       }
 
@@ -279,6 +394,7 @@ namespace wgui
       void Copy(CtrlAttribute* other) override
       {
          mValue = reinterpret_cast<AttrFlags*>(other)->mValue;
+         NotifyChanged();
       }
 
       int& GetRef() { return mValue; }
@@ -293,13 +409,13 @@ namespace wgui
       AttrWinFlags() : AttrFlags(AttrTypes::WinFlags()) { }
       AttrWinFlags Set(int value)
       {
-         mValue = value;
+         Write(mValue, value);
          return *this;
       }
 
       AttrWinFlags operator = (int value)
       {
-         mValue = value;
+         Write(mValue, value);
          return *this;
       }
    };
@@ -310,18 +426,18 @@ namespace wgui
       AttrAlignFlags() : AttrFlags(AttrTypes::AlignFlags()) { }
       AttrAlignFlags Set(int value)
       {
-         mValue = value;
+         Write(mValue, value);
          return *this;
       }
 
       AttrAlignFlags operator = (int value)
       {
-         mValue = value;
+         Write(mValue, value);
          return *this;
       }
    };
 
-   class Attribute
+   class Attribute : public ArenaAllocated
    {
    public:
       Attribute()
@@ -339,6 +455,14 @@ namespace wgui
          return AttributeTypeManager::NotAType;
       }
 
+      void Observe(AttributeObserver* observer, attr_name_id_t name)
+      {
+         if (mValue != nullptr)
+         {
+            mValue->Observe(observer, name);
+         }
+      }
+
       void SetValue(std::unique_ptr<Attribute> other)
       {
          if (mValue == nullptr)
@@ -398,16 +522,24 @@ namespace wgui
       std::unique_ptr<CtrlAttribute> mValue;
    };
 
-   class AttributeSet
+   /// <summary>
+   /// The attributes of one control, sorted by interned name id.
+   /// Controls have a handful of attributes, a binary search over them stays within a cache line or two.
+   /// </summary>
+   class AttributeSet : public ArenaAllocated
    {
    public:
-      AttributeSet() : mAttributes() { }
+      /// <summary>
+      /// The observer, usually the control owning the set, hears about every write to its attributes.
+      /// </summary>
+      AttributeSet(AttributeObserver* observer = nullptr)
+         : mAttributes(ControlArena::GetCurrentResource()), mObserver(observer) { }
 
-      Attribute* operator[](const std::string& name) const
+      Attribute* operator[](attr_name_id_t name) const
       {
-         auto attr = mAttributes.find(name);
+         auto attr = Find(name);
 
-         if (attr == mAttributes.end())
+         if (attr == mAttributes.end() || attr->first != name)
          {
             assert("Attribute with the given name was not found." && false);
             return nullptr;
@@ -416,33 +548,58 @@ namespace wgui
          return attr->second.get();
       }
 
-      Attribute* Get(const std::string& name) const
+      Attribute* operator[](std::string_view name) const
+      {
+         return (*this)[AttributeNames::Find(name)];
+      }
+
+      Attribute* Get(attr_name_id_t name) const
       {
          return (*this)[name];
       }
 
+      Attribute* Get(std::string_view name) const
+      {
+         return (*this)[name];
+      }
+
+      template<typename T>
+      T* Get(attr_name_id_t name) const
+         requires std::is_base_of_v<CtrlAttribute, T>
+      {
+         return (*this)[name]->As<T>();
+      }
+
       template<typename T>
-      T* Get(const std::string& name) const
+      T* Get(std::string_view name) const
          requires std::is_base_of_v<CtrlAttribute, T>
       {
          return (*this)[name]->As<T>();
       }
 
       template<typename T>
-      T* Add(const std::string& name)
+      T* Add(attr_name_id_t name)
          requires std::is_base_of_v<CtrlAttribute, T>
       {
-         auto attr = mAttributes.find(name);
+         auto attr = Find(name);
 
-         if (attr != mAttributes.end())
+         if (attr != mAttributes.end() && attr->first == name)
          {
             assert("Attribute already exists" && false);
             return nullptr;
          }
 
-         mAttributes.emplace(name, std::make_unique<Attribute>());
-         mAttributes[name]->SetType<T>();
-         return mAttributes[name].get()->As<T>();
+         attr = mAttributes.emplace(attr, name, std::make_unique<Attribute>());
+         attr->second->SetType<T>();
+         attr->second->Observe(mObserver, name);
+         return attr->second->As<T>();
+      }
+
+      template<typename T>
+      T* Add(std::string_view name)
+         requires std::is_base_of_v<CtrlAttribute, T>
+      {
+         return Add<T>(AttributeNames::Intern(name));
       }
 
       /// <summary>
@@ -450,20 +607,62 @@ namespace wgui
       /// </summary>
       /// <param name="name"></param>
       /// <param name="value"></param>
-      void Set(const std::string& name, std::unique_ptr<Attribute> value)
+      void Set(attr_name_id_t name, std::unique_ptr<Attribute> value)
+      {
+         auto attr = Find(name);
+
+         value->Observe(mObserver, name);
+         if (attr != mAttributes.end() && attr->first == name)
+         {
+            attr->second = std::move(value);
+         }
+         else
+         {
+            mAttributes.emplace(attr, name, std::move(value));
+         }
+
+         if (mObserver != nullptr)
+         {
+            mObserver->OnAttributeChanged(name);
+         }
+      }
+
+      void Set(std::string_view name, std::unique_ptr<Attribute> value)
+      {
+         Set(AttributeNames::Intern(name), std::move(value));
+      }
+
+      bool AttributeExists(attr_name_id_t name) const
       {
-         mAttributes[name] = std::move(value);
+         auto attr = Find(name);
+         return attr != mAttributes.end() && attr->first == name;
       }
 
-      bool AttributeExists(const std::string& name)
+      bool AttributeExists(std::string_view name) const
       {
-         return mAttributes.find(name) != mAttributes.end();
+         return AttributeExists(AttributeNames::Find(name));
       }
 
+      size_t Size() const { return mAttributes.size(); }
+
    private:
-      std::map<std::string,
-         std::unique_ptr<Attribute>,
-         CaseInsensitiveStrCompare> mAttributes;
+      // Shares the arena of the control it belongs to.
+      typedef std::pmr::vector<std::pair<attr_name_id_t, std::unique_ptr<Attribute>>> attributes_t;
+
+      attributes_t::const_iterator Find(attr_name_id_t name) const
+      {
+         return std::lower_bound(mAttributes.begin(), mAttributes.end(), name,
+            [](const auto& attr, attr_name_id_t id) { return attr.first < id; });
+      }
+
+      attributes_t::iterator Find(attr_name_id_t name)
+      {
+         return std::lower_bound(mAttributes.begin(), mAttributes.end(), name,
+            [](const auto& attr, attr_name_id_t id) { return attr.first < id; });
+      }
+
+      attributes_t mAttributes;
+      AttributeObserver* mObserver;
    };
 
 #pragma region Attribute Types
@@ -38,7 +38,12 @@ namespace wgui
 
       bool InitWindowContext();
       bool InitGlewContext();
-      bool InitNkContext(GLFWwindow* window);
+      /// <summary>
+      /// Sets up nuklear and the gl device for the window. With a share manager, the window's
+      /// context must have been created sharing with share's window and reuses its gl objects.
+      /// </summary>
+      bool InitNkContext(GLFWwindow* window, const NuklearGlfwContextManager* share = nullptr);
+      bool InitHeadlessNkContext();
       inline nk_context const* GetContext() const { return mNkContext; }
       inline nk_context* GetContext() { return mNkContext; }
 
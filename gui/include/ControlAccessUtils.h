@@ -100,11 +100,18 @@ namespace wgui
          requires std::is_base_of_v<GuiControlBase, T>&&
                   std::_Is_iterator_v<__ControlIterator>
       {
+         // Unknown names can't be on any control.
+         attr_name_id_t name = AttributeNames::Find(attributeName);
+         if (name == AttributeNames::NotAName)
+         {
+            return;
+         }
+
          for (auto it = begin; it != end; ++it)
          {
             T* val = dynamic_cast<T*>(*it);
 
-            if (val != nullptr && (*it)->GetAttributes()->AttributeExists(attributeName))
+            if (val != nullptr && (*it)->GetAttributes()->AttributeExists(name))
             {
                foundControls.push_back(val);
             }
@@ -122,13 +129,20 @@ namespace wgui
                   EqualityComparable<__AttrUnderlyingType> &&
                   std::_Is_iterator_v<__ControlIterator>
       {
+         // Unknown names can't be on any control.
+         attr_name_id_t name = AttributeNames::Find(attributeName);
+         if (name == AttributeNames::NotAName)
+         {
+            return;
+         }
+
          for (auto it = begin; it != end; ++it)
          {
             T* val = dynamic_cast<T*>(*it);
 
-            if (val != nullptr && (*it)->GetAttributes()->AttributeExists(attributeName))
+            if (val != nullptr && (*it)->GetAttributes()->AttributeExists(name))
             {
-               Attribute* attr = (*it)->GetAttributes()->Get(attributeName);
+               Attribute* attr = (*it)->GetAttributes()->Get(name);
                if (attr->Is<__AttrType>())
                {
                   __AttrType* attrValue = attr->As<__AttrType>();
@@ -182,11 +196,18 @@ namespace wgui
          requires std::is_base_of_v<GuiControlBase, T>&&
                   std::_Is_iterator_v<__ControlIterator>
       {
+         // Unknown names can't be on any control.
+         attr_name_id_t name = AttributeNames::Find(attributeName);
+         if (name == AttributeNames::NotAName)
+         {
+            return nullptr;
+         }
+
          for (auto it = begin; it != end; ++it)
          {
             T* val = dynamic_cast<T*>(*it);
 
-            if (val != nullptr && (*it)->GetAttributes()->AttributeExists(attributeName))
+            if (val != nullptr && (*it)->GetAttributes()->AttributeExists(name))
             {
                return val;
             }
@@ -205,13 +226,20 @@ namespace wgui
                      EqualityComparable<__AttrUnderlyingType>&&
                      std::_Is_iterator_v<__ControlIterator>
       {
+         // Unknown names can't be on any control.
+         attr_name_id_t name = AttributeNames::Find(attributeName);
+         if (name == AttributeNames::NotAName)
+         {
+            return nullptr;
+         }
+
          for (auto it = begin; it != end; ++it)
          {
             T* val = dynamic_cast<T*>(*it);
 
-            if (val != nullptr && (*it)->GetAttributes()->AttributeExists(attributeName))
+            if (val != nullptr && (*it)->GetAttributes()->AttributeExists(name))
             {
-               Attribute* attr = (*it)->GetAttributes()->Get(attributeName);
+               Attribute* attr = (*it)->GetAttributes()->Get(name);
                if (attr->Is<__AttrType>())
                {
                   __AttrType* attrValue = attr->As<__AttrType>();
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstddef>
+#include <memory_resource>
+
+namespace wgui
+{
+   /// <summary>
+   /// Monotonic memory for one layout. Controls, their attribute sets and attributes built while a
+   /// Scope of the arena is active are carved out of a few large blocks instead of thousands of small
+   /// heap allocations, and all of it is returned at once when the arena is destroyed.
+   /// Deleting an object from the arena runs its destructor but keeps the memory until then, so the
+   /// arena must outlive everything built in it. Owners declare it before the controls they own.
+   /// </summary>
+   class ControlArena
+   {
+   public:
+      static constexpr size_t DefaultBlockSize = 64 * 1024;
+
+      ControlArena(size_t initialBlockSize = DefaultBlockSize);
+
+      ControlArena(const ControlArena&) = delete;
+      ControlArena& operator=(const ControlArena&) = delete;
+
+      void* Allocate(size_t size, size_t alignment);
+      std::pmr::memory_resource* GetResource() { return &mResource; }
+
+      /// <summary>
+      /// Bytes handed out so far, the blocks reserved from the heap are somewhat larger.
+      /// </summary>
+      size_t GetBytesAllocated() const { return mBytesAllocated; }
+
+      /// <summary>
+      /// The arena of the innermost active scope on this thread, null outside of any.
+      /// </summary>
+      static ControlArena* GetCurrent();
+
+      /// <summary>
+      /// Memory resource of the current arena, the default heap resource outside of any.
+      /// </summary>
+      static std::pmr::memory_resource* GetCurrentResource();
+
+      /// <summary>
+      /// Makes the arena current on this thread for its lifetime.
+      /// A null arena leaves the current one in place, so layouts built while constructing a control
+      /// end up next to that control.
+      /// </summary>
+      class Scope
+      {
+      public:
+         Scope(ControlArena* arena);
+         ~Scope();
+
+         Scope(const Scope&) = delete;
+         Scope& operator=(const Scope&) = delete;
+
+      private:
+         ControlArena* mPrevious;
+      };
+
+   private:
+      std::pmr::monotonic_buffer_resource mResource;
+      size_t mBytesAllocated = 0;
+   };
+
+   /// <summary>
+   /// Base of everything a layout builds per control. New objects go to the current arena if there
+   /// is one and to the heap otherwise, delete tells the two apart from a small header.
+   /// </summary>
+   class ArenaAllocated
+   {
+   public:
+      static void* operator new(size_t size);
+      static void operator delete(void* memory);
+   };
+}
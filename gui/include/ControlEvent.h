@@ -2,6 +2,7 @@
 
 #include <functional>
 #include "include_nuk.h"
+#include "ControlArena.h"
 
 namespace wgui
 {
@@ -67,7 +68,7 @@ namespace wgui
    /// Events are processed by each parent until told to stop by the handler function.
    /// If a handler function does not exist, handlers still get propagated to parents.
    /// </summary>
-   class EventDispatcher
+   class EventDispatcher : public ArenaAllocated
    {
    public:
       EventDispatcher(GuiControlBase* control)
@@ -0,0 +1,128 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "include_nuk.h"
+
+namespace wgui
+{
+   class GuiControlBase;
+
+   /// <summary>
+   /// What rendering a control cost, summed over every profiled frame.
+   /// Inclusive values contain the control's children, exclusive values only the control itself.
+   /// </summary>
+   struct ControlCost
+   {
+      uint64_t Calls = 0;
+      double InclusiveMs = 0;
+      double ExclusiveMs = 0;
+      uint64_t InclusiveCommands = 0;
+      uint64_t ExclusiveCommands = 0;
+      uint64_t InclusiveVertices = 0;
+      uint64_t ExclusiveVertices = 0;
+   };
+
+   /// <summary>
+   /// Controls with the same label and tag under the same parent share a node,
+   /// so a row of fifty labels shows up as one line with fifty calls per frame.
+   /// </summary>
+   struct ControlProfileNode
+   {
+      std::string Label;
+      std::string Tag;
+      ControlCost Cost;
+      std::vector<std::unique_ptr<ControlProfileNode>> Children;
+   };
+
+   /// <summary>
+   /// Times every GuiControlBase::Render of a window and counts the nuklear commands and vertices
+   /// each control produced. Commands are counted in the context's command memory, vertices are
+   /// attributed by tagging commands with the control through the command userdata and converting
+   /// the frame once more into scratch buffers. Only the thread drawing the window records,
+   /// reports can be taken from any thread.
+   /// </summary>
+   class ControlProfiler
+   {
+   public:
+      using Clock = std::chrono::steady_clock;
+
+      ControlProfiler();
+      ~ControlProfiler();
+
+      ControlProfiler(const ControlProfiler&) = delete;
+      ControlProfiler& operator=(const ControlProfiler&) = delete;
+
+      void BeginFrame();
+      void Enter(GuiControlBase* control, nk_context* context);
+      void Exit(nk_context* context);
+
+      /// <summary>
+      /// Attributes the vertices of the frame to its controls and adds the frame to the totals.
+      /// Called after the control tree rendered and before the context is cleared, with the
+      /// tessellation tolerance the window converts with so the vertex counts match what it draws.
+      /// </summary>
+      void EndFrame(nk_context* context, const nk_convert_config& config, float tessellationTolerance);
+
+      /// <summary>
+      /// Drops the totals, takes effect at the start of the next frame.
+      /// </summary>
+      void Reset() { mResetRequested = true; }
+
+      uint64_t GetFrameCount() const;
+
+      /// <summary>
+      /// Copy of the totals with the children of every node sorted by inclusive time, most expensive first.
+      /// </summary>
+      std::unique_ptr<ControlProfileNode> GetReport() const;
+
+      /// <summary>
+      /// Writes the report as an indented tree with per frame averages.
+      /// </summary>
+      void WriteReport(std::ostream& stream) const;
+
+   private:
+      // One render of one control in the current frame, in the order the renders started.
+      struct Entry
+      {
+         ControlProfileNode* Node;
+         int Parent;
+         Clock::time_point Start;
+         nk_size CommandStart;
+         double InclusiveMs = 0;
+         double ChildMs = 0;
+         uint64_t InclusiveCommands = 0;
+         uint64_t ChildCommands = 0;
+         uint64_t ExclusiveVertices = 0;
+         uint64_t InclusiveVertices = 0;
+      };
+
+      ControlProfileNode* GetNode(GuiControlBase* control, ControlProfileNode* parent);
+      static uint64_t CountCommands(const nk_context* context, nk_size begin);
+
+      std::vector<Entry> mEntries;
+      std::vector<int> mStack;
+
+      ControlProfileNode mRoot;
+      uint64_t mFrames = 0;
+      // Keyed by control id, a rebuilt layout can put a new control at the address of an old one.
+      std::unordered_map<uint64_t, ControlProfileNode*> mNodes;
+      std::atomic<bool> mResetRequested = false;
+
+      // Scratch output of the attribution convert.
+      nk_buffer mCommands;
+      nk_buffer mVertices;
+      nk_buffer mElements;
+
+      // Guards the node tree against report readers, the per frame entries are the drawing thread's own.
+      mutable std::mutex mMutex;
+   };
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include "NuklearWindowRenderer.h"
+#include "ControlProfiler.h"
+
+namespace wgui
+{
+   /// <summary>
+   /// Renderer for a debug dialog showing the control cost tree of another window.
+   /// Turns control profiling on for that window and draws with plain nuklear calls,
+   /// so the dialog never shows up in its own report.
+   /// </summary>
+   class ControlProfilerDialog : public WindowRenderer
+   {
+   public:
+      static constexpr double RefreshSeconds = 1.0;
+
+      ControlProfilerDialog(WindowBase* target)
+         : mTarget(target)
+      {
+      }
+
+      void Init() override;
+      void RenderStart(WindowBase* const window, nk_context* context) override { }
+      void Render(WindowBase* const window, nk_context* context) override;
+      void RenderFinish(WindowBase* const window, nk_context* context) override { }
+
+   private:
+      void RenderNode(nk_context* context, const ControlProfileNode& node, const std::string& path, int depth);
+
+      WindowBase* mTarget;
+      std::unique_ptr<ControlProfileNode> mReport;
+      double mFrames = 1;
+      ControlProfiler::Clock::time_point mLastRefresh;
+   };
+}
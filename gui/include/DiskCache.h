@@ -0,0 +1,110 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <initializer_list>
+#include <string>
+#include <type_traits>
+
+namespace wgui
+{
+   /// <summary>
+   /// Read only view of a whole file mapped into memory.
+   /// </summary>
+   class MappedFile
+   {
+   public:
+      MappedFile() = default;
+      ~MappedFile() { Close(); }
+
+      MappedFile(const MappedFile&) = delete;
+      MappedFile& operator=(const MappedFile&) = delete;
+
+      bool Open(const std::string& path);
+      void Close();
+
+      bool IsOpen() const { return mData != nullptr; }
+      const uint8_t* GetData() const { return mData; }
+      size_t GetSize() const { return mSize; }
+
+   private:
+      const uint8_t* mData = nullptr;
+      size_t mSize = 0;
+   };
+
+   /// <summary>
+   /// 64 bit FNV-1a hash of everything that went into producing a cached file.
+   /// </summary>
+   class CacheKey
+   {
+   public:
+      CacheKey& Add(const void* data, size_t size)
+      {
+         const uint8_t* bytes = static_cast<const uint8_t*>(data);
+         for (size_t i = 0; i < size; i++)
+         {
+            mHash ^= bytes[i];
+            mHash *= Prime;
+         }
+
+         return *this;
+      }
+
+      template <typename T>
+      CacheKey& Add(const T& value)
+      {
+         static_assert(std::is_trivially_copyable_v<T>, "Only plain values can be hashed directly");
+         return Add(&value, sizeof(T));
+      }
+
+      uint64_t Get() const { return mHash; }
+
+   private:
+      static constexpr uint64_t Prime = 1099511628211ull;
+      uint64_t mHash = 14695981039346656037ull;
+   };
+
+   /// <summary>
+   /// Contiguous piece of a cache file's payload.
+   /// </summary>
+   struct DiskCacheChunk
+   {
+      const void* Data;
+      size_t Size;
+   };
+
+   /// <summary>
+   /// Keeps derived data (baked fonts, linked programs...) between launches.
+   /// Every file starts with the key of the inputs it was built from, a file whose key doesn't
+   /// match is treated as missing and simply overwritten by the next store.
+   /// </summary>
+   class DiskCache
+   {
+   public:
+      /// <summary>
+      /// Directory cache files are kept in, relative to the working directory like res/.
+      /// An empty directory turns caching off.
+      /// </summary>
+      static void SetDirectory(const std::string& directory) { mDirectory = directory; }
+      static const std::string& GetDirectory() { return mDirectory; }
+      static bool IsEnabled() { return !mDirectory.empty(); }
+
+      static std::string GetPath(const std::string& name);
+
+      /// <summary>
+      /// Maps the cache file at path and returns its payload, or nullptr when there is no file for key.
+      /// The payload stays valid while file is open.
+      /// </summary>
+      static const uint8_t* Load(const std::string& path, uint64_t key, MappedFile& file, size_t& payloadSize);
+
+      /// <summary>
+      /// Replaces the cache file at path with the given payload. The file is written next to
+      /// its final location and renamed over it so readers never see a partial file.
+      /// </summary>
+      static bool Store(const std::string& path, uint64_t key, std::initializer_list<DiskCacheChunk> payload);
+
+   private:
+      static std::string mDirectory;
+   };
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "include_nuk.h"
+
+namespace wgui
+{
+   enum class eFontRenderMode
+   {
+      // One coverage bitmap per content scale.
+      Bitmap,
+      // A single distance field bake drawn with the sdf shader at every scale and font size.
+      Sdf
+   };
+
+   /// <summary>
+   /// The default font baked at every content scale the application has needed so far.
+   /// Shared by the main window and its dialogs, the textures live in the main window's share group
+   /// and are released by the last of those windows to close. Moving a window to a monitor with another scale switches to an existing bake
+   /// instead of stretching the 1x glyphs or stalling on a re-bake. In sdf mode every scale shares one entry.
+   /// </summary>
+   class FontAtlasCache
+   {
+   public:
+      struct Entry
+      {
+         int ScaleKey;
+         nk_font_atlas Atlas;
+         nk_font* Font;
+         GLuint Texture;
+         nk_draw_null_texture TexNull;
+         bool Sdf;
+      };
+
+      FontAtlasCache(int fontSize = 16, eFontRenderMode mode = eFontRenderMode::Bitmap);
+      ~FontAtlasCache();
+
+      FontAtlasCache(const FontAtlasCache&) = delete;
+      FontAtlasCache& operator=(const FontAtlasCache&) = delete;
+
+      /// <summary>
+      /// Atlas baked for the given scale, baked on first use. Needs a current gl context
+      /// from the main window's share group. Safe to call from render threads.
+      /// </summary>
+      const Entry* Get(float scale);
+
+      /// <summary>
+      /// Bakes the scale of every connected monitor so dragging a window between them never bakes.
+      /// </summary>
+      void Prewarm();
+
+      /// <summary>
+      /// Deletes the textures and atlases. Called by the last window using the cache with its context current.
+      /// </summary>
+      void Release();
+
+      size_t GetCount() const { return mEntries.size(); }
+      int GetFontSize() const { return mFontSize; }
+      eFontRenderMode GetRenderMode() const { return mRenderMode; }
+
+      /// <summary>
+      /// Adds the application font at the given pixel height to an atlas that is being built.
+      /// </summary>
+      static nk_font* AddDefaultFont(nk_font_atlas* fontAtlas, float height);
+
+   private:
+      // Scales are compared in hundredths, monitors report values like 1.25 or 1.5.
+      static int GetScaleKey(float scale);
+
+      int mFontSize;
+      eFontRenderMode mRenderMode;
+      std::vector<std::unique_ptr<Entry>> mEntries;
+      std::mutex mMutex;
+   };
+}
@@ -0,0 +1,132 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+namespace wgui
+{
+   /// <summary>
+   /// Parts of a frame the profiler times separately.
+   /// </summary>
+   enum class eFramePhase
+   {
+      // Capturing glfw input and feeding it to nuklear.
+      Input,
+      // The window renderer walking the control tree.
+      Layout,
+      // nk_convert turning the command list into vertices.
+      Convert,
+      // Mapping, waiting on and unmapping the streaming buffers.
+      Upload,
+      // Issuing the draw calls.
+      Draw,
+      // glfwSwapBuffers, includes waiting for vsync.
+      Swap,
+      // Gpu time of the draw calls, from a timer query a few frames old. Not measured until the first query returns.
+      Gpu,
+      // Time since the previous profiled frame.
+      Interval,
+      Count
+   };
+
+   /// <summary>
+   /// Milliseconds spent in every phase of one frame.
+   /// </summary>
+   struct FrameSample
+   {
+      // Index of the frame within its profiler, only set on copies out of the ring.
+      uint64_t Frame = 0;
+      std::array<float, static_cast<size_t>(eFramePhase::Count)> Phases{};
+
+      float& operator[](eFramePhase phase) { return Phases[static_cast<size_t>(phase)]; }
+      float operator[](eFramePhase phase) const { return Phases[static_cast<size_t>(phase)]; }
+   };
+
+   /// <summary>
+   /// Distribution of one phase over the samples still in the ring.
+   /// </summary>
+   struct FramePhaseSummary
+   {
+      float Mean = 0;
+      float P50 = 0;
+      float P95 = 0;
+      float P99 = 0;
+   };
+
+   /// <summary>
+   /// Keeps the phase timings of the last presented frames of a window.
+   /// The thread drawing the window is the only writer. Readers on any thread copy samples
+   /// out without locks and drop the ones that were overwritten while they were copying,
+   /// so the overlay and the csv dump never stall a frame.
+   /// </summary>
+   class FrameProfiler
+   {
+   public:
+      static constexpr size_t Capacity = 1024;
+
+      /// <summary>
+      /// Value of a phase the frame has no timing for. Left out of summaries and written as an empty csv field.
+      /// </summary>
+      static constexpr float NotMeasured = -1.0f;
+
+      using Clock = std::chrono::steady_clock;
+
+      static Clock::time_point Now() { return Clock::now(); }
+      static float ElapsedMs(Clock::time_point start, Clock::time_point end)
+      {
+         return std::chrono::duration<float, std::milli>(end - start).count();
+      }
+
+      /// <summary>
+      /// Phases of the frame being drawn, filled in by the window and committed once it was presented.
+      /// </summary>
+      FrameSample& GetCurrentSample() { return mCurrent; }
+
+      /// <summary>
+      /// Adds the current sample to the ring and starts a new one. Writer thread only.
+      /// </summary>
+      void Commit();
+
+      /// <summary>
+      /// Frames committed so far, also the index the next one will get.
+      /// </summary>
+      uint64_t GetFrameCount() const { return mWriteIndex.load(std::memory_order_acquire); }
+
+      /// <summary>
+      /// Copies the samples with an index of at least firstFrame that are still in the ring,
+      /// oldest first. Returns the frame count the copy is complete up to.
+      /// </summary>
+      uint64_t GetSamples(std::vector<FrameSample>& samples, uint64_t firstFrame = 0) const;
+
+      FramePhaseSummary Summarize(eFramePhase phase) const;
+      static FramePhaseSummary Summarize(const std::vector<FrameSample>& samples, eFramePhase phase);
+
+      static const char* GetPhaseName(eFramePhase phase);
+
+      /// <summary>
+      /// Appends every sample newer than cursor as a csv row and moves the cursor past them.
+      /// Returns how many frames after the cursor the ring overwrote before they could be written.
+      /// </summary>
+      uint64_t WriteCsv(std::ostream& stream, uint64_t& cursor) const;
+      static void WriteCsvHeader(std::ostream& stream);
+
+   private:
+      // A slot is stable while its sequence number reads the same before and after copying it.
+      struct Slot
+      {
+         std::atomic<uint64_t> Sequence{ 0 };
+         std::array<std::atomic<float>, static_cast<size_t>(eFramePhase::Count)> Phases{};
+      };
+
+      std::array<Slot, Capacity> mSlots;
+      std::atomic<uint64_t> mWriteIndex{ 0 };
+
+      FrameSample mCurrent;
+      Clock::time_point mLastCommit;
+      bool mHasLastCommit = false;
+   };
+}
@@ -0,0 +1,183 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "include_nuk.h"
+
+template<typename T>
+class ResourceManager;
+
+namespace wgui
+{
+   enum class eImageState
+   {
+      // Waiting for the decode thread.
+      Pending,
+      // Decoded, waiting for the next frame to copy it into a page.
+      Decoded,
+      // In a page, GetImage can be drawn.
+      Resident,
+      // The file couldn't be read or doesn't fit a page.
+      Failed
+   };
+
+   /// <summary>
+   /// RGBA8 pixels of a decoded image, rows tightly packed.
+   /// </summary>
+   struct DecodedImage
+   {
+      int Width = 0;
+      int Height = 0;
+      std::vector<uint8_t> Pixels;
+   };
+
+   /// <summary>
+   /// One image file, shared by every control that names the same path.
+   /// </summary>
+   class AtlasImage
+   {
+   public:
+      AtlasImage(const std::string& path)
+         : mPath(path)
+      {
+      }
+
+      const std::string& GetPath() const { return mPath; }
+      eImageState GetState() const { return mState.load(std::memory_order_acquire); }
+      bool IsResident() const { return GetState() == eImageState::Resident; }
+
+      /// <summary>
+      /// The image's region of its page. Only valid once resident.
+      /// </summary>
+      const struct nk_image& GetImage() const { return mImage; }
+      int GetWidth() const { return mWidth; }
+      int GetHeight() const { return mHeight; }
+
+   private:
+      std::string mPath;
+      std::atomic<eImageState> mState = eImageState::Pending;
+      DecodedImage mDecoded;
+      struct nk_image mImage = {};
+      int mWidth = 0;
+      int mHeight = 0;
+
+      friend class ImageAtlas;
+   };
+
+   /// <summary>
+   /// Places rectangles on horizontal shelves, each rectangle goes on the shelf it wastes the least height on.
+   /// Icons come in a handful of sizes, so the shelves fill up nearly without gaps.
+   /// </summary>
+   class ShelfPacker
+   {
+   public:
+      ShelfPacker(int width, int height, int padding = 1);
+
+      /// <summary>
+      /// Reserves a width by height region with padding on every side, false if it doesn't fit anymore.
+      /// </summary>
+      bool Pack(int width, int height, int& x, int& y);
+
+      int GetWidth() const { return mWidth; }
+      int GetHeight() const { return mHeight; }
+
+   private:
+      struct Shelf
+      {
+         int Y;
+         int Height;
+         int Used;
+      };
+
+      int mWidth;
+      int mHeight;
+      int mPadding;
+      int mNextShelfY = 0;
+      std::vector<Shelf> mShelves;
+   };
+
+   /// <summary>
+   /// Images of menus and toolbars packed into shared RGBA pages, so a bar full of icons binds one texture.
+   /// Files are decoded on a background thread, controls draw a placeholder until their image is resident.
+   /// Shared by the main window and its dialogs, the pages live in the main window's share group and are
+   /// released by the last of those windows to close.
+   /// </summary>
+   class ImageAtlas
+   {
+   public:
+      using Decoder = std::function<bool(const std::string& path, DecodedImage& image)>;
+
+      static constexpr int PageSize = 1024;
+
+      ImageAtlas(Decoder decoder = DecodeFile);
+      ~ImageAtlas();
+
+      ImageAtlas(const ImageAtlas&) = delete;
+      ImageAtlas& operator=(const ImageAtlas&) = delete;
+
+      /// <summary>
+      /// The image for a path, the first request of a path queues its decode. Safe to call from any thread.
+      /// </summary>
+      AtlasImage* Request(const std::string& path);
+
+      /// <summary>
+      /// Copies the images decoded since the last call into the pages, returns how many became resident.
+      /// Needs a current gl context from the main window's share group, called at the start of every frame.
+      /// </summary>
+      int Upload();
+
+      /// <summary>
+      /// Stops the decode thread and deletes the pages. Called by the last window using the atlas with its context current.
+      /// </summary>
+      void Release();
+
+      /// <summary>
+      /// Called on the decode thread whenever an image finished decoding, so an idle loop can wake up and upload it.
+      /// </summary>
+      void SetDecodedCallback(std::function<void()> callback);
+
+      size_t GetPageCount() const;
+
+      /// <summary>
+      /// Decodes png, jpeg, bmp and tga files.
+      /// </summary>
+      static bool DecodeFile(const std::string& path, DecodedImage& image);
+
+   private:
+      struct Page
+      {
+         GLuint Texture;
+         ShelfPacker Packer;
+      };
+
+      void StartWorker();
+      void StopWorker();
+      void DecodeLoop();
+      Page* Place(int width, int height, int& x, int& y);
+
+      Decoder mDecoder;
+      std::function<void()> mDecodedCallback;
+      std::unique_ptr<ResourceManager<AtlasImage>> mImages;
+
+      // Guards the registry and the queues, shared with the decode thread.
+      std::mutex mMutex;
+      std::condition_variable mWake;
+      std::deque<AtlasImage*> mDecodeQueue;
+      std::vector<AtlasImage*> mDecoded;
+      bool mStopping = false;
+      std::thread mWorker;
+
+      // Windows rendered on their own threads upload at the same time, the pages are packed under this.
+      mutable std::mutex mUploadMutex;
+      std::vector<std::unique_ptr<Page>> mPages;
+   };
+}
@@ -125,7 +125,14 @@ namespace wgui
    class XmlRenderer : public StandardGuiRenderer
    {
    public:
-      bool ConstructLayoutFromXmlFile(const std::string& fileName);
+      /// <summary>
+      /// Replaces the layout with the one in the file. With useArena the whole layout is built in an
+      /// arena owned by the renderer and freed in one go with the next layout or the renderer.
+      /// A layout replacing one that was already initialized is initialized right away.
+      /// </summary>
+      bool ConstructLayoutFromXmlFile(const std::string& fileName, bool useArena = false);
+      void Init() override;
+      ControlArena* GetArena() const { return mArena.get(); }
 
       void AddControl(std::unique_ptr<GuiControlBase> window)
       {
@@ -135,6 +142,9 @@ namespace wgui
       }
 
    protected:
+      // Declared first so it's destroyed after the controls built in it.
+      std::unique_ptr<ControlArena> mArena;
       std::vector<std::unique_ptr<GuiControlBase>> mOwnedControls;
+      bool mInitialized = false;
    };
 }
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <map>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -39,11 +40,21 @@ public:
 		}
 		else
 		{
-			StaticLogger::instance.warning(RESOURCE_ALREADY_REGISTERED_WARNING,
+			wgui::Application::Logger.warning(RESOURCE_ALREADY_REGISTERED_WARNING,
 				mResourceTypeName.c_str(), name.c_str());
 		}
 	}
 
+	/// <summary>
+	/// Returns whether a resource is registered by name, without logging a missing one.
+	/// </summary>
+	/// <param name="name"></param>
+	/// <returns></returns>
+	bool HasRegistry(const std::string& name) const
+	{
+		return mRegistries.find(name) != mRegistries.end();
+	}
+
 	/// <summary>
 	/// Returns resource registry by name.
 	/// </summary>
@@ -55,7 +66,7 @@ public:
 
 		if (value == mRegistries.end())
 		{
-			StaticLogger::instance.error(RESOURCE_NOT_REGISTERED_ERROR,
+			wgui::Application::Logger.error(RESOURCE_NOT_REGISTERED_ERROR,
 				mResourceTypeName.c_str(), name.c_str());
 		}
 		else
@@ -38,10 +38,60 @@ namespace wgui
       }
 
    protected:
+      DefaultGuiShader(const std::vector<std::string>& attributes)
+         : ShaderBase(attributes)
+      {
+      }
+
       int mLocationTexture = 0;
       int mLocationProjMatrix = 0;
    };
 
+   /// <summary>
+   /// Draws text from a signed distance field atlas. The atlas' alpha is a distance with the
+   /// glyph edge at 0.5, resolved to coverage per pixel so any font size stays sharp.
+   /// </summary>
+   class SdfGuiShader : public DefaultGuiShader
+   {
+   public:
+      void LoadShader() override
+      {
+         LoadShaders("./res/gui/shaders/DefaultShader.vert",
+                     "./res/gui/shaders/SdfShader.frag");
+      }
+   };
+
+   /// <summary>
+   /// Expands one instance per rect, glyph or image into a quad drawn as a triangle strip.
+   /// The corner comes from gl_VertexID, so the instances are the only vertex data.
+   /// </summary>
+   class InstancedGuiShader : public DefaultGuiShader
+   {
+   public:
+      InstancedGuiShader()
+         : DefaultGuiShader({ "Rect",
+                              "TexRect",
+                              "Color" })
+      {
+      }
+
+      void LoadShader() override
+      {
+         LoadShaders("./res/gui/shaders/InstancedQuad.vert",
+                     "./res/gui/shaders/DefaultShader.frag");
+      }
+   };
+
+   class InstancedSdfGuiShader : public InstancedGuiShader
+   {
+   public:
+      void LoadShader() override
+      {
+         LoadShaders("./res/gui/shaders/InstancedQuad.vert",
+                     "./res/gui/shaders/SdfShader.frag");
+      }
+   };
+
    class HighlightGuiShader : public DefaultGuiShader
    {
    public:
@@ -22,11 +22,21 @@ public:
 
    bool LoadShader(const std::string& shaderPath, int type, std::string& errorMessage);
 
+   /// <summary>
+   /// Compiles source that was already read from shaderPath, the path is only used in errors.
+   /// </summary>
+   bool CompileShader(const std::string& shaderPath, const std::string& text, int type, std::string& errorMessage);
+
    GLuint GetShader() const
    {
       return mShader;
    }
 
+   /// <summary>
+   /// Deletes the shader object, needs the context it was created in.
+   /// </summary>
+   void Release();
+
 protected:
    GLuint mShader;
 
@@ -51,6 +61,12 @@ public:
    /// </summary>
    ~ShaderBase();
 
+   /// <summary>
+   /// Deletes the program and shaders now instead of in the destructor, for shaders
+   /// that outlive the context they were created in.
+   /// </summary>
+   void Release();
+
    /**
     * Prepares the shader for use
     * */
@@ -91,6 +107,13 @@ protected:
    /// <returns></returns>
    bool LoadShaders(const std::string& vertexShaderPath, const std::string& fragmentShaderPath);
 
+   /// <summary>
+   /// Program binary cache. The binary is keyed on the sources, attribute bindings and
+   /// the gl vendor/renderer/version, anything the driver rejects is compiled from source.
+   /// </summary>
+   bool LoadProgramBinary(const std::string& path, uint64_t key);
+   void StoreProgramBinary(const std::string& path, uint64_t key);
+
    /// <summary>
    /// Functions to load and set uniforms 
    /// </summary>
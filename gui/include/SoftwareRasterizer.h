@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace wgui
+{
+   /// <summary>
+   /// Vertex as produced by nk_convert for the gl backend (see nk_glfw_vertex).
+   /// </summary>
+   struct RasterVertex
+   {
+      float Position[2];
+      float Uv[2];
+      uint8_t Color[4];
+   };
+
+   /// <summary>
+   /// RGBA8 image the rasterizer can sample from.
+   /// </summary>
+   struct RasterTexture
+   {
+      int Width = 0;
+      int Height = 0;
+      std::vector<uint8_t> Pixels;
+   };
+
+   /// <summary>
+   /// Draws indexed, textured, vertex colored triangles into an RGBA8 image on the cpu.
+   /// Blends like the gl backend does (SRC_ALPHA, ONE_MINUS_SRC_ALPHA) so headless frames
+   /// can be compared to what ends up on screen. Spans are shaded with SSE2 when available.
+   /// </summary>
+   class SoftwareRasterizer
+   {
+   public:
+      void Resize(int width, int height);
+      void Clear(uint8_t r = 0, uint8_t g = 0, uint8_t b = 0, uint8_t a = 0);
+
+      /// <summary>
+      /// Copies an RGBA8 image into the rasterizer and returns its id. Ids start at 1,
+      /// 0 means untextured (sampled as opaque white).
+      /// </summary>
+      int AddTexture(const void* rgba, int width, int height);
+      const RasterTexture* GetTexture(int id) const;
+
+      /// <summary>
+      /// Restricts drawing to the given rectangle in pixels, origin top left.
+      /// </summary>
+      void SetScissor(int x, int y, int width, int height);
+      void ResetScissor();
+
+      template <typename IndexT>
+      void DrawIndexed(const RasterVertex* vertices, const IndexT* indices, size_t indexCount, int texture)
+      {
+         const RasterTexture* tex = GetTexture(texture);
+         for (size_t i = 0; i + 2 < indexCount; i += 3)
+         {
+            DrawTriangle(vertices[indices[i]], vertices[indices[i + 1]], vertices[indices[i + 2]], tex);
+         }
+      }
+
+      void DrawTriangle(const RasterVertex& v0, const RasterVertex& v1, const RasterVertex& v2, const RasterTexture* texture);
+
+      int GetWidth() const { return mWidth; }
+      int GetHeight() const { return mHeight; }
+      const uint8_t* GetPixels() const { return mPixels.data(); }
+      const uint8_t* GetPixel(int x, int y) const { return &mPixels[((size_t)y * mWidth + x) * 4]; }
+
+      /// <summary>
+      /// Writes the image as a binary ppm (alpha dropped), handy for eyeballing failed pixel diffs.
+      /// </summary>
+      bool WritePpm(const std::string& path) const;
+
+   private:
+      void ShadeSpan(uint8_t* dst, int count, const float* color, const float* colorStep,
+         float u, float v, float uStep, float vStep, const RasterTexture* texture);
+
+      int mWidth = 0;
+      int mHeight = 0;
+      int mScissor[4] = { 0, 0, 0, 0 };
+      std::vector<uint8_t> mPixels;
+      std::vector<RasterTexture> mTextures;
+   };
+}
@@ -1,8 +1,8 @@
 #pragma once
 #include <concepts>
 #include <cassert>
+#include <array>
 #include <functional>
-#include <stack>
 
 #include "App.h"
 #include "Attributes.h"
@@ -13,6 +13,8 @@ struct nk_context;
 namespace wgui
 {
    class WindowBase;
+   class ImageAtlas;
+   class AtlasImage;
 
    enum eControlType
    {
@@ -27,6 +29,11 @@ namespace wgui
 #pragma region Iterator
 
    class GuiControlBase;
+
+   /// <summary>
+   /// Pre-order walk over a control and everything below it.
+   /// Keeps the path from the root in a fixed array of child indices, so walking never allocates.
+   /// </summary>
    class ControlTreeIterator 
    {
    public:
@@ -36,45 +43,22 @@ namespace wgui
       using pointer = GuiControlBase**;
       using reference = GuiControlBase*&;
 
-      ControlTreeIterator(value_type root) : mCurrent(root), mChildIndex(0) 
+      // Deepest nesting kept on the iterator itself, far beyond any layout.
+      // Deeper controls are walked through their parent links, slower but without skipping any.
+      static constexpr int MaxDepth = 32;
+
+      ControlTreeIterator(value_type root) : mCurrent(root), mDepth(0), mOverflow(0)
       {
-         BuildPath();
+         if (mCurrent)
+         {
+            mPath[mDepth++] = { mCurrent, 0 };
+         }
       }
 
       reference operator*() const { return (const reference)mCurrent; }
       pointer operator->() { return &mCurrent; }
 
-      ControlTreeIterator& operator++() 
-      {
-         if (!mPath.empty())
-         {
-            if (mChildIndex < mPath.top().ChildrenCount)
-            {
-               mCurrent = mPath.top().Children[mChildIndex];
-               mPath.top().LastIndex = mChildIndex;
-               mChildIndex = 0;
-               BuildPath();
-            }
-            else
-            {
-               mPath.pop();
-
-               if (mPath.empty())
-               {
-                  mCurrent = nullptr;
-                  mChildIndex = 0;
-               }
-               else
-               {
-                  mChildIndex = mPath.top().LastIndex;
-                  mChildIndex++;
-                  return ++*(this);
-               }
-            }
-         }
-
-         return *this;
-      }
+      ControlTreeIterator& operator++();
 
       bool operator==(const ControlTreeIterator& other) const 
       {
@@ -89,16 +73,15 @@ namespace wgui
    private:
       struct PathInfo 
       {
-         std::vector<value_type> Children;
-         int ChildrenCount;
-         int LastIndex;
+         value_type Control;
+         size_t NextChild;
       };
 
-      void BuildPath();
-
       value_type mCurrent;
-      int mChildIndex;
-      std::stack<PathInfo> mPath;
+      int mDepth;
+      // Levels mCurrent sits below the deepest stored control.
+      int mOverflow;
+      std::array<PathInfo, MaxDepth> mPath;
    };
 
 #pragma endregion
@@ -109,7 +92,7 @@ namespace wgui
    /// the screen space they were allocated for.
    /// The back end of the gui renderer will handle this part!
    /// </summary>
-   class GuiControlBase
+   class GuiControlBase : public ArenaAllocated, public AttributeObserver
    {
    public:
       static constexpr std::string_view TagAttr = "Tag";
@@ -117,15 +100,18 @@ namespace wgui
       static constexpr std::string_view VisibleAttr = "Visible";
 
       GuiControlBase()
-         : mAttributes(std::make_unique<AttributeSet>()),
-         mTag(mAttributes->Add<AttrString>((std::string)TagAttr)->GetRef()),
-         mEnabled(mAttributes->Add<AttrBool>((std::string)EnabledAttr)->GetRef()),
-         mEventDispatcher(std::make_unique<EventDispatcher>(this))
+         : mAttributes(std::make_unique<AttributeSet>(this)),
+         mTag(mAttributes->Add<AttrString>(AttributeNames::Of<TagAttr>())->GetRef()),
+         mEnabled(mAttributes->Add<AttrBool>(AttributeNames::Of<EnabledAttr>())->GetRef()),
+         mEventDispatcher(std::make_unique<EventDispatcher>(this)),
+         mControlId(NextControlId())
       {
          mTag = "Untagged";
          mEnabled = true;
       }
 
+      virtual ~GuiControlBase() = default;
+
       virtual void Init() {}
 
       /// <summary>
@@ -136,6 +122,32 @@ namespace wgui
       virtual void OnInitialized() {}
       virtual float GetHeight(WindowBase* const window, nk_context* context) const { return 0; }
 
+      /// <summary>
+      /// GetHeight, measured once and kept until the content scale, the style revision or the subtree changes.
+      /// Layouts ask for their own and their children's heights through this, so a frame measures each control once.
+      /// </summary>
+      /// <param name="window"></param>
+      /// <param name="context"></param>
+      /// <returns></returns>
+      float GetLayoutHeight(WindowBase* const window, nk_context* context) const;
+
+      /// <summary>
+      /// Drops the measured height of this control and of every parent.
+      /// Children, tree expansion, scale and attribute writes are tracked already, call this after changing
+      /// a height related value through an attribute's reference.
+      /// </summary>
+      void InvalidateLayout();
+
+      /// <summary>
+      /// Tells this control and every parent that the subtree draws differently, so cached groups above it draw
+      /// live again. Attribute writes and InvalidateLayout do this already, call it for state kept outside
+      /// of attributes or written through their references.
+      /// </summary>
+      void InvalidateRender();
+
+      GuiControlBase* GetParent() const { return mParent; }
+      void SetParent(GuiControlBase* parent) { mParent = parent; }
+
       /// <summary>
       /// Override this to indicate how much space is added after the control is in place.
       /// By default, widgets will have a space of window.spacing.y. Some controls like 
@@ -170,24 +182,53 @@ namespace wgui
       {
       }
 
+      /// <summary>
+      /// Direct access to the children, walks over them don't need a std::function.
+      /// </summary>
+      virtual size_t GetChildCount() const { return 0; }
+      virtual GuiControlBase* GetChild(size_t index) const { return nullptr; }
+
+      /// <summary>
+      /// Calls the function with every direct child and its index, without allocating.
+      /// </summary>
+      template <typename Func>
+      void VisitChildren(Func&& function) const
+      {
+         size_t count = GetChildCount();
+         for (size_t i = 0; i < count; i++)
+         {
+            function(GetChild(i), static_cast<int>(i));
+         }
+      }
+
       /// <summary>
       /// Whether elements can be placed inside it or not.
       /// </summary>
       /// <returns></returns>
       virtual bool SupportsChildren() const { return false; }
 
-      bool AttributeExists(const std::string& attribute)
+      bool AttributeExists(attr_name_id_t attribute) const
       {
          return mAttributes->AttributeExists(attribute);
       }
 
-      attr_type_id_t GetAttributeType(const std::string& attribute)
+      bool AttributeExists(std::string_view attribute) const
+      {
+         return mAttributes->AttributeExists(attribute);
+      }
+
+      attr_type_id_t GetAttributeType(attr_name_id_t attribute)
+      {
+         return mAttributes->Get(attribute)->GetType();
+      }
+
+      attr_type_id_t GetAttributeType(std::string_view attribute)
       {
          return mAttributes->Get(attribute)->GetType();
       }
 
       template <typename T, typename Q>
-      T& GetOrCreateAttribute(const std::string& attrName)
+      T& GetOrCreateAttribute(attr_name_id_t attrName)
          requires std::is_base_of_v<CtrlAttribute, Q>
       {
          // Add a new scale property for the newly added control.
@@ -198,28 +239,61 @@ namespace wgui
 
          if (!mAttributes->Get(attrName)->Is<Q>())
          {
-            Application::Logger.warning("Overwriting previously defined attribute: '{str}' - incorrect type", attrName.c_str());
+            Application::Logger.warning("Overwriting previously defined attribute: '{str}' - incorrect type",
+               std::string(AttributeNames::GetName(attrName)).c_str());
             mAttributes->Get(attrName)->SetType<Q>();
          }
 
          return mAttributes->Get(attrName)->As<Q>()->GetRef();
       }
 
+      template <typename T, typename Q>
+      T& GetOrCreateAttribute(std::string_view attrName)
+         requires std::is_base_of_v<CtrlAttribute, Q>
+      {
+         return GetOrCreateAttribute<T, Q>(AttributeNames::Intern(attrName));
+      }
+
       AttributeSet* const GetAttributes() { return mAttributes.get(); }
-      std::string GetTag() const { return mTag; }
+      const std::string& GetTag() const { return mTag; }
+
+      /// <summary>
+      /// Unique for the lifetime of the process. Unlike the control's address it is never reused
+      /// by a control of a rebuilt layout, so it can key data kept across rebuilds.
+      /// </summary>
+      uint64_t GetControlId() const { return mControlId; }
 
       // Iterator implementation.
       ControlTreeIterator begin() { return ControlTreeIterator(this); }
       ControlTreeIterator end() { return ControlTreeIterator(nullptr); }
 
    protected:
+      /// <summary>
+      /// Called by InvalidateRender on the control and on each of its parents.
+      /// </summary>
+      virtual void OnSubtreeChanged() { }
+
       std::unique_ptr<AttributeSet> mAttributes;
       std::string mControlType;
       std::string& mTag;
       bool& mEnabled;
 
-      GuiControlBase* mParent;
+      GuiControlBase* mParent = nullptr;
       std::unique_ptr<EventDispatcher> mEventDispatcher;
+
+   private:
+      static uint64_t NextControlId();
+
+      void OnAttributeChanged(attr_name_id_t name) override;
+
+      uint64_t mControlId;
+
+      // Last measured height and what it was measured with.
+      mutable float mLayoutHeight = 0;
+      mutable const WindowBase* mLayoutWindow = nullptr;
+      mutable double mLayoutScale = 0;
+      mutable uint64_t mLayoutStyleRevision = 0;
+      mutable bool mLayoutValid = false;
    };
 
    class ChildSupportingGuiControlBase : public GuiControlBase
@@ -230,11 +304,15 @@ namespace wgui
 
       bool AddChild(GuiControlBase* newControl) override
       {
+         newControl->SetParent(this);
          mControls.push_back(newControl);
+         InvalidateLayout();
          return true;
       }
 
       virtual void ForEachChild(std::function<void(GuiControlBase* child, int index)> function) override;
+      size_t GetChildCount() const override { return mControls.size(); }
+      GuiControlBase* GetChild(size_t index) const override { return mControls[index]; }
 
    protected:
       std::vector<GuiControlBase*> mControls;
@@ -279,7 +357,7 @@ namespace wgui
       static constexpr std::string_view ThicknessAttribute = "Thickness";
 
       GuiHorizontalSeparator()
-         : mThickness(mAttributes->Add<AttrInt>((std::string)ThicknessAttribute)->GetRef()),
+         : mThickness(mAttributes->Add<AttrInt>(ThicknessAttribute)->GetRef()),
          GuiWidget()
       {
          mThickness = 1;
@@ -308,8 +386,8 @@ namespace wgui
 
       GuiLabel()
          : GuiWidget(),
-         mText(mAttributes->Add<AttrString>((std::string)TextAttr)->GetRef()),
-         mTextAlignFlags(mAttributes->Add<AttrAlignFlags>((std::string)TextAlignAttr)->GetRef())
+         mText(mAttributes->Add<AttrString>(AttributeNames::Of<TextAttr>())->GetRef()),
+         mTextAlignFlags(mAttributes->Add<AttrAlignFlags>(AttributeNames::Of<TextAlignAttr>())->GetRef())
       {
          mText = "";
          mTextAlignFlags = static_cast<int>(eTextAlignmentFlags::CenterLeft);
@@ -335,8 +413,8 @@ namespace wgui
    public:
       static constexpr std::string_view CheckedAttr = "Checked";
       GuiCheckbox()
-         : mChecked(mAttributes->Add<AttrBool>((std::string)CheckedAttr)->GetRef()),
-           mText(mAttributes->Add<AttrString>((std::string)GuiLabel::TextAttr)->GetRef()),
+         : mChecked(mAttributes->Add<AttrBool>(AttributeNames::Of<CheckedAttr>())->GetRef()),
+           mText(mAttributes->Add<AttrString>(AttributeNames::Of<GuiLabel::TextAttr>())->GetRef()),
            GuiWidget()
       {
       }
@@ -362,7 +440,7 @@ namespace wgui
    {
    public:
       GuiButton()
-         : mText(mAttributes->Add<AttrString>((std::string)GuiLabel::TextAttr)->GetRef())
+         : mText(mAttributes->Add<AttrString>(AttributeNames::Of<GuiLabel::TextAttr>())->GetRef())
       {
          mText = "";
       }
@@ -386,7 +464,7 @@ namespace wgui
    public:
       GuiRadioButton()
          : mButtonIndex(1), mRadioButtonSelection(nullptr), 
-         mText(mAttributes->Add<AttrString>((std::string)GuiLabel::TextAttr)->GetRef()),
+         mText(mAttributes->Add<AttrString>(AttributeNames::Of<GuiLabel::TextAttr>())->GetRef()),
          GuiWidget()
       {
       }
@@ -423,7 +501,7 @@ namespace wgui
       static constexpr std::string_view SelectedAttr = "Selection";
 
       GuiRadioButtonGroup()
-         : mCurrentSelection(mAttributes->Add<AttrInt>((std::string)SelectedAttr)->GetRef()),
+         : mCurrentSelection(mAttributes->Add<AttrInt>(AttributeNames::Of<SelectedAttr>())->GetRef()),
          ChildSupportingGuiControlBase()
       {
          mCurrentSelection = 1;
@@ -475,8 +553,8 @@ namespace wgui
    public:
       GuiComboboxItem()
          : GuiComboboxItemBase(),
-         mText(mAttributes->Add<AttrString>((std::string)GuiLabel::TextAttr)->GetRef()),
-         mTextAlignment(mAttributes->Add<AttrAlignFlags>((std::string)GuiLabel::TextAlignAttr)->GetRef())
+         mText(mAttributes->Add<AttrString>(AttributeNames::Of<GuiLabel::TextAttr>())->GetRef()),
+         mTextAlignment(mAttributes->Add<AttrAlignFlags>(AttributeNames::Of<GuiLabel::TextAlignAttr>())->GetRef())
       {
          mText = "";
          mTextAlignment = static_cast<int>(eTextAlignmentFlags::CenterLeft);
@@ -508,10 +586,10 @@ namespace wgui
       virtual void OnInitialized() override;
 
       GuiCombobox()
-         : mSelectedItem(mAttributes->Add<AttrInt>((std::string)GuiRadioButtonGroup::SelectedAttr)->GetRef()),
-         mWidth(mAttributes->Add<AttrInt>((std::string)WidthAttr)->GetRef()),
-         mHeight(mAttributes->Add<AttrInt>((std::string)HeightAttr)->GetRef()),
-         mItemHeight(mAttributes->Add<AttrInt>((std::string)ItemHeightAttr)->GetRef())
+         : mSelectedItem(mAttributes->Add<AttrInt>(AttributeNames::Of<GuiRadioButtonGroup::SelectedAttr>())->GetRef()),
+         mWidth(mAttributes->Add<AttrInt>(AttributeNames::Of<WidthAttr>())->GetRef()),
+         mHeight(mAttributes->Add<AttrInt>(AttributeNames::Of<HeightAttr>())->GetRef()),
+         mItemHeight(mAttributes->Add<AttrInt>(AttributeNames::Of<ItemHeightAttr>())->GetRef())
       {
          mSelectedItem = 1;
          mWidth = 200;
@@ -556,10 +634,10 @@ namespace wgui
    {
    public:
       GuiSliderInt()
-         : mValue(mAttributes->Add<AttrInt>((std::string)ValueAttr)->GetRef()),
-         mMinValue(mAttributes->Add<AttrInt>((std::string)MinValueAttr)->GetRef()),
-         mMaxValue(mAttributes->Add<AttrInt>((std::string)MaxValueAttr)->GetRef()),
-         mStep(mAttributes->Add<AttrInt>((std::string)StepAttr)->GetRef())
+         : mValue(mAttributes->Add<AttrInt>(AttributeNames::Of<ValueAttr>())->GetRef()),
+         mMinValue(mAttributes->Add<AttrInt>(AttributeNames::Of<MinValueAttr>())->GetRef()),
+         mMaxValue(mAttributes->Add<AttrInt>(AttributeNames::Of<MaxValueAttr>())->GetRef()),
+         mStep(mAttributes->Add<AttrInt>(AttributeNames::Of<StepAttr>())->GetRef())
       {
          mMinValue = 0;
          mMaxValue = 100;
@@ -590,10 +668,10 @@ namespace wgui
    {
    public:
       GuiSliderReal()
-         : mValue(mAttributes->Add<AttrReal>((std::string)ValueAttr)->GetRef()),
-         mMinValue(mAttributes->Add<AttrReal>((std::string)MinValueAttr)->GetRef()),
-         mMaxValue(mAttributes->Add<AttrReal>((std::string)MaxValueAttr)->GetRef()),
-         mStep(mAttributes->Add<AttrReal>((std::string)StepAttr)->GetRef())
+         : mValue(mAttributes->Add<AttrReal>(AttributeNames::Of<ValueAttr>())->GetRef()),
+         mMinValue(mAttributes->Add<AttrReal>(AttributeNames::Of<MinValueAttr>())->GetRef()),
+         mMaxValue(mAttributes->Add<AttrReal>(AttributeNames::Of<MaxValueAttr>())->GetRef()),
+         mStep(mAttributes->Add<AttrReal>(AttributeNames::Of<StepAttr>())->GetRef())
       {
          mMinValue = 0;
          mMaxValue = 1;
@@ -628,9 +706,9 @@ namespace wgui
       static constexpr std::string_view ModifableAttr = "Modifiable";
 
       GuiProgressBar()
-         : mValue(mAttributes->Add<AttrInt>((std::string)ValueAttr)->GetRef()),
-         mMaxValue(mAttributes->Add<AttrInt>((std::string)MaxValueAttr)->GetRef()),
-         mModifiable(mAttributes->Add<AttrBool>((std::string)ModifableAttr)->GetRef())
+         : mValue(mAttributes->Add<AttrInt>(AttributeNames::Of<ValueAttr>())->GetRef()),
+         mMaxValue(mAttributes->Add<AttrInt>(AttributeNames::Of<MaxValueAttr>())->GetRef()),
+         mModifiable(mAttributes->Add<AttrBool>(AttributeNames::Of<ModifableAttr>())->GetRef())
       {
          mValue = 0;
          mMaxValue = 100;
@@ -661,8 +739,8 @@ namespace wgui
       static constexpr std::string_view StepPerPxAttr = "StepPerPixel";
 
       GuiInputInt()
-         : mName(mAttributes->Add<AttrString>((std::string)NameAttr)->GetRef()),
-         mStepPerPx(mAttributes->Add<AttrReal>((std::string)StepPerPxAttr)->GetRef())
+         : mName(mAttributes->Add<AttrString>(AttributeNames::Of<NameAttr>())->GetRef()),
+         mStepPerPx(mAttributes->Add<AttrReal>(AttributeNames::Of<StepPerPxAttr>())->GetRef())
       {
          mName = "Unnamed";
          mStepPerPx = 1.0;
@@ -694,8 +772,8 @@ namespace wgui
       static constexpr std::string_view StepPerPxAttr = "StepPerPixel";
 
       GuiInputReal()
-         : mName(mAttributes->Add<AttrString>((std::string)NameAttr)->GetRef()),
-         mStepPerPx(mAttributes->Add<AttrReal>((std::string)StepPerPxAttr)->GetRef())
+         : mName(mAttributes->Add<AttrString>(AttributeNames::Of<NameAttr>())->GetRef()),
+         mStepPerPx(mAttributes->Add<AttrReal>(AttributeNames::Of<StepPerPxAttr>())->GetRef())
       {
          mName = "Unnamed";
          mStepPerPx = 1.0;
@@ -726,7 +804,7 @@ namespace wgui
       static constexpr std::string_view SelectedAttr = "Selected";
 
       GuiSelectableLabel(bool selected = false)
-         : mSelected(mAttributes->Add<AttrBool>((std::string)SelectedAttr)->GetRef()),
+         : mSelected(mAttributes->Add<AttrBool>(AttributeNames::Of<SelectedAttr>())->GetRef()),
          GuiLabel()
       {
          mSelected = selected;
@@ -739,6 +817,33 @@ namespace wgui
       bool& mSelected;
    };
 
+   /// <summary>
+   /// Table of the p50/p95/p99 time of each frame phase of the window it is drawn in.
+   /// Turns profiling on for that window the first time it renders and refreshes the
+   /// numbers twice a second so they stay readable.
+   /// </summary>
+   class GuiPerfOverlay : public GuiWidget
+   {
+   public:
+      static constexpr double RefreshSeconds = 0.5;
+
+      GuiPerfOverlay()
+      {
+      }
+
+      void ChildRender(WindowBase* const window, nk_context* context) override;
+      std::string GetLabel() const override { return "PerfOverlay"; }
+      float GetHeight(WindowBase* const window, nk_context* context) const override;
+
+   protected:
+      static constexpr int RowCount = static_cast<int>(eFramePhase::Count) + 1;
+
+      std::array<FramePhaseSummary, static_cast<size_t>(eFramePhase::Count)> mSummaries{};
+      std::vector<FrameSample> mSamples;
+      FrameProfiler::Clock::time_point mLastRefresh;
+      std::string mName = std::to_string(reinterpret_cast<int64_t>(this));
+   };
+
 #pragma endregion
 
 #pragma region Row Layouts
@@ -758,8 +863,8 @@ namespace wgui
 
       GuiLayoutRowBase()
          : ChildSupportingGuiControlBase(),
-         mHeight(mAttributes->Add<AttrInt>((std::string)HeightAttr)->GetRef()),
-         mAutoHeight(mAttributes->Add<AttrBool>((std::string)AutoHeightAttr)->GetRef())
+         mHeight(mAttributes->Add<AttrInt>(AttributeNames::Of<HeightAttr>())->GetRef()),
+         mAutoHeight(mAttributes->Add<AttrBool>(AttributeNames::Of<AutoHeightAttr>())->GetRef())
       {
          mHeight = 30;
          mAutoHeight = false;
@@ -810,7 +915,7 @@ namespace wgui
       }
 
       GuiLayoutRowStatic()
-         : mColWidth(mAttributes->Add<AttrInt>((std::string)ColWidthAttr)->GetRef()),
+         : mColWidth(mAttributes->Add<AttrInt>(AttributeNames::Of<ColWidthAttr>())->GetRef()),
          GuiLayoutRowBase()
       {
          mColWidth = 100;
@@ -933,11 +1038,18 @@ namespace wgui
       static constexpr std::string_view PosXGridAttr = "PosY";
       static constexpr std::string_view PosYGridAttr = "PosX";
 
-      float GetHeight(WindowBase* const window, nk_context* context)
+      float GetHeight(WindowBase* const window, nk_context* context) const override
       {
          assert("Auto height not supported on spaces" && !mAutoHeight);
          return mHeight * window->GetContentScaleY();
       }
+
+   protected:
+      // Names of the attributes spaces add to their children, "Space.Width" etc.
+      static attr_name_id_t GetWidthName();
+      static attr_name_id_t GetHeightName();
+      static attr_name_id_t GetPosXName();
+      static attr_name_id_t GetPosYName();
    };
 
    /// <summary>
@@ -1001,18 +1113,21 @@ namespace wgui
       static constexpr std::string_view ScrollableAttr = "Scrollable";
       static constexpr std::string_view BorderAttr = "Border";
       static constexpr std::string_view WindowFlagsAttr = "WinFlags";
+      static constexpr std::string_view CachedAttr = "Cached";
 
       GuiLayoutGroup()
-         : mTitle(mAttributes->Add<AttrString>((std::string)TitleAttr)->GetRef()),
-         mScrollable(mAttributes->Add<AttrBool>((std::string)ScrollableAttr)->GetRef()),
-         mBorder(mAttributes->Add<AttrBool>((std::string)BorderAttr)->GetRef()),
-         mFlags(mAttributes->Add<AttrWinFlags>((std::string)WindowFlagsAttr)->GetRef())
+         : mTitle(mAttributes->Add<AttrString>(AttributeNames::Of<TitleAttr>())->GetRef()),
+         mScrollable(mAttributes->Add<AttrBool>(AttributeNames::Of<ScrollableAttr>())->GetRef()),
+         mBorder(mAttributes->Add<AttrBool>(AttributeNames::Of<BorderAttr>())->GetRef()),
+         mFlags(mAttributes->Add<AttrWinFlags>(AttributeNames::Of<WindowFlagsAttr>())->GetRef()),
+         mCached(mAttributes->Add<AttrBool>(AttributeNames::Of<CachedAttr>())->GetRef())
       {
          mTitle = "";
          mName = std::to_string(reinterpret_cast<int64_t>(this));
          mScrollable = false;
          mBorder = false;
          mFlags = 0;
+         mCached = false;
       }
 
       GuiLayoutGroup(const std::string& title, bool scrollable = false, bool border = false, int flags = 0)
@@ -1024,10 +1139,22 @@ namespace wgui
          mFlags = flags;
       }
 
+      ~GuiLayoutGroup()
+      {
+         // Controls go away without their window's context, the window deletes the gl objects on its next frame.
+         nk_glfw3_render_target_release(&mCacheTarget);
+      }
+
       eControlType GetControlType() const override { return eControlType::Group; }
       void ChildRender(WindowBase* const window, nk_context* context) override;
       std::string GetLabel() const override { return "Group"; }
 
+      /// <summary>
+      /// Makes a cached group draw its subtree again on the next frame, for changes nothing in the subtree reported.
+      /// </summary>
+      void InvalidateCache() { mCacheValid = false; }
+      bool IsDrawnFromCache() const { return mDrawnFromCache; }
+
       float GetHeight(WindowBase* const window, nk_context* context) const override
       {
          float baseHeight = mScrollable ? context->style.window.scrollbar_size.y : 0;
@@ -1041,11 +1168,33 @@ namespace wgui
       virtual float GetVerticalSpacing(WindowBase* const window, nk_context* context) const { return 0; }
 
    protected:
+      /// <summary>
+      /// Cached groups composite their last capture while the mouse stays away and nothing in the subtree
+      /// invalidated it. Returns false when the subtree has to be laid out live this frame.
+      /// </summary>
+      bool RenderFromCache(WindowBase* const window, nk_context* context, const struct nk_rect& bounds);
+      void CaptureCache(WindowBase* const window, nk_context* context, const struct nk_rect& bounds, nk_size commandStart);
+
+      void OnSubtreeChanged() override
+      {
+         mCacheValid = false;
+         mSubtreeChanged = true;
+      }
+
       std::string& mTitle;
       std::string mName;
       bool& mScrollable;
       bool& mBorder;
       int& mFlags;
+      bool& mCached;
+
+      // Offscreen copy of the subtree and what it was drawn from. The gl objects belong to the window that drew it.
+      struct nk_glfw_render_target mCacheTarget = {};
+      struct nk_rect mCacheBounds = {};
+      uint64_t mCacheStyleRevision = 0;
+      bool mCacheValid = false;
+      bool mSubtreeChanged = true;
+      bool mDrawnFromCache = false;
    };
 
    class GuiLayoutTreeBase : public ChildSupportingGuiControlBase
@@ -1054,8 +1203,8 @@ namespace wgui
       static constexpr std::string_view InitiallyOpenAttr = "InitiallyOpen";
 
       GuiLayoutTreeBase()
-         : mInitiallyOpen(mAttributes->Add<AttrBool>((std::string)InitiallyOpenAttr)->GetRef()),
-         mText(mAttributes->Add<AttrString>((std::string)GuiLabel::TextAttr)->GetRef()),
+         : mInitiallyOpen(mAttributes->Add<AttrBool>(AttributeNames::Of<InitiallyOpenAttr>())->GetRef()),
+         mText(mAttributes->Add<AttrString>(AttributeNames::Of<GuiLabel::TextAttr>())->GetRef()),
          mName(),
          mExpanded(false)
       {
@@ -1147,6 +1296,17 @@ namespace wgui
       }
    };
 
+   /// <summary>
+   /// The atlas image a control asked for last, so drawing doesn't look its path up in the atlas every frame.
+   /// Asked for again when the path or the window's atlas changes.
+   /// </summary>
+   struct ImageRequest
+   {
+      const ImageAtlas* Atlas = nullptr;
+      std::string Path;
+      AtlasImage* Image = nullptr;
+   };
+
    class GuiMenu : public ChildSupportingGuiControlBase
    {
    public:
@@ -1156,11 +1316,11 @@ namespace wgui
 
       GuiMenu()
          : ChildSupportingGuiControlBase(),
-         mTextAlignFlags(mAttributes->Add<AttrAlignFlags>((std::string)GuiLabel::TextAlignAttr)->GetRef()),
-         mText(mAttributes->Add<AttrString>((std::string)GuiLabel::TextAttr)->GetRef()),
-         mImagePath(mAttributes->Add<AttrString>((std::string)ImagePathAttr)->GetRef()),
-         mWidth(mAttributes->Add<AttrInt>((std::string)WidthAttr)->GetRef()),
-         mHeight(mAttributes->Add<AttrInt>((std::string)HeightAttr)->GetRef())
+         mTextAlignFlags(mAttributes->Add<AttrAlignFlags>(AttributeNames::Of<GuiLabel::TextAlignAttr>())->GetRef()),
+         mText(mAttributes->Add<AttrString>(AttributeNames::Of<GuiLabel::TextAttr>())->GetRef()),
+         mImagePath(mAttributes->Add<AttrString>(AttributeNames::Of<ImagePathAttr>())->GetRef()),
+         mWidth(mAttributes->Add<AttrInt>(AttributeNames::Of<WidthAttr>())->GetRef()),
+         mHeight(mAttributes->Add<AttrInt>(AttributeNames::Of<HeightAttr>())->GetRef())
       {
          mTextAlignFlags = static_cast<int>(eTextAlignmentFlags::FullyCentered);
          mText = "";
@@ -1197,6 +1357,7 @@ namespace wgui
       int& mTextAlignFlags;
       std::string& mText;
       std::string& mImagePath;
+      ImageRequest mImageRequest;
 
       int64_t& mWidth, & mHeight;
    };
@@ -1208,9 +1369,9 @@ namespace wgui
 
       GuiMenuItem()
          : GuiWidget(),
-         mTextAlignFlags(mAttributes->Add<AttrAlignFlags>((std::string)GuiLabel::TextAlignAttr)->GetRef()),
-         mText(mAttributes->Add<AttrString>((std::string)GuiLabel::TextAttr)->GetRef()),
-         mImagePath(mAttributes->Add<AttrString>((std::string)ImagePathAttr)->GetRef())
+         mTextAlignFlags(mAttributes->Add<AttrAlignFlags>(AttributeNames::Of<GuiLabel::TextAlignAttr>())->GetRef()),
+         mText(mAttributes->Add<AttrString>(AttributeNames::Of<GuiLabel::TextAttr>())->GetRef()),
+         mImagePath(mAttributes->Add<AttrString>(AttributeNames::Of<ImagePathAttr>())->GetRef())
       {
          mTextAlignFlags = static_cast<int>(eTextAlignmentFlags::CenterLeft);
          mText = "";
@@ -1235,6 +1396,7 @@ namespace wgui
       int& mTextAlignFlags;
       std::string& mText;
       std::string& mImagePath;
+      ImageRequest mImageRequest;
    };
 
    /// <summary>
@@ -1257,6 +1419,21 @@ namespace wgui
       virtual float GetVerticalSpacing(WindowBase* const window, nk_context* context) const { return 0; }
 
    protected:
+      /// <summary>
+      /// Arena for the layout built in Init, freed together with the control.
+      /// </summary>
+      ControlArena* CreateArena()
+      {
+         // A previous layout lives in the old arena.
+         mControls.clear();
+         mOwnedControls.clear();
+         mArena = std::make_unique<ControlArena>();
+         return mArena.get();
+      }
+
+      // Declared first so it's destroyed after the controls built in it.
+      std::unique_ptr<ControlArena> mArena;
+
       // All controls created by this class must be owned. Store them here.
       // All children must get raw pointers to objects stored and owned here.
       std::vector<std::unique_ptr<GuiControlBase>> mOwnedControls;
@@ -1279,11 +1456,11 @@ namespace wgui
 
       GuiLayoutWindow()
          : GuiLayoutGroup(),
-           mPosX(mAttributes->Add<AttrInt>((std::string)XPosAttr)->GetRef()),
-           mPosY(mAttributes->Add<AttrInt>((std::string)YPosAttr)->GetRef()),
-           mWidth(mAttributes->Add<AttrInt>((std::string)WidthAttr)->GetRef()),
-           mHeight(mAttributes->Add<AttrInt>((std::string)HeightAttr)->GetRef()),
-           mTrackParentWindowSize(mAttributes->Add<AttrBool>((std::string)TrackParentAttr)->GetRef())
+           mPosX(mAttributes->Add<AttrInt>(AttributeNames::Of<XPosAttr>())->GetRef()),
+           mPosY(mAttributes->Add<AttrInt>(AttributeNames::Of<YPosAttr>())->GetRef()),
+           mWidth(mAttributes->Add<AttrInt>(AttributeNames::Of<WidthAttr>())->GetRef()),
+           mHeight(mAttributes->Add<AttrInt>(AttributeNames::Of<HeightAttr>())->GetRef()),
+           mTrackParentWindowSize(mAttributes->Add<AttrBool>(AttributeNames::Of<TrackParentAttr>())->GetRef())
       {
             // Set to defaults.
          mPosX = 0;
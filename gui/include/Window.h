@@ -1,7 +1,16 @@
 #pragma once
 #include "DebugLogger.h"
 #include "ContextManager.h"
+#include "SoftwareRasterizer.h"
+#include "FontAtlasCache.h"
+#include "ImageAtlas.h"
+#include "FrameProfiler.h"
+#include "ControlProfiler.h"
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
 #include <thread>
+#include <vector>
 
 #include "include_nuk.h"
 
@@ -20,7 +29,7 @@ namespace wgui
       }
 
       WindowStyle(const WindowStyle& copy)
-         : mFontSize(copy.mFontSize)
+         : mFontSize(copy.mFontSize), mScaledStyles(copy.mScaledStyles)
       {
          std::memcpy(&mStyle, &copy.mStyle, sizeof(nk_style));
       }
@@ -29,16 +38,97 @@ namespace wgui
       void SetFontSize(int fontSize)
       {
          mFontSize = fontSize;
+         mScaledStyles.clear();
       }
 
-      void Scale(nk_style* style, nk_font* font, float scaleX, float scaleY);
+      /// <summary>
+      /// Writes the style scaled from the base style into style. Every scale is computed once,
+      /// switching back to a scale seen before is a copy.
+      /// </summary>
+      void Scale(nk_style* style, nk_user_font* font, float scaleX, float scaleY);
 
    private:
+      struct ScaledStyle
+      {
+         float ScaleX;
+         float ScaleY;
+         nk_style Style;
+      };
+
       nk_style mStyle;
       int mFontSize;
+      std::vector<ScaledStyle> mScaledStyles;
    };
 
    class WindowRenderer;
+   class WindowBase;
+
+   /// <summary>
+   /// Lays out, draws and presents one window on its own thread with the window's context
+   /// current there, so every window waits only for its own monitor's vblank.
+   /// The main thread keeps pumping glfw events and posts input captures, glfw only allows
+   /// input and window queries there. Clipboard access is relayed through the main thread too.
+   /// </summary>
+   class WindowRenderThread
+   {
+   public:
+      WindowRenderThread(WindowBase* window);
+      ~WindowRenderThread();
+
+      WindowRenderThread(const WindowRenderThread&) = delete;
+      WindowRenderThread& operator=(const WindowRenderThread&) = delete;
+
+      /// <summary>
+      /// Takes the window's context off the calling (main) thread and starts rendering.
+      /// </summary>
+      void Start();
+
+      /// <summary>
+      /// Finishes the current frame, releases the thread's gl objects and joins.
+      /// The window's context is current nowhere afterwards.
+      /// </summary>
+      void Stop();
+
+      /// <summary>
+      /// Captures the window's input and hands it to the render thread. Main thread only.
+      /// </summary>
+      void PostInput();
+
+      /// <summary>
+      /// Period of the monitor the window is on, paces frames vsync didn't block on.
+      /// </summary>
+      void SetRefreshPeriod(double seconds) { mRefreshPeriod = seconds; }
+
+      /// <summary>
+      /// Whether the user did anything with the window in the last frame the thread drew.
+      /// </summary>
+      bool InputActive() const { return mInputActive; }
+
+   private:
+      void Run();
+
+      static void ClipboardPaste(nk_handle userdata, struct nk_text_edit* edit);
+      static void ClipboardCopy(nk_handle userdata, const char* text, int length);
+
+      WindowBase* mWindow;
+      std::thread mThread;
+
+      std::mutex mMutex;
+      std::condition_variable mInputPosted;
+      nk_glfw_input mPendingInput;
+      bool mInputPending = false;
+      bool mStopRequested = false;
+
+      // Clipboard text read by the main thread when paste was pressed, and text copied on the
+      // render thread waiting for the main thread to put it on the clipboard.
+      std::string mPendingPaste;
+      std::string mPasteText;
+      std::string mCopiedText;
+      bool mCopyPending = false;
+
+      std::atomic<double> mRefreshPeriod = 1.0 / 60.0;
+      std::atomic<bool> mInputActive = false;
+   };
 
    /// <summary>
    /// Abstract class for handling basic operations a window can do.
@@ -50,25 +140,25 @@ namespace wgui
       WindowBase();
       virtual ~WindowBase();
 
-      void SetWindowSize(int width, int height);
-      void GetWindowSize(int& width, int& height) const;
-      void SetWindowPos(int x, int y);
-      void GetWindowPos(int& x, int& y) const;
-      void SetWindowSizeLimits(int minWidth, int minHeight, int maxWidth = GL_DONT_CARE, int = GL_DONT_CARE);
+      virtual void SetWindowSize(int width, int height);
+      virtual void GetWindowSize(int& width, int& height) const;
+      virtual void SetWindowPos(int x, int y);
+      virtual void GetWindowPos(int& x, int& y) const;
+      virtual void SetWindowSizeLimits(int minWidth, int minHeight, int maxWidth = GL_DONT_CARE, int = GL_DONT_CARE);
 
-      void SetWindowTitle(const std::string& title);
+      virtual void SetWindowTitle(const std::string& title);
       std::string GetWindowTitle() const { return mWindowTitle; }
 
       /// <summary>
       /// Getters for window attributes.
       /// </summary>
-      bool GetWindowFocused() const;
-      bool GetWindowVisible() const;
-      bool GetWindowResizable() const;
-      bool GetWindowDecorated() const;
+      virtual bool GetWindowFocused() const;
+      virtual bool GetWindowVisible() const;
+      virtual bool GetWindowResizable() const;
+      virtual bool GetWindowDecorated() const;
 
-      void CloseWindow();
-      void CancelWindowClose();
+      virtual void CloseWindow();
+      virtual void CancelWindowClose();
       bool Closing() { return mClosing; }
 
       virtual bool CreateWindow(const std::string& title,
@@ -82,31 +172,133 @@ namespace wgui
       virtual void Render();
       virtual void Update();
 
+      /// <summary>
+      /// Swaps in the frame the last Render drew and commits its timings when profiling.
+      /// Called on the thread that drew it.
+      /// </summary>
+      void Present();
+
+      /// <summary>
+      /// When enabled, a frame whose nuklear command list matches the previous one is not
+      /// converted, drawn or presented. Render still lays out the ui so input is handled.
+      /// </summary>
+      void SetSkipUnchangedFrames(bool skip);
+      bool GetSkipUnchangedFrames() const { return mSkipUnchangedFrames; }
+
+      /// <summary>
+      /// Whether the last call to Render drew a frame that needs to be swapped in.
+      /// </summary>
+      bool FramePresented() const { return mFramePresented; }
+
+      /// <summary>
+      /// Whether the user did anything with this window in the last rendered frame.
+      /// </summary>
+      bool InputActive() const { return mInputActive; }
+      uint64_t GetSkippedFrameCount() const { return mSkippedFrames; }
+
+      /// <summary>
+      /// Thread drawing this window, null unless Application::SetThreadedRendering is on.
+      /// </summary>
+      WindowRenderThread* GetRenderThread() { return mRenderThread.get(); }
+
+      /// <summary>
+      /// Vertex, index and draw counts of the last frame that was drawn.
+      /// </summary>
+      const nk_glfw_frame_stats& GetFrameStats() { return mNkContext.GetGlfw()->stats; }
+
+      /// <summary>
+      /// Records the phase timings of every presented frame, gpu time included where timer queries exist.
+      /// The profiler is kept once created so readers on other threads never see it go away.
+      /// </summary>
+      void SetFrameProfiling(bool enable);
+      bool GetFrameProfiling() const { return mFrameProfiling; }
+
+      /// <summary>
+      /// Timings of the presented frames, null unless profiling is on.
+      /// </summary>
+      FrameProfiler* GetFrameProfiler() { return mFrameProfiling ? mFrameProfiler.get() : nullptr; }
+
+      /// <summary>
+      /// Records what every control in the window's tree costs to render. Adds a second convert per
+      /// frame for the vertex counts, so it is meant for finding slow layouts, not for frame timing.
+      /// </summary>
+      void SetControlProfiling(bool enable);
+      bool GetControlProfiling() const { return mControlProfiling; }
+      ControlProfiler* GetControlProfiler() { return mControlProfiling ? mControlProfiler.get() : nullptr; }
+
+      /// <summary>
+      /// The profiler with the totals recorded so far, kept once profiling stops so the report can still be read.
+      /// Null if control profiling was never turned on.
+      /// </summary>
+      const ControlProfiler* GetControlProfilerResults() const { return mControlProfiler.get(); }
+
+      /// <summary>
+      /// Menu and toolbar images shared with the main window, null for windows created without one.
+      /// </summary>
+      ImageAtlas* GetImageAtlas() const { return mImageAtlas.get(); }
+
       virtual NuklearGlfwContextManager& GetContext() { return mNkContext; }
 
       void SetRenderer(WindowRenderer* renderer) { mLastRenderer = renderer; }
       WindowRenderer* GetRenderer() const { return mLastRenderer; }
 
-      void SetContentScale();
+      virtual void SetContentScale();
       double GetContentScaleX() { return mContentScaleX; }
       double GetContentScaleY() { return mContentScaleY; }
 
       virtual WindowStyle* GetStyle() { return mWindowStyle.get(); }
 
+      /// <summary>
+      /// Changes whenever the style is rescaled or edited, measured control heights are kept per revision.
+      /// Call NotifyStyleChanged after editing the context's style directly.
+      /// </summary>
+      uint64_t GetStyleRevision() const { return mStyleRevision; }
+      void NotifyStyleChanged() { mStyleRevision++; }
+
    protected:
+      /// <summary>
+      /// Rescales the style and font if the scale differs from the current one.
+      /// </summary>
+      void ApplyContentScale(float scaleX, float scaleY);
+
+      void StartRenderThread();
+      void StopRenderThread();
+
       WindowRenderer* mLastRenderer = nullptr;
 
       GLFWwindow* mWindow;
       std::string mWindowTitle;
       double mContentScaleX = 0.0;
       double mContentScaleY = 0.0;
+      uint64_t mStyleRevision = 0;
       struct nk_font* mFont;
+
+      // Atlases per content scale, shared by the main window and its dialogs. The last of them to
+      // close releases the textures. Null for windows that keep one bake.
+      std::shared_ptr<FontAtlasCache> mFontAtlases;
+
+      // Image pages, shared like the font atlases and released by the last window to close.
+      std::shared_ptr<ImageAtlas> mImageAtlas;
+
+      // Per window copy of the font handle, the baked font may be shared but the height follows this window's scale.
+      nk_user_font mFontHandle;
       bool mClosing = false;
+      bool mSkipUnchangedFrames = false;
+      bool mFramePresented = false;
+      bool mInputActive = false;
+      // Counted on the render thread in threaded mode and read on the main thread.
+      std::atomic<uint64_t> mSkippedFrames = 0;
+      std::atomic<bool> mFrameProfiling = false;
+      std::unique_ptr<FrameProfiler> mFrameProfiler;
+      std::atomic<bool> mControlProfiling = false;
+      std::unique_ptr<ControlProfiler> mControlProfiler;
 
       NuklearGlfwContextManager mNkContext;
       std::unique_ptr<WindowStyle> mWindowStyle;
+      std::unique_ptr<WindowRenderThread> mRenderThread;
 
       friend class WindowInput;
+      friend class WindowRenderThread;
       friend class Application;
       friend class Dialog;
    };
@@ -125,9 +317,17 @@ namespace wgui
          bool resizable = true,
          bool visible = true, bool decorated = true, bool fullScreen = false) override;
 
+      /// <summary>
+      /// How text is baked and drawn for this window and its dialogs. Takes effect in CreateWindow.
+      /// </summary>
+      void SetFontRenderMode(eFontRenderMode mode) { mFontRenderMode = mode; }
+      eFontRenderMode GetFontRenderMode() const { return mFontRenderMode; }
+
    private:
       static DebugLogger GlfwLogger;
       static DebugLogger GlLogger;
+
+      eFontRenderMode mFontRenderMode = eFontRenderMode::Bitmap;
    };
 
    /// <summary>
@@ -151,6 +351,65 @@ namespace wgui
       MainWindow* mMainWindow;
    };
 
+   /// <summary>
+   /// Window without a display or gl context. Frames are converted like on screen and drawn
+   /// into an RGBA image by the software rasterizer, for benchmarks and pixel tests on
+   /// machines without a gpu. Not registered with the Application, call Render directly.
+   /// </summary>
+   class HeadlessWindow : public WindowBase
+   {
+   public:
+      HeadlessWindow();
+      ~HeadlessWindow();
+
+      bool CreateWindow(const std::string& title,
+         int width, int height,
+         bool resizable = true,
+         bool visible = true, bool decorated = true, bool fullScreen = false) override;
+
+      void Render() override;
+      void Update() override { }
+
+      void SetWindowSize(int width, int height) override;
+      void GetWindowSize(int& width, int& height) const override;
+      void SetWindowPos(int x, int y) override { }
+      void GetWindowPos(int& x, int& y) const override { x = 0; y = 0; }
+      void SetWindowSizeLimits(int minWidth, int minHeight, int maxWidth = GL_DONT_CARE, int = GL_DONT_CARE) override { }
+      void SetWindowTitle(const std::string& title) override { mWindowTitle = title; }
+
+      bool GetWindowFocused() const override { return true; }
+      bool GetWindowVisible() const override { return false; }
+      bool GetWindowResizable() const override { return true; }
+      bool GetWindowDecorated() const override { return false; }
+
+      void CloseWindow() override { mClosing = true; }
+      void CancelWindowClose() override { mClosing = false; }
+
+      void SetContentScale() override;
+      void SetContentScale(float scaleX, float scaleY);
+
+      /// <summary>
+      /// Input fed to nuklear on the next Render.
+      /// </summary>
+      void SetMouseState(int x, int y, bool leftDown);
+
+      const SoftwareRasterizer& GetRasterizer() const { return mRasterizer; }
+
+   private:
+      int mWidth = 0;
+      int mHeight = 0;
+      float mScaleX = 1.0f;
+      float mScaleY = 1.0f;
+      int mMouseX = 0;
+      int mMouseY = 0;
+      bool mMouseDown = false;
+
+      nk_buffer mVertices;
+      nk_buffer mElements;
+      SoftwareRasterizer mRasterizer;
+      int mFontTexture = 0;
+   };
+
    /// <summary>
    /// Class responsible for providing callers with input from windows.
    /// Once initialized, the window must stay alive for this class to remain valid.
@@ -39,17 +39,22 @@ namespace wgui
       /// <summary>
       /// Uses the XML to parse a list of subnodes.
       /// Everything is listed under the GuiRoot tag.
+      /// With an arena, the controls and their attributes are built in it and the arena has to outlive
+      /// the owned controls.
       /// </summary>
       /// <param name="fileName"></param>
       /// <param name="ownedControls"></param>
+      /// <param name="arena"></param>
       /// <returns></returns>
       static bool ConstructLayoutFromXmlFile(const std::string& fileName, 
          std::vector<std::unique_ptr<GuiControlBase>>& ownedControls,
-         std::vector<GuiControlBase*>& controlTree);
+         std::vector<GuiControlBase*>& controlTree,
+         ControlArena* arena = nullptr);
 
       static bool ConstructLayoutFromXmlText(const std::string& xmlText, 
          std::vector<std::unique_ptr<GuiControlBase>>& ownedControls,
-         std::vector<GuiControlBase*>& controlTree);
+         std::vector<GuiControlBase*>& controlTree,
+         ControlArena* arena = nullptr);
 
       template <class T>
       static void AddControlFactory()
@@ -9,6 +9,9 @@
 #define NK_INCLUDE_FONT_BAKING
 #define NK_INCLUDE_DEFAULT_FONT
 #define NK_KEYSTATE_BASED_INPUT
+#define NK_ZERO_COMMAND_MEMORY
+// Lets the control profiler tag commands with the control that pushed them.
+#define NK_INCLUDE_COMMAND_USERDATA
 
 #include "nuklear.h"
 #include "nuklear_glfw_gl3.h"
@@ -25,12 +25,171 @@ enum nk_glfw_init_state {
 #define NK_GLFW_TEXT_MAX 256
 #endif
 
+/* Number of frames the vertex/element ring can have in flight on the GPU. */
+#ifndef NK_GLFW_STREAM_FRAMES
+#define NK_GLFW_STREAM_FRAMES 3
+#endif
+
+/* Vertex layout nk_convert produces for this backend. */
+struct nk_glfw_vertex
+{
+   float position[2];
+   float uv[2];
+   nk_byte col[4];
+};
+
+/* Fractional position steps of the packed format. 4 keeps the half pixel offsets of the
+   anti aliasing fringes exact and still covers -8192 to 8191 pixels. */
+#ifndef NK_GLFW_POSITION_SUBPIXELS
+#define NK_GLFW_POSITION_SUBPIXELS 4
+#endif
+
+/* Largest distance in pixels between a tessellated circle, arc or curve and the true shape.
+   Segment counts follow from it per primitive instead of the fixed counts of the convert config. */
+#ifndef NK_GLFW_TESSELLATION_TOLERANCE
+#define NK_GLFW_TESSELLATION_TOLERANCE 0.25f
+#endif
+#ifndef NK_GLFW_MAX_ARC_SEGMENTS
+#define NK_GLFW_MAX_ARC_SEGMENTS 64
+#endif
+
+/* 12 byte layout uploaded in place of nk_glfw_vertex: fixed point positions in
+   1/NK_GLFW_POSITION_SUBPIXELS pixels and uvs normalized to 16 bits. */
+struct nk_glfw_packed_vertex
+{
+   nk_short position[2];
+   nk_ushort uv[2];
+   nk_byte col[4];
+};
+
+enum nk_glfw_vertex_format {
+   /* nk_glfw_vertex as converted, 20 bytes */
+   NK_GLFW_VERTEX_FLOAT = 0,
+   /* nk_glfw_packed_vertex, packed from the converted vertices on upload */
+   NK_GLFW_VERTEX_PACKED
+};
+
+/* One rect, glyph or image of the instanced path, expanded to a quad by the vertex shader.
+   28 bytes in place of the 4 vertices and 6 indices nk_convert would produce. */
+struct nk_glfw_quad_instance
+{
+   /* x, y, width, height */
+   float rect[4];
+   /* top left and bottom right uv, normalized to 16 bits */
+   nk_ushort uv[4];
+   nk_byte col[4];
+};
+
+/* A run of the frame sharing texture and clip rect, either quad instances or elements of the
+   converted geometry. Batches are drawn in order, which keeps the painter's order of the commands. */
+struct nk_glfw_quad_batch
+{
+   int elements;
+   nk_handle texture;
+   struct nk_rect clip;
+   /* first instance or first element index, and how many */
+   nk_uint first;
+   nk_uint count;
+};
+
+/* CPU side of a frame drawn with instanced quads */
+struct nk_glfw_quad_frame
+{
+   struct nk_buffer instances;
+   struct nk_buffer batches;
+   /* runs before the converted ones are split along nuklear's draw commands */
+   struct nk_buffer segments;
+   /* nk_glfw_vertex and indices of the commands that are not quads */
+   struct nk_buffer vertices;
+   struct nk_buffer elements;
+};
+
+/* Offscreen copy of part of a frame, composited as one textured quad while the part doesn't change.
+   Rows are stored top down, so the texture can be drawn with a plain nk_image. Colors are premultiplied
+   by alpha, the draws recognize the texture and blend it accordingly. */
+struct nk_glfw_render_target
+{
+   GLuint framebuffer;
+   GLuint texture;
+   /* in framebuffer pixels */
+   int width;
+   int height;
+   /* device the objects were made on, framebuffers belong to that window's context only */
+   struct nk_glfw_device* owner;
+   /* next target made on the same device, or next released one waiting for its context */
+   struct nk_glfw_render_target* next;
+};
+
+/* How vertex/element data is streamed to the GPU every frame. */
+enum nk_glfw_stream_mode {
+   /* glBufferData orphaning followed by glMapBuffer, one allocation per frame. */
+   NK_GLFW3_STREAM_ORPHAN = 0,
+   /* Fenced ring, each segment mapped with glMapBufferRange(UNSYNCHRONIZED | INVALIDATE_RANGE). */
+   NK_GLFW3_STREAM_MAP_RANGE,
+   /* Fenced ring, persistently and coherently mapped through ARB_buffer_storage. */
+   NK_GLFW3_STREAM_PERSISTENT
+};
+
+struct nk_glfw_stream_buffer
+{
+   GLenum target;
+   /* Size of one frame segment in bytes, the buffer holds NK_GLFW_STREAM_FRAMES of them. */
+   GLsizeiptr segment_size;
+   /* Base pointer of the whole buffer, only valid in persistent mode. */
+   void* mapped;
+};
+
+/* A font texture baked by a device and the number of devices drawing with it, devices created
+   sharing gl objects with the baking one take a reference. The last one to let go deletes it. */
+struct nk_glfw_font_texture
+{
+   GLuint tex;
+   int refs;
+};
+
 struct nk_glfw_device 
 {
    struct nk_buffer cmds;
    struct nk_draw_null_texture tex_null;
    GLuint vbo, vao, ebo;
    GLuint font_tex;
+   /* reference held on font_tex, null when the texture belongs to someone else (a FontAtlasCache) */
+   struct nk_glfw_font_texture* font_owner;
+   /* ALPHA8 (the default) uploads a GL_R8 coverage mask swizzled to (1, 1, 1, r) */
+   enum nk_font_atlas_format atlas_format;
+   /* font_tex holds distance fields, draws sampling it use the sdf program */
+   int font_sdf;
+
+   enum nk_glfw_stream_mode stream_mode;
+   struct nk_glfw_stream_buffer vertex_stream;
+   struct nk_glfw_stream_buffer element_stream;
+   GLsync stream_fences[NK_GLFW_STREAM_FRAMES];
+   int stream_frame;
+   /* bytes per frame the vertex/element buffers currently hold, grown when a frame overflows */
+   GLsizeiptr vertex_capacity;
+   GLsizeiptr element_capacity;
+
+   /* layout of the uploaded vertices, packed ones are converted into staging first */
+   enum nk_glfw_vertex_format vertex_format;
+   struct nk_buffer staging;
+
+   /* rects, glyphs and images drawn as instanced quads, only the rest is converted. Uploads by
+      orphaning its own buffers, the streaming ring stays untouched */
+   int quad_instancing;
+   GLuint quad_vao, quad_vbo;
+   GLuint mesh_vao, mesh_vbo, mesh_ebo;
+   struct nk_glfw_quad_frame quads;
+
+   /* GL_TIME_ELAPSED queries around the draws, one per ring frame, read back once available */
+   int gpu_timing;
+   GLuint timer_queries[NK_GLFW_STREAM_FRAMES];
+   int timer_pending[NK_GLFW_STREAM_FRAMES];
+   int timer_frame;
+
+   /* render targets made on this device, and copies of released ones whose objects are deleted
+      by the next render with the context current */
+   struct nk_glfw_render_target* targets;
+   struct nk_glfw_render_target* released_targets;
 
    /**
    GLuint prog;
@@ -45,6 +204,48 @@ struct nk_glfw_device
    GLint attrib_col;
 };
 
+/* What the last nk_glfw3_render produced, for sizing buffers and spotting heavy frames. */
+struct nk_glfw_frame_stats
+{
+   nk_uint vertex_count;
+   nk_uint element_count;
+   /* non empty nuklear draw commands, and the draw calls left after merging them */
+   nk_uint command_count;
+   nk_uint draw_count;
+   /* times the buffers grew and the frame had to be converted again */
+   nk_uint grow_count;
+   nk_size vertex_buffer_size;
+   nk_size element_buffer_size;
+   /* bytes of vertex data the frame uploaded, vertex_count times the uploaded layout's size plus the instances */
+   nk_size vertex_bytes;
+   /* quads the instanced path drew without converting them */
+   nk_uint instance_count;
+   /* set when a build with 16 bit indices produced more vertices than it can address */
+   int index_overflow;
+   /* cpu milliseconds spent in nk_convert, in mapping and fencing the stream buffers, and issuing draws */
+   float convert_ms;
+   float upload_ms;
+   float draw_ms;
+   /* gpu milliseconds of the draws of a frame a few frames back, negative until one was measured */
+   float gpu_ms;
+};
+
+/* Everything a frame reads from glfw. Captured on the main thread, which glfw requires for
+   input and window queries, and applied on whichever thread lays out the window. */
+struct nk_glfw_input
+{
+   int width, height;
+   int display_width, display_height;
+   float content_scale_x, content_scale_y;
+   double mouse_x, mouse_y;
+   int keys[NK_KEY_MAX];
+   int buttons[NK_BUTTON_MAX];
+   struct nk_vec2 double_click_pos;
+   struct nk_vec2 scroll;
+   unsigned int text[NK_GLFW_TEXT_MAX];
+   int text_len;
+};
+
 struct nk_glfw 
 {
    GLFWwindow* win;
@@ -60,17 +261,90 @@ struct nk_glfw
    double last_button_click;
    int is_double_click_down;
    struct nk_vec2 double_click_pos;
+   /* hash of the last command list seen by nk_glfw3_frame_changed */
+   nk_hash frame_hash;
+   int frame_hash_valid;
+   struct nk_glfw_frame_stats stats;
+   /* converts with nuklear's fixed segment counts and anti aliases every shape, for comparisons */
+   int fixed_tessellation;
+   /* last capture, key states carry over between captures like glfw's own polling */
+   struct nk_glfw_input input;
 };
 
+enum nk_glfw_atlas_source {
+   NK_GLFW_ATLAS_FAILED,
+   NK_GLFW_ATLAS_BAKED,
+   /* restored from a cache file, nk_font_atlas_bake was skipped */
+   NK_GLFW_ATLAS_CACHED
+};
+
+/* receives the finished atlas image before nk_font_atlas_end, pixels are only valid during the call */
+typedef void(*nk_glfw_atlas_upload)(void* userdata, const void* image, int width, int height);
+
 NK_API struct nk_context* nk_glfw3_init(struct nk_glfw* glfw, GLFWwindow* win, enum nk_glfw_init_state);
+NK_API struct nk_context* nk_glfw3_init_shared(struct nk_glfw* glfw, GLFWwindow* win, enum nk_glfw_init_state, const struct nk_glfw* share);
+NK_API struct nk_context* nk_glfw3_init_headless(struct nk_glfw* glfw);
 NK_API void                 nk_glfw3_shutdown(struct nk_glfw* glfw);
 NK_API void                 nk_glfw3_font_stash_begin(struct nk_glfw* glfw, struct nk_font_atlas** atlas);
 NK_API void                 nk_glfw3_font_stash_end(struct nk_glfw* glfw);
+NK_API enum nk_glfw_atlas_source nk_glfw3_font_stash_end_cached(struct nk_glfw* glfw, const char* cache_file);
+NK_API enum nk_glfw_atlas_source nk_glfw3_font_atlas_bake_cached(struct nk_font_atlas* atlas, enum nk_font_atlas_format fmt,
+                                                                 const char* cache_file, nk_glfw_atlas_upload upload, void* userdata);
+/* one distance field atlas that stays sharp at any font handle height, upload as ALPHA8 */
+NK_API enum nk_glfw_atlas_source nk_glfw3_font_atlas_bake_sdf(struct nk_font_atlas* atlas, const char* cache_file,
+                                                              nk_glfw_atlas_upload upload, void* userdata);
 NK_API void                 nk_glfw3_new_frame(struct nk_glfw* glfw);
+/* nk_glfw3_new_frame split in two for windows laid out off the main thread */
+NK_API const struct nk_glfw_input* nk_glfw3_capture_input(struct nk_glfw* glfw);
+NK_API void                 nk_glfw3_apply_input(struct nk_glfw* glfw, const struct nk_glfw_input* input);
+/* folds a newer capture into one that wasn't applied yet, presses and text in either survive */
+NK_API void                 nk_glfw3_merge_input(struct nk_glfw_input* pending, const struct nk_glfw_input* input);
+NK_API int                  nk_glfw3_input_active(const struct nk_glfw* glfw);
+NK_API int                  nk_glfw3_frame_changed(struct nk_glfw* glfw);
+NK_API void                 nk_glfw3_invalidate_frame(struct nk_glfw* glfw);
+NK_API void                 nk_glfw3_fill_convert_config(struct nk_glfw* glfw, enum nk_anti_aliasing, struct nk_convert_config* config);
+/* nk_convert with segment counts picked per primitive from its radius and fringe free axis aligned rects,
+   a tolerance of 0 or less falls back to nk_convert */
+NK_API nk_flags             nk_glfw3_convert(struct nk_context* ctx, struct nk_buffer* cmds, struct nk_buffer* vertices,
+                                             struct nk_buffer* elements, const struct nk_convert_config* config, float tolerance);
+/* tolerance nk_glfw3_convert should use for the window, scaled to its framebuffer */
+NK_API float                nk_glfw3_tessellation_tolerance(const struct nk_glfw* glfw);
+/* walks the commands once, square filled rects, text and images become instances, the rest goes through nk_glfw3_convert */
+NK_API void                 nk_glfw3_quad_frame_init(struct nk_glfw_quad_frame* frame);
+NK_API void                 nk_glfw3_quad_frame_free(struct nk_glfw_quad_frame* frame);
+NK_API void                 nk_glfw3_build_quads(struct nk_context* ctx, struct nk_buffer* cmds, struct nk_glfw_quad_frame* frame,
+                                                 const struct nk_convert_config* config, float tolerance);
+NK_API unsigned int         nk_glfw3_arc_segments(float radius, float angle, float tolerance);
 NK_API void                 nk_glfw3_render(struct nk_glfw* glfw, enum nk_anti_aliasing, int max_vertex_buffer, int max_element_buffer);
+/* draws the commands in [begin, end) of the context's command memory into the target, area maps to the whole
+   texture. Returns false when there is no device or no framebuffer could be made, the caller draws live then */
+NK_API int                  nk_glfw3_render_commands(struct nk_glfw* glfw, struct nk_glfw_render_target* target,
+                                                     nk_size begin, nk_size end, struct nk_rect area);
+/* deletes the target's objects, needs its window's context current */
+NK_API void                 nk_glfw3_render_target_free(struct nk_glfw_render_target* target);
+/* empties the target from any thread, its window deletes the objects the next time it renders or when it closes */
+NK_API void                 nk_glfw3_render_target_release(struct nk_glfw_render_target* target);
 
 NK_API void                 nk_glfw3_device_destroy(struct nk_glfw* glfw);
 NK_API void                 nk_glfw3_device_create(struct nk_glfw* glfw);
+NK_API void                 nk_glfw3_device_create_shared(struct nk_glfw* glfw, const struct nk_glfw* share);
+NK_API void                 nk_glfw3_set_stream_mode(struct nk_glfw* glfw, enum nk_glfw_stream_mode mode);
+NK_API void                 nk_glfw3_set_atlas_format(struct nk_glfw* glfw, enum nk_font_atlas_format fmt);
+/* picks the uploaded vertex layout, packed by default. Needs the window's context current */
+NK_API void                 nk_glfw3_set_vertex_format(struct nk_glfw* glfw, enum nk_glfw_vertex_format fmt);
+NK_API void                 nk_glfw3_pack_vertices(struct nk_glfw_packed_vertex* dst, const struct nk_glfw_vertex* src, nk_size count);
+/* draws with nk_glfw3_build_quads, needs GL 3.3 and the window's context current */
+NK_API void                 nk_glfw3_set_quad_instancing(struct nk_glfw* glfw, int enable);
+/* switches between nk_glfw3_convert (the default) and plain nk_convert */
+NK_API void                 nk_glfw3_set_fixed_tessellation(struct nk_glfw* glfw, int enable);
+/* times the draws with GL_TIME_ELAPSED queries into stats.gpu_ms, needs the window's context current */
+NK_API void                 nk_glfw3_set_gpu_timing(struct nk_glfw* glfw, int enable);
+/* atlases baked outside the font stash, e.g. one per content scale shared by several windows */
+NK_API GLuint               nk_glfw3_create_atlas_texture(const void* image, int width, int height, enum nk_font_atlas_format fmt);
+NK_API void                 nk_glfw3_use_atlas(struct nk_glfw* glfw, GLuint tex, const struct nk_draw_null_texture* tex_null);
+NK_API void                 nk_glfw3_use_sdf_atlas(struct nk_glfw* glfw, GLuint tex, const struct nk_draw_null_texture* tex_null);
+/* deletes the programs the calling thread drew with, call with its context current before it exits */
+NK_API void                 nk_glfw3_release_thread_programs(void);
 
 NK_API void                 nk_glfw3_char_callback(GLFWwindow* win, unsigned int codepoint);
 NK_API void                 nk_gflw3_scroll_callback(GLFWwindow* win, double xoff, double yoff);
@@ -4,12 +4,74 @@
 #include "App.h"
 #include "XmlToUi.h"
 #include "KeyritaControls.h"
+#include "ControlProfilerDialog.h"
+
+#include <fstream>
 
 using namespace wgui;
 
-int main()
+static void WritePerfCsv(std::ofstream& perfCsv, const FrameProfiler& profiler, uint64_t& cursor)
+{
+   uint64_t lost = profiler.WriteCsv(perfCsv, cursor);
+   if (lost > 0)
+   {
+      Application::Logger.warning("{int} frames were overwritten before they reached the perf csv", static_cast<int>(lost));
+   }
+}
+
+int main(int argc, char** argv)
 {
    Application::Start();
+   eFontRenderMode fontMode = eFontRenderMode::Bitmap;
+   std::string perfCsvPath;
+   bool profileControls = false;
+   bool floatVertices = false;
+   bool fixedTessellation = false;
+   bool instancedQuads = false;
+
+   for (int i = 1; i < argc; i++)
+   {
+      // Render every frame regardless of input, used when benchmarking.
+      if (std::string(argv[i]) == "--continuous")
+      {
+         Application::SetRenderMode(eRenderMode::Continuous);
+      }
+      // One distance field font atlas for every scale instead of a bake per monitor scale.
+      else if (std::string(argv[i]) == "--sdf-text")
+      {
+         fontMode = eFontRenderMode::Sdf;
+      }
+      // Every window renders and presents on its own thread at its monitor's refresh rate.
+      else if (std::string(argv[i]) == "--render-threads")
+      {
+         Application::SetThreadedRendering(true);
+      }
+      // Writes the phase timings of every presented main window frame to a csv file, replacing it.
+      else if (std::string(argv[i]) == "--perf-csv" && i + 1 < argc)
+      {
+         perfCsvPath = argv[++i];
+      }
+      // Uploads the 20 byte float vertices instead of the packed 12 byte ones, to compare the two.
+      else if (std::string(argv[i]) == "--float-vertices")
+      {
+         floatVertices = true;
+      }
+      // Tessellates with nuklear's fixed segment counts and anti aliases every rect, to compare vertex counts.
+      else if (std::string(argv[i]) == "--fixed-tessellation")
+      {
+         fixedTessellation = true;
+      }
+      // Draws rects, glyphs and images as instanced quads instead of converting them.
+      else if (std::string(argv[i]) == "--instanced-quads")
+      {
+         instancedQuads = true;
+      }
+      // Opens a dialog with the render cost of every control in the main window.
+      else if (std::string(argv[i]) == "--profile-controls")
+      {
+         profileControls = true;
+      }
+   }
 
    std::unique_ptr<PlatformBase> platform;
 
@@ -26,8 +88,38 @@ int main()
    XmlToUiUtil::AddControlFactory<KeyritaControlsFactory>();
 
    MainWindow mainWindow;
+   mainWindow.SetFontRenderMode(fontMode);
    mainWindow.CreateWindow("Keyrita", 1600, 1200, false, true, true, false);
    mainWindow.SetWindowSizeLimits(1200, 900);
+   mainWindow.SetSkipUnchangedFrames(true);
+   if (floatVertices)
+   {
+      nk_glfw3_set_vertex_format(mainWindow.GetContext().GetGlfw(), NK_GLFW_VERTEX_FLOAT);
+   }
+   if (fixedTessellation)
+   {
+      nk_glfw3_set_fixed_tessellation(mainWindow.GetContext().GetGlfw(), nk_true);
+   }
+   if (instancedQuads)
+   {
+      nk_glfw3_set_quad_instancing(mainWindow.GetContext().GetGlfw(), nk_true);
+   }
+
+   std::ofstream perfCsv;
+   uint64_t perfCsvCursor = 0;
+   if (!perfCsvPath.empty())
+   {
+      perfCsv.open(perfCsvPath);
+      if (perfCsv.is_open())
+      {
+         FrameProfiler::WriteCsvHeader(perfCsv);
+         mainWindow.SetFrameProfiling(true);
+      }
+      else
+      {
+         Application::Logger.error("Could not open {str} for the frame timings", perfCsvPath.c_str());
+      }
+   }
 
    //MainWindow secondWindow;
    //secondWindow.CreateWindow("Dialog", 400, 300, false, true, true, false);
@@ -35,10 +127,19 @@ int main()
    bool resiable = false;
 
    XmlRenderer mainWindowRenderer;
-   mainWindowRenderer.ConstructLayoutFromXmlFile("./res/gui/Keyrita.guix");
+   mainWindowRenderer.ConstructLayoutFromXmlFile("./res/gui/Keyrita.guix", true);
    mainWindowRenderer.Init();
    mainWindow.SetRenderer(&mainWindowRenderer);
 
+   Dialog controlCostDialog(&mainWindow);
+   ControlProfilerDialog controlCostRenderer(&mainWindow);
+   if (profileControls)
+   {
+      controlCostDialog.CreateWindow("Control costs", 700, 800, true, true, true, false);
+      controlCostRenderer.Init();
+      controlCostDialog.SetRenderer(&controlCostRenderer);
+   }
+
    //XmlRenderer secondRenderer;
    //secondRenderer.ConstructLayoutFromXmlFile("./res/gui/Keyrita.guix");
    //secondRenderer.Init();
@@ -46,18 +147,49 @@ int main()
 
    Timer t;
    int frameCount = 0;
+   uint64_t lastSkipped = 0;
    while (!mainWindow.Closing())
    {
       Application::RenderWindows();
 
       if (t.milliseconds() >= 5000)
       {
-         std::cout << "Fps: " << frameCount / 5 << "\n";
+         uint64_t skipped = mainWindow.GetSkippedFrameCount();
+         const nk_glfw_frame_stats& stats = mainWindow.GetFrameStats();
+         std::cout << "Fps: " << frameCount / 5 << ", skipped: " << skipped - lastSkipped
+            << ", vertices: " << stats.vertex_count << " (" << stats.vertex_bytes / 1024 << " KiB)"
+            << ", indices: " << stats.element_count << ", quads: " << stats.instance_count
+            << ", draws: " << stats.command_count << " -> " << stats.draw_count << "\n";
+
+         if (stats.index_overflow)
+         {
+            std::cout << "Frame has more vertices than 16 bit indices can address, build with WGUI_UINT_DRAW_INDEX\n";
+         }
+
+         lastSkipped = skipped;
          frameCount = 0;
          t.reset();
       }
 
       frameCount++;
+
+      // Drained at half the ring rather than on a timer, fast monitors fill it in a few seconds.
+      if (perfCsv.is_open() &&
+         mainWindow.GetFrameProfiler()->GetFrameCount() - perfCsvCursor >= FrameProfiler::Capacity / 2)
+      {
+         WritePerfCsv(perfCsv, *mainWindow.GetFrameProfiler(), perfCsvCursor);
+      }
+   }
+
+   if (perfCsv.is_open())
+   {
+      WritePerfCsv(perfCsv, *mainWindow.GetFrameProfiler(), perfCsvCursor);
+   }
+
+   // The dialog may have stopped profiling, the totals recorded until then are still reported.
+   if (const ControlProfiler* controlProfiler = mainWindow.GetControlProfilerResults())
+   {
+      controlProfiler->WriteReport(std::cout);
    }
 
    Application::Shutdown();
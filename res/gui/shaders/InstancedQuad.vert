@@ -0,0 +1,20 @@
+#version 300 es
+
+uniform mat4 ProjectionMatrix;
+
+// One quad per instance: x, y, width, height and the top left and bottom right uv.
+in vec4 Rect;
+in vec4 TexRect;
+in vec4 Color;
+
+out vec2 Frag_UV;
+out vec4 Frag_Color;
+
+void main() 
+{
+	// Drawn as a four vertex triangle strip, the vertex id picks the corner.
+	vec2 corner = vec2(float(gl_VertexID & 1), float(gl_VertexID >> 1));
+	Frag_UV = mix(TexRect.xy, TexRect.zw, corner);
+	Frag_Color = Color;
+	gl_Position = ProjectionMatrix * vec4(Rect.xy + Rect.zw * corner, 0, 1);
+}
@@ -0,0 +1,18 @@
+#version 300 es
+precision mediump float;
+
+uniform sampler2D Texture;
+
+in vec2 Frag_UV;
+in vec4 Frag_Color;
+
+out vec4 Out_Color;
+
+void main()
+{
+	// Distance to the glyph edge, 0.5 is on the outline. The white texel used for fills is fully inside.
+	float distance = texture(Texture, Frag_UV.xy).a;
+	float smoothing = max(fwidth(distance), 1.0 / 255.0);
+	float coverage = smoothstep(0.5 - smoothing, 0.5 + smoothing, distance);
+	Out_Color = vec4(Frag_Color.rgb, Frag_Color.a * coverage);
+}